@@ -38,6 +38,11 @@ namespace haze {
         u64 size;
     };
 
+    struct CachedObjectProps {
+        FsDirEntryType type;
+        s64 size; /* Negative when unknown. */
+    };
+
     class PtpResponder final {
         private:
             Callback m_callback;
@@ -49,11 +54,12 @@ namespace haze {
             u32 m_send_object_id;
             std::optional<ObjectPropList> m_send_prop_list;
             bool m_session_open;
-            std::unordered_map<std::string, u64> m_cached_object_sizes;
+            std::unordered_map<std::string, CachedObjectProps> m_cached_object_props;
+            std::unordered_map<std::string, std::vector<u32>> m_cached_directory_listings;
 
             PtpObjectDatabase m_object_database;
         public:
-            explicit PtpResponder(Callback callback = nullptr) : m_callback{callback}, m_usb_server(), m_fs_entries(), m_request_header(), m_object_heap(), m_buffers(), m_send_object_id(), m_session_open(), m_cached_object_sizes(), m_object_database() { /* ... */ }
+            explicit PtpResponder(Callback callback = nullptr) : m_callback{callback}, m_usb_server(), m_fs_entries(), m_request_header(), m_object_heap(), m_buffers(), m_send_object_id(), m_session_open(), m_cached_object_props(), m_cached_directory_listings(), m_object_database() { /* ... */ }
 
             Result Initialize(EventReactor *reactor, PtpObjectHeap *object_heap, const FsEntries& entries, u16 vid, u16 pid);
             void Finalize();
@@ -113,10 +119,17 @@ namespace haze {
             void WriteCallbackRename(CallbackType type, const char* name, const char* newname);
             void WriteCallbackProgress(CallbackType type, s64 offset, s64 size);
 
-            void CacheObjectSizeByName(const char* name, u64 size);
+            void CacheObjectProps(const char* name, FsDirEntryType type, s64 size);
             void CacheObjectSize(const PtpObject* obj, u64 size);
             bool TryGetCachedObjectSize(const PtpObject* obj, s64* out_size) const;
-            void EraseCachedObjectSize(const char* name);
+            Result GetObjectEntryType(const PtpObject* obj, FsDirEntryType* out_entry_type);
+            void EraseCachedObject(const char* name);
+
+            const std::vector<u32>* FindCachedListing(const PtpObject* dir) const;
+            void AddToCachedListing(const PtpObject* obj);
+            void RemoveFromCachedListing(const PtpObject* obj);
+            void InvalidateCachedListings(const char* path);
+            void ClearObjectCaches();
     };
 
 }
@@ -17,10 +17,43 @@ enum class Mode {
     SingleThreadedIfSmaller,
 };
 
+struct TransferConfig {
+    // number of buffers in flight between the read and write thread.
+    u32 depth;
+    // size of each buffer.
+    u64 buffer_size;
+};
+
+struct TransferStats {
+    s64 bytes;
+    u32 depth;
+    u64 buffer_size;
+    u64 elapsed_ns;
+    // time the read thread waited for a free buffer, i.e. the writer was the bottleneck.
+    u64 read_stall_ns;
+    // time the write thread waited for data, i.e. the reader was the bottleneck.
+    u64 write_stall_ns;
+    // most buffers that were ever queued for the writer at once.
+    u32 max_queued;
+};
+
 using ReadCallback = std::function<Result(void* data, s64 off, s64 size, u64* bytes_read)>;
 using WriteCallback = std::function<Result(const void* data, s64 off, s64 size)>;
 
 // reads data from rfunc into wfunc.
 Result Transfer(s64 size, const ReadCallback& rfunc, const WriteCallback& wfunc, Mode mode = Mode::MultiThreaded);
 
+// sets the pipeline shape used by the following multi-threaded transfers.
+// depth is clamped to [2, 16] and buffer_size to [64KiB, 16MiB], and depth is
+// lowered further so the pool stays within 32MiB. this leaves 8-16 deep pipelines
+// only for buffers of 2-4MiB; 8MiB buffers run at most 4 deep, 16MiB ones 2 deep.
+void SetTransferConfig(const TransferConfig& config);
+auto GetTransferConfig() -> TransferConfig;
+
+// stats of the most recent multi-threaded transfer.
+auto GetLastTransferStats() -> TransferStats;
+
+// frees the preallocated buffer pool, it is allocated again on the next transfer.
+void FreeTransferBuffers();
+
 } // namespace sphaira::thread
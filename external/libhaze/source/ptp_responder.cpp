@@ -40,7 +40,7 @@ namespace haze {
         m_object_heap = object_heap;
         m_buffers = GetBuffers();
         m_fs_entries.clear();
-        m_cached_object_sizes.clear();
+        this->ClearObjectCaches();
 
         u32 storage_id = StorageId_DefaultStorage;
 
@@ -166,7 +166,7 @@ namespace haze {
         if (m_session_open) {
             m_session_open = false;
             m_object_database.Finalize();
-            m_cached_object_sizes.clear();
+            this->ClearObjectCaches();
         }
     }
 
@@ -183,18 +183,37 @@ namespace haze {
         R_RETURN(db.Commit());
     }
 
-    void PtpResponder::CacheObjectSizeByName(const char* name, u64 size) {
+    namespace {
+
+        std::string ParentPath(const char* name) {
+            const char* sep = std::strrchr(name, '/');
+            if (!sep) {
+                return {};
+            }
+            return std::string(name, sep - name);
+        }
+
+        bool IsSameOrChildPath(const std::string& path, const std::string& prefix) {
+            if (path.size() < prefix.size() || std::strncmp(path.c_str(), prefix.c_str(), prefix.size()) != 0) {
+                return false;
+            }
+            return path.size() == prefix.size() || path[prefix.size()] == '/';
+        }
+
+    }
+
+    void PtpResponder::CacheObjectProps(const char* name, FsDirEntryType type, s64 size) {
         if (!name || name[0] == '\0') {
             return;
         }
-        m_cached_object_sizes[std::string(name)] = size;
+        m_cached_object_props[std::string(name)] = CachedObjectProps{type, size};
     }
 
     void PtpResponder::CacheObjectSize(const PtpObject* obj, u64 size) {
         if (!obj) {
             return;
         }
-        this->CacheObjectSizeByName(obj->GetName(), size);
+        this->CacheObjectProps(obj->GetName(), FsDirEntryType_File, static_cast<s64>(size));
     }
 
     bool PtpResponder::TryGetCachedObjectSize(const PtpObject* obj, s64* out_size) const {
@@ -202,20 +221,76 @@ namespace haze {
             return false;
         }
 
-        const auto it = m_cached_object_sizes.find(std::string(obj->GetName()));
-        if (it == m_cached_object_sizes.end()) {
+        const auto it = m_cached_object_props.find(std::string(obj->GetName()));
+        if (it == m_cached_object_props.end() || it->second.size < 0) {
             return false;
         }
 
-        *out_size = static_cast<s64>(it->second);
+        *out_size = it->second.size;
         return true;
     }
 
-    void PtpResponder::EraseCachedObjectSize(const char* name) {
+    Result PtpResponder::GetObjectEntryType(const PtpObject* obj, FsDirEntryType* out_entry_type) {
+        /* Objects seen during enumeration already know their type. */
+        const auto it = m_cached_object_props.find(std::string(obj->GetName()));
+        if (it != m_cached_object_props.end()) {
+            *out_entry_type = it->second.type;
+            R_SUCCEED();
+        }
+
+        R_TRY(Fs(obj).GetEntryType(obj->GetName(), out_entry_type));
+        this->CacheObjectProps(obj->GetName(), *out_entry_type, *out_entry_type == FsDirEntryType_Dir ? 0 : -1);
+        R_SUCCEED();
+    }
+
+    void PtpResponder::EraseCachedObject(const char* name) {
         if (!name || name[0] == '\0') {
             return;
         }
-        m_cached_object_sizes.erase(std::string(name));
+        m_cached_object_props.erase(std::string(name));
+    }
+
+    const std::vector<u32>* PtpResponder::FindCachedListing(const PtpObject* dir) const {
+        const auto it = m_cached_directory_listings.find(std::string(dir->GetName()));
+        if (it == m_cached_directory_listings.end()) {
+            return nullptr;
+        }
+        return std::addressof(it->second);
+    }
+
+    void PtpResponder::AddToCachedListing(const PtpObject* obj) {
+        /* Only listings we have already enumerated need patching; others are read fresh. */
+        const auto it = m_cached_directory_listings.find(ParentPath(obj->GetName()));
+        if (it == m_cached_directory_listings.end()) {
+            return;
+        }
+
+        auto& handles = it->second;
+        if (std::find(handles.begin(), handles.end(), obj->GetObjectId()) == handles.end()) {
+            handles.push_back(obj->GetObjectId());
+        }
+    }
+
+    void PtpResponder::RemoveFromCachedListing(const PtpObject* obj) {
+        const auto it = m_cached_directory_listings.find(ParentPath(obj->GetName()));
+        if (it == m_cached_directory_listings.end()) {
+            return;
+        }
+
+        auto& handles = it->second;
+        handles.erase(std::remove(handles.begin(), handles.end(), obj->GetObjectId()), handles.end());
+    }
+
+    void PtpResponder::InvalidateCachedListings(const char* path) {
+        /* Drop the directory itself and everything cached beneath it. */
+        const std::string prefix(path);
+        std::erase_if(m_cached_directory_listings, [&prefix](const auto& e) { return IsSameOrChildPath(e.first, prefix); });
+        std::erase_if(m_cached_object_props, [&prefix](const auto& e) { return IsSameOrChildPath(e.first, prefix); });
+    }
+
+    void PtpResponder::ClearObjectCaches() {
+        m_cached_object_props.clear();
+        m_cached_directory_listings.clear();
     }
 
     #if 0
@@ -130,7 +130,7 @@ namespace haze {
 
         /* Define helper for getting the object type. */
         const auto GetObjectType = [&] (FsDirEntryType *out_entry_type) {
-            R_RETURN(Fs(obj).GetEntryType(obj->GetName(), out_entry_type));
+            R_RETURN(this->GetObjectEntryType(obj, out_entry_type));
         };
 
         /* Define helper for getting the object size. */
@@ -241,7 +241,7 @@ namespace haze {
 
         /* Define helper for getting the object type. */
         const auto GetObjectType = [&] (FsDirEntryType *out_entry_type) {
-            R_RETURN(Fs(obj).GetEntryType(obj->GetName(), out_entry_type));
+            R_RETURN(this->GetObjectEntryType(obj, out_entry_type));
         };
 
         /* Define helper for getting the object size. */
@@ -452,6 +452,7 @@ namespace haze {
             R_TRY(Fs(newobj).CreateDirectory(newobj->GetName()));
             WriteCallbackFile(CallbackType_CreateFolder, newobj->GetName());
             m_send_object_id = 0;
+            this->CacheObjectProps(newobj->GetName(), FsDirEntryType_Dir, 0);
         } else {
             u32 flags = 0;
             if (prop_list.size >= 4_GB) {
@@ -464,6 +465,9 @@ namespace haze {
             this->CacheObjectSize(newobj, prop_list.size);
         }
 
+        /* Keep the parent's cached listing in sync with what we created. */
+        this->AddToCachedListing(newobj);
+
         /* Save prop list and return success. */
         m_send_prop_list = prop_list;
         R_RETURN(this->WriteResponse(PtpResponseCode_Ok, new_object_info));
@@ -516,6 +520,7 @@ namespace haze {
             R_TRY(m_object_database.CreateOrFindObject(obj->GetName(), m_buffers->filename_string_buffer, obj->GetParentId(), obj->GetStorageId(), std::addressof(newobj)));
         }
 
+        FsDirEntryType entry_type;
         {
             /* Ensure we maintain a clean state on failure. */
             ON_RESULT_FAILURE {
@@ -527,8 +532,7 @@ namespace haze {
             };
 
             /* Get the old object type. */
-            FsDirEntryType entry_type;
-            R_TRY(Fs(obj).GetEntryType(obj->GetName(), std::addressof(entry_type)));
+            R_TRY(this->GetObjectEntryType(obj, std::addressof(entry_type)));
 
             /* Attempt to rename the object on the filesystem. */
             if (entry_type == FsDirEntryType_Dir) {
@@ -541,16 +545,14 @@ namespace haze {
         }
 
         /* Unregister and free the old object. */
-        s64 cached_size = 0;
-        const bool had_cached_size = this->TryGetCachedObjectSize(obj, std::addressof(cached_size));
-        this->EraseCachedObjectSize(obj->GetName());
+        s64 cached_size = -1;
+        this->TryGetCachedObjectSize(obj, std::addressof(cached_size));
+        this->InvalidateCachedListings(obj->GetName());
         m_object_database.DeleteObject(obj);
 
-        /* Register the new object. */
+        /* Register the new object. The handle is unchanged, so the parent's cached listing stays valid. */
         m_object_database.RegisterObject(newobj, object_id);
-        if (had_cached_size && cached_size >= 0) {
-            this->CacheObjectSize(newobj, static_cast<u64>(cached_size));
-        }
+        this->CacheObjectProps(newobj->GetName(), entry_type, entry_type == FsDirEntryType_Dir ? 0 : cached_size);
 
         /* Write the success response. */
         R_RETURN(this->WriteResponse(PtpResponseCode_Ok));
@@ -177,49 +177,54 @@ namespace haze {
         auto * const obj = m_object_database.GetObjectById(association_object_handle);
         R_UNLESS(obj != nullptr, haze::ResultInvalidObjectId());
 
-        /* Try to read the object as a directory. */
-        FsDir dir;
-        R_TRY(Fs(obj).OpenDirectory(obj->GetName(), FsDirOpenMode_ReadDirs | FsDirOpenMode_ReadFiles, std::addressof(dir)));
-
-        /* Ensure we maintain a clean state on exit. */
-        ON_SCOPE_EXIT { Fs(obj).CloseDirectory(std::addressof(dir)); };
-
-        /* Enumerate first, then emit header once we know exact handle count.
-         * This avoids relying on GetDirectoryEntryCount() behavior across all fs backends. */
-        std::vector<u32> handles;
-        handles.reserve(256);
-        while (true) {
-            /* Get the next batch. */
-            s64 read_count = 0;
-            R_TRY(Fs(obj).ReadDirectory(std::addressof(dir), std::addressof(read_count), DirectoryReadSize, m_buffers->file_system_entry_buffer));
-
-            /* Build handle list. */
-            for (s64 i = 0; i < read_count; i++) {
-                const auto &entry = m_buffers->file_system_entry_buffer[i];
-                const char *name = entry.name;
-                u32 handle;
-
-                R_TRY(m_object_database.CreateAndRegisterObjectId(obj->GetName(), name, obj->GetObjectId(), obj->GetStorageId(), std::addressof(handle)));
-                handles.push_back(handle);
-
-                if (entry.type == FsDirEntryType_File && entry.file_size >= 0) {
-                    auto * const child = m_object_database.GetObjectById(handle);
-                    if (child != nullptr) {
-                        this->CacheObjectSize(child, static_cast<u64>(entry.file_size));
+        /* Hosts re-request listings constantly; serve directories we've already enumerated from memory. */
+        const auto *handles = this->FindCachedListing(obj);
+        if (handles == nullptr) {
+            /* Try to read the object as a directory. */
+            FsDir dir;
+            R_TRY(Fs(obj).OpenDirectory(obj->GetName(), FsDirOpenMode_ReadDirs | FsDirOpenMode_ReadFiles, std::addressof(dir)));
+
+            /* Ensure we maintain a clean state on exit. */
+            ON_SCOPE_EXIT { Fs(obj).CloseDirectory(std::addressof(dir)); };
+
+            /* Enumerate first, then emit header once we know exact handle count.
+             * This avoids relying on GetDirectoryEntryCount() behavior across all fs backends. */
+            std::vector<u32> listing;
+            listing.reserve(256);
+            while (true) {
+                /* Get the next batch. */
+                s64 read_count = 0;
+                R_TRY(Fs(obj).ReadDirectory(std::addressof(dir), std::addressof(read_count), DirectoryReadSize, m_buffers->file_system_entry_buffer));
+
+                /* Build handle list. */
+                for (s64 i = 0; i < read_count; i++) {
+                    const auto &entry = m_buffers->file_system_entry_buffer[i];
+                    const char *name = entry.name;
+                    u32 handle;
+
+                    R_TRY(m_object_database.CreateAndRegisterObjectId(obj->GetName(), name, obj->GetObjectId(), obj->GetStorageId(), std::addressof(handle)));
+                    listing.push_back(handle);
+
+                    /* Prefetch the properties hosts ask for next, so GetObjectPropList doesn't touch the fs. */
+                    if (auto * const child = m_object_database.GetObjectById(handle); child != nullptr) {
+                        const bool is_file = entry.type == FsDirEntryType_File;
+                        this->CacheObjectProps(child->GetName(), static_cast<FsDirEntryType>(entry.type), is_file ? entry.file_size : 0);
                     }
                 }
-            }
 
-            /* If we read fewer than the batch size, we're done. */
-            if (read_count < DirectoryReadSize) {
-                break;
+                /* If we read fewer than the batch size, we're done. */
+                if (read_count < DirectoryReadSize) {
+                    break;
+                }
             }
+
+            handles = std::addressof(m_cached_directory_listings[std::string(obj->GetName())] = std::move(listing));
         }
 
         /* Begin writing. */
-        R_TRY(db.AddDataHeader(m_request_header, sizeof(u32) + (handles.size() * sizeof(u32))));
-        R_TRY(db.Add(static_cast<u32>(handles.size())));
-        for (const auto handle : handles) {
+        R_TRY(db.AddDataHeader(m_request_header, sizeof(u32) + (handles->size() * sizeof(u32))));
+        R_TRY(db.Add(static_cast<u32>(handles->size())));
+        for (const auto handle : *handles) {
             R_TRY(db.Add(handle));
         }
 
@@ -257,7 +262,7 @@ namespace haze {
         } else {
             /* Figure out what type of object this is. */
             FsDirEntryType entry_type;
-            R_TRY(Fs(obj).GetEntryType(obj->GetName(), std::addressof(entry_type)));
+            R_TRY(this->GetObjectEntryType(obj, std::addressof(entry_type)));
 
             /* Get the size, if we are requesting info about a file. */
             s64 size = 0;
@@ -448,6 +453,7 @@ namespace haze {
             R_TRY(Fs(obj).CreateDirectory(obj->GetName()));
             WriteCallbackFile(CallbackType_CreateFolder, obj->GetName());
             m_send_object_id = 0;
+            this->CacheObjectProps(obj->GetName(), FsDirEntryType_Dir, 0);
         } else {
             R_TRY(Fs(obj).CreateFile(obj->GetName(), 0, 0));
             WriteCallbackFile(CallbackType_CreateFile, obj->GetName());
@@ -455,6 +461,9 @@ namespace haze {
             this->CacheObjectSize(obj, static_cast<u64>(info.object_compressed_size));
         }
 
+        /* Keep the parent's cached listing in sync with what we created. */
+        this->AddToCachedListing(obj);
+
         /* Write the success response. */
         R_RETURN(this->WriteResponse(PtpResponseCode_Ok, new_object_info));
     }
@@ -593,7 +602,7 @@ namespace haze {
 
         /* Figure out what type of object this is. */
         FsDirEntryType entry_type;
-        R_TRY(Fs(obj).GetEntryType(obj->GetName(), std::addressof(entry_type)));
+        R_TRY(this->GetObjectEntryType(obj, std::addressof(entry_type)));
 
         /* Remove the object from the filesystem. */
         if (entry_type == FsDirEntryType_Dir) {
@@ -604,8 +613,9 @@ namespace haze {
             R_TRY(Fs(obj).DeleteFile(obj->GetName()));
         }
 
-        /* Remove the object from the database. */
-        this->EraseCachedObjectSize(obj->GetName());
+        /* Remove the object from the database and any cached listings. */
+        this->RemoveFromCachedListing(obj);
+        this->InvalidateCachedListings(obj->GetName());
         m_object_database.DeleteObject(obj);
 
         /* Write the success response. */
@@ -5,66 +5,99 @@
 #include <algorithm>
 #include <cstring>
 #include <atomic>
+#include <memory>
+#include <new>
 
 namespace sphaira::thread {
 namespace {
 
-constexpr u64 BUFFER_SIZE = 1024*1024*4;
+constexpr u32 MIN_DEPTH = 2;
+constexpr u32 MAX_DEPTH = 16;
+constexpr u64 MIN_BUFFER_SIZE = 1024*64;
+constexpr u64 MAX_BUFFER_SIZE = 1024*1024*16;
 
-struct ThreadBuffer {
-    ThreadBuffer() {
-        buf.reserve(BUFFER_SIZE);
-    }
+constexpr u32 DEFAULT_DEPTH = 4;
+constexpr u64 DEFAULT_BUFFER_SIZE = 1024*1024*4;
+// upper bound for depth * buffer_size, the pool lives on the applet heap next to the install queue.
+constexpr u64 MAX_POOL_SIZE = 1024*1024*32;
 
-    std::vector<u8> buf;
-    s64 off;
-};
+// protects the config and the last stats.
+Mutex g_state_mutex{};
+TransferConfig g_config{DEFAULT_DEPTH, DEFAULT_BUFFER_SIZE};
+TransferStats g_last_stats{};
 
-template<std::size_t Size>
-struct RingBuf {
-private:
-    ThreadBuffer buf[Size]{};
-    unsigned r_index{};
-    unsigned w_index{};
+// buffers are allocated once and reused by every transfer, so the steady state
+// never allocates or resizes. held locked for the duration of a transfer.
+struct BufferPool {
+    Mutex mutex{};
+    std::vector<std::unique_ptr<u8[]>> buffers;
+    u64 buffer_size{};
+
+    // returns depth, or 0 if memory is short. a partial pool is released rather than
+    // kept, so a failed allocation never leaves the heap starved.
+    u32 Ensure(u32 depth, u64 size) {
+        if (buffer_size == size && buffers.size() >= depth) {
+            return depth;
+        }
 
-    static_assert((sizeof(RingBuf::buf) & (sizeof(RingBuf::buf) - 1)) == 0, "Must be power of 2!");
+        Free();
+        while (buffers.size() < depth) {
+            auto buf = std::unique_ptr<u8[]>(new (std::nothrow) u8[size]);
+            if (!buf) {
+                Free();
+                return 0;
+            }
+            buffers.emplace_back(std::move(buf));
+        }
 
-public:
-    void ringbuf_reset() {
-        this->r_index = this->w_index;
+        buffer_size = size;
+        return depth;
     }
 
-    unsigned ringbuf_capacity() const {
-        return sizeof(this->buf) / sizeof(this->buf[0]);
+    void Free() {
+        buffers.clear();
+        buffer_size = 0;
     }
+};
 
-    unsigned ringbuf_size() const {
-        return (this->w_index - this->r_index) % (ringbuf_capacity() * 2U);
-    }
+BufferPool g_pool{};
 
-    unsigned ringbuf_free() const {
-        return ringbuf_capacity() - ringbuf_size();
-    }
+struct Slot {
+    u8* data;
+    s64 size;
+};
 
-    void ringbuf_push(std::vector<u8>& buf_in, s64 off_in) {
-        auto& value = this->buf[this->w_index % ringbuf_capacity()];
-        value.off = off_in;
-        std::swap(value.buf, buf_in);
+// fixed size fifo of slot indices.
+struct SlotQueue {
+private:
+    u32 items[MAX_DEPTH]{};
+    u32 head{};
+    u32 count{};
+
+public:
+    bool empty() const {
+        return !count;
+    }
 
-        this->w_index = (this->w_index + 1U) % (ringbuf_capacity() * 2U);
+    u32 size() const {
+        return count;
     }
 
-    void ringbuf_pop(std::vector<u8>& buf_out, s64& off_out) {
-        auto& value = this->buf[this->r_index % ringbuf_capacity()];
-        off_out = value.off;
-        std::swap(value.buf, buf_out);
+    void push(u32 index) {
+        items[(head + count) % MAX_DEPTH] = index;
+        count++;
+    }
 
-        this->r_index = (this->r_index + 1U) % (ringbuf_capacity() * 2U);
+    u32 pop() {
+        const auto index = items[head];
+        head = (head + 1) % MAX_DEPTH;
+        count--;
+        return index;
     }
 };
 
 struct ThreadData {
-    ThreadData(UEvent& _uevent, s64 size, const ReadCallback& _rfunc, const WriteCallback& _wfunc, u64 buffer_size);
+    ThreadData(UEvent& _uevent, s64 size, const ReadCallback& _rfunc, const WriteCallback& _wfunc, u64 buffer_size, BufferPool& pool, u32 depth);
 
     auto GetResults() volatile -> Result;
     void WakeAllThreads();
@@ -89,12 +122,19 @@ struct ThreadData {
         return write_size;
     }
 
+    auto GetStats() const -> TransferStats;
+
     Result readFuncInternal();
     Result writeFuncInternal();
 
+    void SetReadFinished();
+    void SetWriteFinished();
+
 private:
-    Result SetWriteBuf(std::vector<u8>& buf, s64 size);
-    Result GetWriteBuf(std::vector<u8>& buf_out, s64& off_out);
+    Result AcquireFreeSlot(s32& index_out);
+    Result PushFilledSlot(u32 index, s64 size);
+    Result AcquireFilledSlot(s32& index_out);
+    Result ReleaseSlot(u32 index);
 
     Result Read(void* buf, s64 size, u64* bytes_read);
 
@@ -110,11 +150,19 @@ private:
     CondVar can_read{};
     CondVar can_write{};
 
-    RingBuf<2> write_buffers{};
+    Slot slots[MAX_DEPTH]{};
+    const u32 depth;
+    SlotQueue free_slots{};
+    SlotQueue filled_slots{};
 
     const u64 read_buffer_size;
     const s64 write_size;
 
+    // stats, only touched with the mutex held.
+    u64 read_stall_ticks{};
+    u64 write_stall_ticks{};
+    u32 max_queued{};
+
     // these are shared between threads
     std::atomic<s64> read_offset{};
     std::atomic<s64> write_offset{};
@@ -126,16 +174,22 @@ private:
     std::atomic_bool write_running{true};
 };
 
-ThreadData::ThreadData(UEvent& _uevent, s64 size, const ReadCallback& _rfunc, const WriteCallback& _wfunc, u64 buffer_size)
+ThreadData::ThreadData(UEvent& _uevent, s64 size, const ReadCallback& _rfunc, const WriteCallback& _wfunc, u64 buffer_size, BufferPool& pool, u32 _depth)
 : uevent{_uevent}
 , rfunc{_rfunc}
 , wfunc{_wfunc}
+, depth{_depth}
 , read_buffer_size{buffer_size}
 , write_size{size} {
     mutexInit(std::addressof(mutex));
 
     condvarInit(std::addressof(can_read));
     condvarInit(std::addressof(can_write));
+
+    for (u32 i = 0; i < depth; i++) {
+        slots[i].data = pool.buffers[i].get();
+        free_slots.push(i);
+    }
 }
 
 auto ThreadData::GetResults() volatile -> Result {
@@ -151,37 +205,87 @@ void ThreadData::WakeAllThreads() {
     mutexUnlock(std::addressof(mutex));
 }
 
-Result ThreadData::SetWriteBuf(std::vector<u8>& buf, s64 size) {
-    buf.resize(size);
+auto ThreadData::GetStats() const -> TransferStats {
+    TransferStats stats{};
+    stats.bytes = write_offset;
+    stats.depth = depth;
+    stats.buffer_size = read_buffer_size;
+    stats.read_stall_ns = armTicksToNs(read_stall_ticks);
+    stats.write_stall_ns = armTicksToNs(write_stall_ticks);
+    stats.max_queued = max_queued;
+    return stats;
+}
 
+// the other side may be blocked waiting on us, wake it once we're gone.
+void ThreadData::SetReadFinished() {
     mutexLock(std::addressof(mutex));
-    if (!write_buffers.ringbuf_free()) {
-        if (!write_running) {
-            R_SUCCEED();
-        }
+    read_running = false;
+    condvarWakeAll(std::addressof(can_write));
+    mutexUnlock(std::addressof(mutex));
+}
+
+void ThreadData::SetWriteFinished() {
+    mutexLock(std::addressof(mutex));
+    write_running = false;
+    condvarWakeAll(std::addressof(can_read));
+    mutexUnlock(std::addressof(mutex));
+}
+
+// index_out is -1 if the write thread has stopped.
+Result ThreadData::AcquireFreeSlot(s32& index_out) {
+    index_out = -1;
+
+    mutexLock(std::addressof(mutex));
+    ON_SCOPE_EXIT { mutexUnlock(std::addressof(mutex)); };
 
+    const auto start = armGetSystemTick();
+    while (free_slots.empty() && write_running && R_SUCCEEDED(GetResults())) {
         R_TRY(condvarWait(std::addressof(can_read), std::addressof(mutex)));
     }
+    read_stall_ticks += armGetSystemTick() - start;
 
-    ON_SCOPE_EXIT { mutexUnlock(std::addressof(mutex)); };
     R_TRY(GetResults());
-    write_buffers.ringbuf_push(buf, 0);
+    if (!free_slots.empty()) {
+        index_out = free_slots.pop();
+    }
+    R_SUCCEED();
+}
+
+Result ThreadData::PushFilledSlot(u32 index, s64 size) {
+    mutexLock(std::addressof(mutex));
+    ON_SCOPE_EXIT { mutexUnlock(std::addressof(mutex)); };
+
+    slots[index].size = size;
+    filled_slots.push(index);
+    max_queued = std::max(max_queued, filled_slots.size());
     return condvarWakeOne(std::addressof(can_write));
 }
 
-Result ThreadData::GetWriteBuf(std::vector<u8>& buf_out, s64& off_out) {
+// index_out is -1 once the read thread has stopped and everything was written.
+Result ThreadData::AcquireFilledSlot(s32& index_out) {
+    index_out = -1;
+
     mutexLock(std::addressof(mutex));
-    if (!write_buffers.ringbuf_size()) {
-        if (!read_running) {
-            buf_out.resize(0);
-            R_SUCCEED();
-        }
+    ON_SCOPE_EXIT { mutexUnlock(std::addressof(mutex)); };
+
+    const auto start = armGetSystemTick();
+    while (filled_slots.empty() && read_running && R_SUCCEEDED(GetResults())) {
         R_TRY(condvarWait(std::addressof(can_write), std::addressof(mutex)));
     }
+    write_stall_ticks += armGetSystemTick() - start;
 
-    ON_SCOPE_EXIT { mutexUnlock(std::addressof(mutex)); };
     R_TRY(GetResults());
-    write_buffers.ringbuf_pop(buf_out, off_out);
+    if (!filled_slots.empty()) {
+        index_out = filled_slots.pop();
+    }
+    R_SUCCEED();
+}
+
+Result ThreadData::ReleaseSlot(u32 index) {
+    mutexLock(std::addressof(mutex));
+    ON_SCOPE_EXIT { mutexUnlock(std::addressof(mutex)); };
+
+    free_slots.push(index);
     return condvarWakeOne(std::addressof(can_read));
 }
 
@@ -194,25 +298,23 @@ Result ThreadData::Read(void* buf, s64 size, u64* bytes_read) {
 
 // read thread reads all data from rfunc.
 Result ThreadData::readFuncInternal() {
-    ON_SCOPE_EXIT{ read_running = false; };
-
-    // the main buffer which data is read into.
-    std::vector<u8> buf;
-    buf.reserve(this->read_buffer_size);
-
     while (this->read_offset < this->write_size && R_SUCCEEDED(this->GetResults())) {
-        // read more data
-        s64 read_size = this->read_buffer_size;
+        s32 index;
+        R_TRY(this->AcquireFreeSlot(index));
+        if (index < 0) {
+            break;
+        }
 
+        // read more data straight into the pooled buffer.
         u64 bytes_read{};
-        buf.resize(read_size);
-        R_TRY(this->Read(buf.data(), read_size, std::addressof(bytes_read)));
-        if (!bytes_read) {
+        const auto rc = this->Read(slots[index].data, this->read_buffer_size, std::addressof(bytes_read));
+        if (R_FAILED(rc) || !bytes_read) {
+            this->ReleaseSlot(index);
+            R_TRY(rc);
             break;
         }
 
-        const auto buf_size = bytes_read;
-        R_TRY(this->SetWriteBuf(buf, buf_size));
+        R_TRY(this->PushFilledSlot(index, bytes_read));
     }
 
     R_SUCCEED();
@@ -220,21 +322,18 @@ Result ThreadData::readFuncInternal() {
 
 // write thread writes data to wfunc.
 Result ThreadData::writeFuncInternal() {
-    ON_SCOPE_EXIT{ write_running = false; };
-
-    std::vector<u8> buf;
-    buf.reserve(this->read_buffer_size);
-
     while (this->write_offset < this->write_size && R_SUCCEEDED(this->GetResults())) {
-        s64 dummy_off;
-        R_TRY(this->GetWriteBuf(buf, dummy_off));
-        const auto size = buf.size();
-        if (!size) {
+        s32 index;
+        R_TRY(this->AcquireFilledSlot(index));
+        if (index < 0) {
             break;
         }
 
-        R_TRY(this->wfunc(buf.data(), this->write_offset, buf.size()));
-        this->write_offset += size;
+        const auto& slot = slots[index];
+        R_TRY(this->wfunc(slot.data, this->write_offset, slot.size));
+        this->write_offset += slot.size;
+
+        R_TRY(this->ReleaseSlot(index));
     }
 
     R_SUCCEED();
@@ -242,15 +341,34 @@ Result ThreadData::writeFuncInternal() {
 
 void readFunc(void* d) {
     auto t = static_cast<ThreadData*>(d);
-    t->SetReadResult(t->readFuncInternal());
+    const auto rc = t->readFuncInternal();
+    t->SetReadFinished();
+    t->SetReadResult(rc);
 }
 
 void writeFunc(void* d) {
     auto t = static_cast<ThreadData*>(d);
-    t->SetWriteResult(t->writeFuncInternal());
+    const auto rc = t->writeFuncInternal();
+    t->SetWriteFinished();
+    t->SetWriteResult(rc);
 }
 
-Result TransferInternal(s64 size, const ReadCallback& rfunc, const WriteCallback& wfunc, Mode mode, u64 buffer_size = BUFFER_SIZE) {
+Result TransferInternal(s64 size, const ReadCallback& rfunc, const WriteCallback& wfunc, Mode mode) {
+    const auto config = GetTransferConfig();
+    auto buffer_size = config.buffer_size;
+
+    mutexLock(std::addressof(g_pool.mutex));
+    ON_SCOPE_EXIT { mutexUnlock(std::addressof(g_pool.mutex)); };
+
+    // a pipeline needs at least two buffers, otherwise run it on this thread.
+    u32 depth = 0;
+    if (mode != Mode::SingleThreaded) {
+        depth = g_pool.Ensure(config.depth, config.buffer_size);
+        if (depth < MIN_DEPTH) {
+            mode = Mode::SingleThreaded;
+        }
+    }
+
     if (mode == Mode::SingleThreadedIfSmaller) {
         if ((u64)size <= buffer_size) {
             mode = Mode::SingleThreaded;
@@ -262,18 +380,26 @@ Result TransferInternal(s64 size, const ReadCallback& rfunc, const WriteCallback
     buffer_size = std::min<u64>(size, buffer_size);
 
     if (mode == Mode::SingleThreaded) {
-        std::vector<u8> buf(buffer_size);
+        // borrow a pooled buffer if one is around, only allocate as a fallback.
+        std::vector<u8> fallback;
+        u8* buf;
+        if (!g_pool.buffers.empty() && g_pool.buffer_size >= buffer_size) {
+            buf = g_pool.buffers[0].get();
+        } else {
+            fallback.resize(buffer_size);
+            buf = fallback.data();
+        }
 
         s64 offset{};
         while (offset < size) {
             u64 bytes_read;
-            const auto rsize = std::min<s64>(buf.size(), size - offset);
-            R_TRY(rfunc(buf.data(), offset, rsize, &bytes_read));
+            const auto rsize = std::min<s64>(buffer_size, size - offset);
+            R_TRY(rfunc(buf, offset, rsize, &bytes_read));
             if (!bytes_read) {
                 break;
             }
 
-            R_TRY(wfunc(buf.data(), offset, bytes_read));
+            R_TRY(wfunc(buf, offset, bytes_read));
 
             offset += bytes_read;
         }
@@ -283,7 +409,8 @@ Result TransferInternal(s64 size, const ReadCallback& rfunc, const WriteCallback
     else {
         UEvent uevent;
         ueventCreate(&uevent, false);
-        ThreadData t_data{uevent, size, rfunc, wfunc, buffer_size};
+        ThreadData t_data{uevent, size, rfunc, wfunc, buffer_size, g_pool, depth};
+        const auto start = armGetSystemTick();
 
         Thread t_read{};
         R_TRY(utils::CreateThread(&t_read, readFunc, std::addressof(t_data)));
@@ -314,6 +441,12 @@ Result TransferInternal(s64 size, const ReadCallback& rfunc, const WriteCallback
             break;
         }
 
+        auto stats = t_data.GetStats();
+        stats.elapsed_ns = armTicksToNs(armGetSystemTick() - start);
+        mutexLock(std::addressof(g_state_mutex));
+        g_last_stats = stats;
+        mutexUnlock(std::addressof(g_state_mutex));
+
         R_RETURN(t_data.GetResults());
     }
 }
@@ -324,4 +457,30 @@ Result Transfer(s64 size, const ReadCallback& rfunc, const WriteCallback& wfunc,
     return TransferInternal(size, rfunc, wfunc, mode);
 }
 
+void SetTransferConfig(const TransferConfig& config) {
+    mutexLock(std::addressof(g_state_mutex));
+    g_config.buffer_size = std::clamp(config.buffer_size, MIN_BUFFER_SIZE, MAX_BUFFER_SIZE);
+    const auto max_depth = static_cast<u32>(std::clamp<u64>(MAX_POOL_SIZE / g_config.buffer_size, MIN_DEPTH, MAX_DEPTH));
+    g_config.depth = std::clamp(config.depth, MIN_DEPTH, max_depth);
+    mutexUnlock(std::addressof(g_state_mutex));
+}
+
+auto GetTransferConfig() -> TransferConfig {
+    mutexLock(std::addressof(g_state_mutex));
+    ON_SCOPE_EXIT { mutexUnlock(std::addressof(g_state_mutex)); };
+    return g_config;
+}
+
+auto GetLastTransferStats() -> TransferStats {
+    mutexLock(std::addressof(g_state_mutex));
+    ON_SCOPE_EXIT { mutexUnlock(std::addressof(g_state_mutex)); };
+    return g_last_stats;
+}
+
+void FreeTransferBuffers() {
+    mutexLock(std::addressof(g_pool.mutex));
+    g_pool.Free();
+    mutexUnlock(std::addressof(g_pool.mutex));
+}
+
 } // namespace::thread
@@ -63,7 +63,8 @@ namespace tin::data
 			NcaWriter m_writer;
 
         public:
-            BufferedPlaceholderWriter(std::shared_ptr<nx::ncm::ContentStorage>& contentStorage, NcmContentId ncaId, size_t totalDataSize);
+            // resumeOffset bytes of a plain NCA are assumed to already be in the placeholder
+            BufferedPlaceholderWriter(std::shared_ptr<nx::ncm::ContentStorage>& contentStorage, NcmContentId ncaId, size_t totalDataSize, size_t resumeOffset = 0);
 
             void AppendData(void* source, size_t length);
             bool CanAppendData(size_t length);
@@ -83,6 +84,8 @@ namespace tin::data
             size_t GetTotalDataSize();
             size_t GetSizeBuffered();
             size_t GetSizeWrittenToPlaceholder();
+            // Whether the bytes written so far can be continued from by a later attempt
+            bool IsResumable();
 
             void DebugPrintBuffers();
     };
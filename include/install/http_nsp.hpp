@@ -33,8 +33,14 @@ namespace tin::install::nsp
             tin::network::HTTPDownload m_download;
 
             HTTPNSP(std::string url);
+            // Takes over a download whose initial request already ran, e.g. to check range support
+            HTTPNSP(tin::network::HTTPDownload download);
 
             virtual void StreamToPlaceholder(std::shared_ptr<nx::ncm::ContentStorage>& contentStorage, NcmContentId placeholderId) override;
             virtual void BufferData(void* buf, off_t offset, size_t size) override;
+            virtual u64 GetResumeOffset(std::shared_ptr<nx::ncm::ContentStorage>& contentStorage, const NcmContentId& placeholderId) override;
+
+        private:
+            std::string m_sourceId;
     };
 }
\ No newline at end of file
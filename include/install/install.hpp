@@ -29,10 +29,12 @@ extern "C"
 
 #include <memory>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include "install/simple_filesystem.hpp"
 #include "data/byte_buffer.hpp"
+#include "install/nca.hpp"
 
 #include "nx/content_meta.hpp"
 #include "nx/ipc/tin_ipc.h"
@@ -46,7 +48,18 @@ namespace tin::install
             bool m_ignoreReqFirmVersion = false;
             bool m_declinedValidation = false;
 
+            struct TicketCert
+            {
+                std::vector<u8> tik;
+                std::vector<u8> cert;
+            };
+
             std::vector<nx::ncm::ContentMeta> m_contentMeta;
+            std::vector<tin::data::ByteBuffer> m_installContentMetaBufs;
+            std::vector<TicketCert> m_stagedTicketCerts;
+            std::vector<std::pair<NcmContentId, std::vector<u8>>> m_prefetchedNcas;
+            // Decrypted signed part of NCA headers read ahead for validation
+            std::vector<std::pair<NcmContentId, std::vector<u8>>> m_prefetchedHeaders;
 
             Install(NcmStorageId destStorageId, bool ignoreReqFirmVersion);
 
@@ -57,12 +70,35 @@ namespace tin::install
             virtual void InstallTicketCert() = 0;
             virtual void InstallNCA(const NcmContentId &ncaId) = 0;
 
+            // Reads the tik/cert pairs from the source into m_stagedTicketCerts without importing them
+            virtual void ReadTicketCert() {}
+            void ImportStagedTicketCert();
+            bool TakePrefetchedNca(const NcmContentId& ncaId, std::vector<u8>& outData);
+            const std::vector<u8>* FindPrefetchedNca(const NcmContentId& ncaId) const;
+            // Decrypts the start of an encrypted NCA header, keeps it for ReadPrefetchedHeader and
+            // returns whether it was usable. SubmitPrefetchedHeaders queues all of them for verification.
+            bool AddPrefetchedHeader(const NcmContentId& ncaId, const u8* encrypted, size_t size);
+            void SubmitPrefetchedHeaders();
+            bool ReadPrefetchedHeader(const NcmContentId& ncaId, tin::install::NcaHeader& outHeader);
+
         public:
             virtual ~Install();
 
             virtual void Prepare();
             virtual void Begin();
 
+            // Split install phases used by the multi-title install queue. Prepare()/Begin() keep the
+            // original order (records, ticket, data); the queue runs data first and commits afterwards
+            // so the commit of one title can overlap the transfer of the next.
+
+            // Reads the CNMT NCAs into memory. Must not touch the UI; may run on a worker thread.
+            virtual void PrefetchMetadata() {}
+            void PrepareMetadata();
+            void StageTicketCert();
+            void InstallContent();
+            // Imports staged tickets and pushes content meta/application records. No source I/O.
+            void Commit();
+
             virtual u64 GetTitleId(int i = 0);
             virtual NcmContentMetaType GetContentMetaType(int i = 0);
     };
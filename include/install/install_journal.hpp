@@ -0,0 +1,24 @@
+#pragma once
+
+#include <switch.h>
+
+#include <string>
+
+// Persistent per-NCA progress journal. Records how many bytes of each
+// placeholder have been written by a range-capable source, so an interrupted
+// install can reopen the placeholder and continue from the last checkpoint
+// instead of downloading the NCA again.
+namespace tin::install::journal
+{
+    // Bytes between two checkpoints of the same NCA
+    static const u64 CHECKPOINT_INTERVAL = 0x4000000; // 64MB
+
+    // Identifies the exact file being installed: url, size and etag when known.
+    std::string MakeSourceId(const std::string& url, const std::string& size, const std::string& etag);
+
+    // Returns the bytes committed to the placeholder of ncaId by a previous
+    // attempt from the same source, or 0 if there is nothing to resume.
+    u64 GetCheckpoint(const std::string& sourceId, const NcmContentId& ncaId);
+    void SaveCheckpoint(const std::string& sourceId, const NcmContentId& ncaId, u64 committed);
+    void ClearCheckpoint(const NcmContentId& ncaId);
+}
@@ -38,8 +38,10 @@ namespace tin::install::nsp
             std::vector<std::tuple<nx::ncm::ContentMeta, NcmContentInfo>> ReadCNMT() override;
             void InstallNCA(const NcmContentId& ncaId) override;
             void InstallTicketCert() override;
+            void ReadTicketCert() override;
 
         public:
             NSPInstall(NcmStorageId destStorageId, bool ignoreReqFirmVersion, const std::shared_ptr<NSP>& remoteNSP);
+            void PrefetchMetadata() override;
     };
 }
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <switch.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "install/install.hpp"
+
+// Runs a list of titles as one pipeline instead of Prepare()/Begin() per title.
+// While title N streams its NCAs, the task for title N+1 is created and its
+// CNMT pulled into memory on a worker thread, and title N-1's ticket import
+// and content meta/application records are committed on a separate lane.
+// A failing title is recorded and the queue moves on to the next one.
+namespace tin::install
+{
+    struct InstallQueueItem
+    {
+        std::string name;
+        // Builds the install task. Called on a worker thread when the source allows
+        // concurrent reads, so it must not touch the UI. Returns nullptr when the item
+        // has to go through installDirect instead.
+        std::function<std::unique_ptr<Install>()> createTask;
+        // Installs the item without a task (e.g. streamed installs). Called on the
+        // calling thread when createTask is empty or returned nullptr.
+        std::function<void()> installDirect;
+    };
+
+    struct InstallQueueOptions
+    {
+        // False for sources with a single pipe (USB): the next task is then created
+        // only after the current title has finished reading from the source.
+        bool concurrentSourceReads = true;
+        // False when one failed transfer leaves the source unusable for the rest of the list.
+        bool continueAfterFailure = true;
+        // Called on the calling thread before each item starts.
+        std::function<void(size_t index)> onTitleStart;
+        // Called on the calling thread once the item's metadata has been installed.
+        std::function<void(size_t index, Install& task)> onTaskPrepared;
+    };
+
+    struct InstallQueueFailure
+    {
+        size_t index = 0;
+        std::string name;
+        std::string error;
+    };
+
+    std::vector<InstallQueueFailure> RunInstallQueue(const std::vector<InstallQueueItem>& items, const InstallQueueOptions& options = {});
+}
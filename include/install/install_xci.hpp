@@ -39,9 +39,11 @@ namespace tin::install::xci
             std::vector<std::tuple<nx::ncm::ContentMeta, NcmContentInfo>> ReadCNMT() override;
             void InstallNCA(const NcmContentId& ncaId) override;
             void InstallTicketCert() override;
+            void ReadTicketCert() override;
 
         public:
             XCIInstallTask(NcmStorageId destStorageId, bool ignoreReqFirmVersion, const std::shared_ptr<XCI>& xci);
+            void PrefetchMetadata() override;
     };
 };
 
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <switch.h>
+
+#include <array>
+#include <vector>
+
+#include "install/nca.hpp"
+
+// Checks the fixed-key RSA-PSS signature of NCA headers on a worker thread.
+// Install tasks submit every header of a title as soon as they are read, and
+// InstallNCA then only picks up the result. Results are cached by the SHA-256
+// of the signed header bytes for the rest of the session, so retries and
+// re-installs of the same content skip the modular exponentiation.
+namespace tin::install::verify
+{
+    // Signature plus the signed region; all a check needs from a decrypted header
+    constexpr size_t SignedHeaderSize = 0x400;
+    using SignedHeader = std::array<u8, SignedHeaderSize>;
+
+    // Queues the headers for the worker. Headers already cached or queued are skipped.
+    void SubmitBatch(const std::vector<SignedHeader>& headers);
+
+    // Result for a decrypted header. Waits if the worker is already checking it and
+    // checks on the calling thread if it has not started yet.
+    bool IsFixedKeySignatureValid(const NcaHeader& header);
+
+    void Shutdown();
+}
@@ -23,6 +23,7 @@ SOFTWARE.
 #pragma once
 
 #include <functional>
+#include <memory>
 #include <vector>
 
 #include <switch/types.h>
@@ -42,6 +43,8 @@ namespace tin::install::nsp
         public:
             virtual void StreamToPlaceholder(std::shared_ptr<nx::ncm::ContentStorage>& contentStorage, NcmContentId placeholderId) = 0;
             virtual void BufferData(void* buf, off_t offset, size_t size) = 0;
+            // Bytes of the placeholder kept from an interrupted attempt, 0 to start over
+            virtual u64 GetResumeOffset(std::shared_ptr<nx::ncm::ContentStorage>& contentStorage, const NcmContentId& placeholderId) { return 0; }
 
             virtual void RetrieveHeader();
             virtual const PFS0BaseHeader* GetBaseHeader();
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <switch.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "install/install.hpp"
+#include "nx/content_meta.hpp"
+#include "nx/nca_writer.h"
+#include "nx/ncm.hpp"
+#include "util/network_util.hpp"
+
+// Source-agnostic streaming install engine.
+// Containers (NSP/NSZ/XCI/XCZ) are described by a flat entry table; bytes are
+// either pushed into the installer as they arrive (MTP, LAN push, sequential HTTP)
+// or pulled from a ByteSource (HTTP ranges, MTP and LAN push XCIs). Every path
+// shares the same entry state machine, ticket/cert pairing and CNMT commit.
+// USB installs stay on the USBNSP/USBXCI install tasks.
+namespace tin::install::stream
+{
+    class ByteSource
+    {
+        public:
+            virtual ~ByteSource() = default;
+
+            // Reads exactly size bytes at off. Sequential sources only accept
+            // offsets at or past the current position and skip any gap.
+            virtual Result Read(void* buf, s64 off, s64 size, u64* bytes_read) = 0;
+            virtual bool IsSequential() const { return false; }
+    };
+
+    // Random-access source with a read-ahead window, shared by all range-capable transports.
+    class ReadAheadSource : public ByteSource
+    {
+        public:
+            explicit ReadAheadSource(size_t read_ahead_size);
+
+            Result Read(void* buf, s64 off, s64 size, u64* bytes_read) override;
+
+        protected:
+            // Fetches up to size bytes at off into buf, returns the number of bytes fetched.
+            virtual size_t Fetch(void* buf, u64 off, size_t size) = 0;
+
+        private:
+            size_t m_read_ahead_size;
+            std::vector<u8> m_cache;
+            u64 m_cache_start = 0;
+            u64 m_cache_end = 0;
+    };
+
+    class HttpByteSource final : public ReadAheadSource
+    {
+        public:
+            explicit HttpByteSource(tin::network::HTTPDownload& download, size_t read_ahead_size = 16 * 1024 * 1024);
+
+        protected:
+            size_t Fetch(void* buf, u64 off, size_t size) override;
+
+        private:
+            tin::network::HTTPDownload& m_download;
+    };
+
+    struct StreamEntry
+    {
+        enum class Kind : u8
+        {
+            Other,
+            Nca,
+            Ticket,
+            Cert,
+        };
+
+        std::string name;
+        u64 offset = 0; // Absolute offset inside the container
+        u64 size = 0;
+        Kind kind = Kind::Other;
+        bool isCnmt = false;
+        NcmContentId ncaId{};
+    };
+
+    StreamEntry MakeStreamEntry(std::string name, u64 offset, u64 size);
+
+    // Parses a complete PFS0 header held in memory. Returns false while more bytes
+    // are needed; out_header_size receives the full header size once known.
+    bool ParsePfs0Entries(const u8* data, size_t size, std::vector<StreamEntry>& out, size_t* out_header_size);
+    bool ReadPfs0Entries(ByteSource& source, std::vector<StreamEntry>& out);
+    bool ReadXciEntries(ByteSource& source, std::vector<StreamEntry>& out);
+
+    class StreamInstallHelper final : public tin::install::Install
+    {
+        public:
+            StreamInstallHelper(NcmStorageId destStorageId, bool ignoreReqFirmVersion);
+
+            void AddContentMeta(const nx::ncm::ContentMeta& meta, const NcmContentInfo& info);
+            void CommitLatest();
+            void CommitAll();
+
+        private:
+            std::vector<NcmContentInfo> m_cnmtInfos;
+
+            std::vector<std::tuple<nx::ncm::ContentMeta, NcmContentInfo>> ReadCNMT() override { return {}; }
+            void InstallTicketCert() override {}
+            void InstallNCA(const NcmContentId& /*ncaId*/) override {}
+    };
+
+    class StreamInstaller
+    {
+        public:
+            using ProgressFunc = std::function<void(u64 processed, u64 total)>;
+            using CnmtFunc = std::function<void(nx::ncm::ContentMeta& meta)>;
+
+            StreamInstaller(NcmStorageId destStorageId, bool ignoreReqFirmVersion);
+            ~StreamInstaller();
+
+            void SetEntries(std::vector<StreamEntry> entries);
+            bool HasEntries() const { return !m_entries.empty(); }
+            u64 GetTotalSize() const;
+            // True once every NCA, ticket and cert entry has been fully written.
+            bool IsComplete() const;
+            void SetCnmtCallback(CnmtFunc func) { m_onCnmt = std::move(func); }
+            // Checks the signature of every NCA header before any of it is written, with the same
+            // decline prompt as the install tasks. Only for installers driven from the UI thread.
+            void SetValidateNCAs(bool validate) { m_validateNCAs = validate; }
+
+            // Push mode: data is a slice of the container at the given absolute offset.
+            bool Feed(const void* buf, size_t size, u64 offset);
+            // Pull mode: reads every entry from the source in offset order.
+            bool Pull(ByteSource& source, const ProgressFunc& progress = nullptr);
+            // Imports tickets and commits all content meta records.
+            bool Finalize();
+
+        private:
+            static constexpr size_t kNoPair = static_cast<size_t>(-1);
+
+            struct EntryState
+            {
+                StreamEntry info;
+                u64 written = 0;
+                bool started = false;
+                bool complete = false;
+                bool imported = false;
+                bool headerPending = false; // NCA bytes held in data until the signed header is checked
+                size_t pair = kNoPair; // Matching cert for a ticket and vice versa
+                std::shared_ptr<nx::ncm::ContentStorage> storage;
+                std::unique_ptr<NcaWriter> ncaWriter;
+                std::vector<u8> data; // Ticket / cert payload or the signed part of an NCA header
+            };
+
+            bool StartEntry(EntryState& entry);
+            bool WriteEntry(EntryState& entry, const u8* data, size_t size, u64 relOffset);
+            void VerifyNcaHeader(EntryState& entry);
+            void CompleteNca(EntryState& entry);
+            bool CommitCnmt(EntryState& entry);
+            // Imports the ticket of a tik/cert pair once both halves are complete.
+            void ImportTicketPair(EntryState& entry);
+            bool PrefetchTicketCerts(ByteSource& source);
+            bool ImportTickets();
+
+            NcmStorageId m_destStorageId;
+            std::vector<EntryState> m_entries;
+            size_t m_hintIndex = 0;
+            bool m_ticketFailed = false;
+            bool m_validateNCAs = false;
+            bool m_declinedValidation = false;
+            std::unique_ptr<StreamInstallHelper> m_helper;
+            CnmtFunc m_onCnmt;
+    };
+
+    // Push-mode PFS0 container. Slices are buffered until the header is complete,
+    // then forwarded to the installer, so a single sequential read of the file
+    // (MTP upload, HTTP GET without ranges) is enough to install it.
+    class Pfs0PushStream
+    {
+        public:
+            Pfs0PushStream(NcmStorageId destStorageId, bool ignoreReqFirmVersion);
+
+            StreamInstaller& GetInstaller() { return m_installer; }
+            bool IsHeaderParsed() const { return m_headerParsed; }
+            // Offset of the end of the last entry, 0 until the header is parsed.
+            u64 GetContainerSize() const { return m_containerSize; }
+
+            bool Feed(const void* buf, size_t size, u64 offset);
+            bool Finalize();
+
+        private:
+            std::vector<u8> m_headerBytes;
+            bool m_headerParsed = false;
+            u64 m_containerSize = 0;
+            StreamInstaller m_installer;
+    };
+
+    // Reads the container index from the source and installs every entry.
+    bool InstallFromSource(ByteSource& source, bool isXci, NcmStorageId destStorageId, bool validateNCAs, const StreamInstaller::ProgressFunc& progress = nullptr, const StreamInstaller::CnmtFunc& onCnmt = nullptr);
+    // Installs an NSP/NSZ from one sequential GET, without any range requests.
+    bool InstallNspFromHttpSequential(tin::network::HTTPDownload& download, NcmStorageId destStorageId, bool validateNCAs, const StreamInstaller::ProgressFunc& progress = nullptr);
+}
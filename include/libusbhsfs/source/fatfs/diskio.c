@@ -13,6 +13,7 @@
 #include "../usbhsfs_utils.h"
 #include "../usbhsfs_manager.h"
 #include "../usbhsfs_scsi.h"
+#include "../usbhsfs_cache.h"
 
 /* Reference for needed FATFS impl functions: http://irtos.sourceforge.net/FAT32_ChaN/doc/en/appnote.html#port */
 
@@ -62,7 +63,7 @@ DRESULT ff_disk_read (
 
     /* Get LUN context and read logical blocks. */
     lun_ctx = usbHsFsManagerGetLogicalUnitContextForFatFsDriveNumber(pdrv);
-    if (lun_ctx && usbHsFsScsiReadLogicalUnitBlocks(lun_ctx, buff, sector, count)) ret = RES_OK;
+    if (lun_ctx && usbHsFsCacheReadLogicalUnitBlocks(lun_ctx, buff, sector, count)) ret = RES_OK;
 
     return ret;
 }
@@ -84,7 +85,7 @@ DRESULT ff_disk_write (
 
     /* Get LUN context and write logical blocks. */
     lun_ctx = usbHsFsManagerGetLogicalUnitContextForFatFsDriveNumber(pdrv);
-    if (lun_ctx && usbHsFsScsiWriteLogicalUnitBlocks(lun_ctx, buff, sector, count)) ret = RES_OK;
+    if (lun_ctx && usbHsFsCacheWriteLogicalUnitBlocks(lun_ctx, buff, sector, count)) ret = RES_OK;
 
     return ret;
 }
@@ -111,7 +112,8 @@ DRESULT ff_disk_ioctl (
         switch(cmd)
         {
             case CTRL_SYNC:
-                ret = RES_OK;
+                /* Write pending blocks from the block cache. */
+                ret = (usbHsFsCacheFlushLogicalUnit(lun_ctx) ? RES_OK : RES_ERROR);
                 break;
             case GET_SECTOR_COUNT:
                 *(LBA_t*)buff = lun_ctx->block_count;
@@ -46,6 +46,12 @@ do { \
 #define ff_return_ptr(x)            return (ff_ended_with_error ? NULL : (x))
 #define ff_return_bool              return (ff_ended_with_error ? false : true)
 
+/* Initial cluster link map table size (in DWORDs). Grown to the file's fragment count as needed. */
+#define FFDEV_CLMT_INITIAL_SIZE     64
+
+/* Upper bound for the cluster link map table size (in DWORDs). Files fragmented beyond this fall back to normal seeks. */
+#define FFDEV_CLMT_MAX_SIZE         0x100000
+
 /* Function prototypes. */
 
 static int       ffdev_open(struct _reent *r, void *fd, const char *path, int flags, int mode);
@@ -74,6 +80,9 @@ static int       ffdev_utimes(struct _reent *r, const char *filename, const stru
 
 static bool ffdev_fixpath(struct _reent *r, const char *path, UsbHsFsDriveLogicalUnitFileSystemContext **fs_ctx, char *outpath);
 
+static void ffdev_setup_fast_seek(FIL *file);
+static void ffdev_free_fast_seek(FIL *file);
+
 static void ffdev_fill_stat(struct stat *st, const FILINFO *info);
 
 static int ffdev_translate_error(FRESULT res);
@@ -202,6 +211,10 @@ static int ffdev_close(struct _reent *r, void *fd)
 
     /* Close file. */
     res = ff_close(file);
+
+    /* Free the cluster link map table, if we built one. */
+    ffdev_free_fast_seek(file);
+
     if (res != FR_OK) ff_set_error_and_exit(ffdev_translate_error(res));
 
     /* Reset file descriptor. */
@@ -307,6 +320,9 @@ static off_t ffdev_seek(struct _reent *r, void *fd, off_t pos, int dir)
 
     USBHSFS_LOG_MSG("Seeking to offset 0x%lX from file in \"%u:\".", offset, file->obj.fs->pdrv);
 
+    /* Build the cluster link map table on the first real seek, so following seeks don't have to walk the FAT chain. */
+    if ((FSIZE_t)offset != ff_tell(file)) ffdev_setup_fast_seek(file);
+
     /* Perform file seek. */
     res = ff_lseek(file, (FSIZE_t)offset);
     if (res != FR_OK) ff_set_error(ffdev_translate_error(res));
@@ -820,6 +836,58 @@ end:
     ff_return_bool;
 }
 
+static void ffdev_setup_fast_seek(FIL *file)
+{
+    FATFS *fs = file->obj.fs;
+    DWORD *tbl = NULL, *tmp_tbl = NULL;
+    DWORD tbl_size = FFDEV_CLMT_INITIAL_SIZE;
+    FRESULT res = FR_OK;
+
+#if FF_MAX_SS != FF_MIN_SS
+    const FSIZE_t sector_size = (fs ? fs->ssize : FF_MAX_SS);
+#else
+    const FSIZE_t sector_size = FF_MAX_SS;
+#endif
+
+    /* Fast seek mode can't be used on files that may grow, and doesn't help with files that fit in a single cluster. */
+    if (!fs || file->cltbl || (file->flag & FA_WRITE) || ff_size(file) <= ((FSIZE_t)fs->csize * sector_size)) return;
+
+    while(true)
+    {
+        tmp_tbl = realloc(tbl, tbl_size * sizeof(DWORD));
+        if (!tmp_tbl) break;
+
+        tbl = tmp_tbl;
+        tbl[0] = tbl_size;
+        file->cltbl = tbl;
+
+        /* Create the cluster link map table. On FR_NOT_ENOUGH_CORE, the first entry holds the required size. */
+        res = ff_lseek(file, CREATE_LINKMAP);
+        if (res == FR_OK)
+        {
+            USBHSFS_LOG_MSG("Built cluster link map table for file in \"%u:\" (%u DWORD(s)).", fs->pdrv, tbl[0]);
+            return;
+        }
+
+        file->cltbl = NULL;
+        if (res != FR_NOT_ENOUGH_CORE || tbl[0] <= tbl_size || tbl[0] > FFDEV_CLMT_MAX_SIZE) break;
+
+        tbl_size = tbl[0];
+    }
+
+    USBHSFS_LOG_MSG("Unable to build cluster link map table for file in \"%u:\" (%u). Using normal seeks.", fs->pdrv, res);
+
+    if (tbl) free(tbl);
+}
+
+static void ffdev_free_fast_seek(FIL *file)
+{
+    if (!file->cltbl) return;
+
+    free(file->cltbl);
+    file->cltbl = NULL;
+}
+
 static void ffdev_fill_stat(struct stat *st, const FILINFO *info)
 {
     struct tm timeinfo = {0};
@@ -13,6 +13,7 @@
 
 #include "../usbhsfs_manager.h"
 #include "../usbhsfs_mount.h"
+#include "../usbhsfs_cache.h"
 
 /* Helper macros. */
 
@@ -167,6 +168,9 @@ static int extdev_close(struct _reent *r, void *fd)
     /* Reset file descriptor. */
     memset(file, 0, sizeof(ext4_file));
 
+    /* Write pending blocks from the block cache. */
+    if (!usbHsFsCacheFlushLogicalUnit(lun_ctx)) ext_set_error_and_exit(EIO);
+
 end:
     ext_unlock_drive_ctx;
     ext_return(0);
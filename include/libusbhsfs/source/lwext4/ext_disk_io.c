@@ -9,6 +9,7 @@
 #include "ext.h"
 
 #include "../usbhsfs_scsi.h"
+#include "../usbhsfs_cache.h"
 
 /* Function prototypes. */
 
@@ -117,14 +118,14 @@ static int ext_blockdev_bread(struct ext4_blockdev *bdev, void *buf, uint64_t bl
 {
     /* Get LUN context and read sectors. */
     UsbHsFsDriveLogicalUnitContext *lun_ctx = (UsbHsFsDriveLogicalUnitContext*)bdev->bdif->p_user;
-    return (usbHsFsScsiReadLogicalUnitBlocks(lun_ctx, buf, blk_id, blk_cnt) ? 0 : EIO);
+    return (usbHsFsCacheReadLogicalUnitBlocks(lun_ctx, buf, blk_id, blk_cnt) ? 0 : EIO);
 }
 
 static int ext_blockdev_bwrite(struct ext4_blockdev *bdev, const void *buf, uint64_t blk_id, uint32_t blk_cnt)
 {
     /* Get LUN context and write sectors. */
     UsbHsFsDriveLogicalUnitContext *lun_ctx = (UsbHsFsDriveLogicalUnitContext*)bdev->bdif->p_user;
-    return (usbHsFsScsiWriteLogicalUnitBlocks(lun_ctx, buf, blk_id, blk_cnt) ? 0 : EIO);
+    return (usbHsFsCacheWriteLogicalUnitBlocks(lun_ctx, buf, blk_id, blk_cnt) ? 0 : EIO);
 }
 
 static int ext_blockdev_close(struct ext4_blockdev *bdev)
@@ -14,6 +14,7 @@
 
 #include "../usbhsfs_manager.h"
 #include "../usbhsfs_mount.h"
+#include "../usbhsfs_cache.h"
 
 /* Helper macros. */
 
@@ -304,6 +305,9 @@ static int ntfsdev_close(struct _reent *r, void *fd)
     /* Reset file state. */
     memset(file, 0, sizeof(ntfs_file_state));
 
+    /* Write pending blocks from the block cache. */
+    if (!usbHsFsCacheFlushLogicalUnit(lun_ctx)) ntfs_set_error_and_exit(EIO);
+
 end:
     ntfs_unlock_drive_ctx;
     ntfs_return(0);
@@ -15,6 +15,7 @@
 #include "ntfs.h"
 
 #include "../usbhsfs_scsi.h"
+#include "../usbhsfs_cache.h"
 
 /* Function prototypes. */
 
@@ -388,7 +389,7 @@ static bool ntfs_io_device_readsectors(struct ntfs_device *dev, u64 start, u32 c
 
     /* Get LUN context and read sectors. */
     UsbHsFsDriveLogicalUnitContext *lun_ctx = (UsbHsFsDriveLogicalUnitContext*)dd->lun_ctx;
-    return usbHsFsScsiReadLogicalUnitBlocks(lun_ctx, buf, start, count);
+    return usbHsFsCacheReadLogicalUnitBlocks(lun_ctx, buf, start, count);
 }
 
 static bool ntfs_io_device_writesectors(struct ntfs_device *dev, u64 start, u32 count, const void *buf)
@@ -399,11 +400,12 @@ static bool ntfs_io_device_writesectors(struct ntfs_device *dev, u64 start, u32
 
     /* Get LUN context and write sectors. */
     UsbHsFsDriveLogicalUnitContext *lun_ctx = (UsbHsFsDriveLogicalUnitContext*)dd->lun_ctx;
-    return usbHsFsScsiWriteLogicalUnitBlocks(lun_ctx, buf, start, count);
+    return usbHsFsCacheWriteLogicalUnitBlocks(lun_ctx, buf, start, count);
 }
 
 static int ntfs_io_device_sync(struct ntfs_device *dev)
 {
+    ntfs_dd *dd = (ntfs_dd*)dev->d_private;
     int ret = -1;
 
     USBHSFS_LOG_MSG("Device %p.", dev);
@@ -415,7 +417,12 @@ static int ntfs_io_device_sync(struct ntfs_device *dev)
         goto end;
     }
 
-    /* TODO: implement write cache? */
+    /* Write pending blocks from the block cache. */
+    if (dd && !usbHsFsCacheFlushLogicalUnit((UsbHsFsDriveLogicalUnitContext*)dd->lun_ctx))
+    {
+        errno = EIO;
+        goto end;
+    }
 
     /* Mark the device as clean. */
     NDevClearDirty(dev);
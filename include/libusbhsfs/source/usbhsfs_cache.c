@@ -0,0 +1,384 @@
+/*
+ * usbhsfs_cache.c
+ *
+ * Copyright (c) 2020-2023, DarkMatterCore <pabloacurielz@gmail.com>.
+ *
+ * This file is part of libusbhsfs (https://github.com/DarkMatterCore/libusbhsfs).
+ */
+
+#include "usbhsfs_utils.h"
+#include "usbhsfs_scsi.h"
+#include "usbhsfs_cache.h"
+
+#define USBHSFS_CACHE_PAGE_SIZE             0x8000      /* 32 KiB. */
+#define USBHSFS_CACHE_PAGE_COUNT            32          /* 1 MiB worth of metadata pages. */
+
+#define USBHSFS_CACHE_READ_AHEAD_MIN_SIZE   0x10000     /* 64 KiB. */
+#define USBHSFS_CACHE_READ_AHEAD_MAX_SIZE   0x100000    /* 1 MiB. */
+#define USBHSFS_CACHE_READ_AHEAD_THRESHOLD  2           /* Consecutive sequential reads required before read-ahead kicks in. */
+
+#define USBHSFS_CACHE_WRITE_BEHIND_SIZE     0x100000    /* 1 MiB. */
+
+/* Type definitions. */
+
+/// LRU page holding a block-aligned run of logical blocks.
+typedef struct {
+    u64 block_addr;     ///< First logical block held by this page. Always aligned to the page block count.
+    u32 block_count;    ///< Number of valid blocks. Zero if this page is unused. Only smaller than the page block count at the end of the LUN.
+    u64 last_used;      ///< LRU stamp.
+    u8 *data;           ///< Pointer to this page's data within the page buffer.
+} UsbHsFsCachePage;
+
+/// Per-LUN block cache context.
+typedef struct {
+    u32 block_length;                                   ///< Logical block length (bytes). Copied from the LUN context.
+
+    u8 *page_buf;                                       ///< Dynamically allocated buffer for all LRU pages.
+    u32 page_block_count;                               ///< Number of logical blocks held by each LRU page.
+    u64 lru_counter;                                    ///< Incremented on every page access.
+    UsbHsFsCachePage pages[USBHSFS_CACHE_PAGE_COUNT];   ///< LRU pages.
+
+    u8 *ra_buf;                                         ///< Dynamically allocated read-ahead buffer. May be NULL.
+    u32 ra_max_block_count;                             ///< Read-ahead buffer capacity (blocks).
+    u32 ra_window;                                      ///< Current read-ahead window (blocks). Doubles on every refill while reads stay sequential.
+    u64 ra_block_addr;                                  ///< First logical block held by the read-ahead buffer.
+    u32 ra_block_count;                                 ///< Number of valid blocks in the read-ahead buffer.
+    u64 next_read_addr;                                 ///< Logical block following the last read request. Used to detect sequential reads.
+    u32 seq_read_count;                                 ///< Number of consecutive sequential read requests.
+
+    u8 *wb_buf;                                         ///< Dynamically allocated write-behind buffer. May be NULL.
+    u32 wb_max_block_count;                             ///< Write-behind buffer capacity (blocks).
+    u64 wb_block_addr;                                  ///< First logical block held by the write-behind buffer.
+    u32 wb_block_count;                                 ///< Number of pending blocks in the write-behind buffer.
+} UsbHsFsCacheContext;
+
+/* Function prototypes. */
+
+static UsbHsFsCacheContext *usbHsFsCacheGetContext(UsbHsFsDriveLogicalUnitContext *lun_ctx);
+static void usbHsFsCacheFreeContext(UsbHsFsCacheContext *cache_ctx);
+
+static void usbHsFsCacheInvalidate(UsbHsFsCacheContext *cache_ctx);
+static void usbHsFsCacheCopyOverlappingBlocks(u8 *dst, u64 dst_addr, u32 dst_count, const u8 *src, u64 src_addr, u32 src_count, u32 block_length);
+
+static bool usbHsFsCacheReadFromLogicalUnit(UsbHsFsDriveLogicalUnitContext *lun_ctx, UsbHsFsCacheContext *cache_ctx, void *buf, u64 block_addr, u32 block_count);
+static UsbHsFsCachePage *usbHsFsCacheGetPage(UsbHsFsDriveLogicalUnitContext *lun_ctx, UsbHsFsCacheContext *cache_ctx, u64 block_addr);
+
+bool usbHsFsCacheReadLogicalUnitBlocks(UsbHsFsDriveLogicalUnitContext *lun_ctx, void *buf, u64 block_addr, u32 block_count)
+{
+    UsbHsFsCacheContext *cache_ctx = NULL;
+    u8 *data_buf = (u8*)buf;
+
+    /* Requests outside the LUN boundaries go straight to the LUN, which will reject them. */
+    if (!block_count || block_addr >= lun_ctx->block_count || block_count > (lun_ctx->block_count - block_addr) || !(cache_ctx = usbHsFsCacheGetContext(lun_ctx)))
+    {
+        return usbHsFsScsiReadLogicalUnitBlocks(lun_ctx, buf, block_addr, block_count);
+    }
+
+    u32 block_length = cache_ctx->block_length;
+
+    /* Update sequential read detection. */
+    if (block_addr == cache_ctx->next_read_addr)
+    {
+        (cache_ctx->seq_read_count)++;
+    } else {
+        cache_ctx->seq_read_count = 0;
+        cache_ctx->ra_window = (USBHSFS_CACHE_READ_AHEAD_MIN_SIZE / block_length);
+        if (!cache_ctx->ra_window) cache_ctx->ra_window = 1;
+    }
+
+    cache_ctx->next_read_addr = (block_addr + block_count);
+
+    /* Serve the request from the read-ahead buffer if it fully covers it. */
+    if (cache_ctx->ra_block_count && block_addr >= cache_ctx->ra_block_addr && (block_addr + block_count) <= (cache_ctx->ra_block_addr + cache_ctx->ra_block_count))
+    {
+        memcpy(data_buf, cache_ctx->ra_buf + ((block_addr - cache_ctx->ra_block_addr) * block_length), (u64)block_count * block_length);
+        return true;
+    }
+
+    /* Refill the read-ahead buffer if we're dealing with a sequential stream of reads smaller than the current read-ahead window. */
+    if (cache_ctx->ra_buf && cache_ctx->seq_read_count >= USBHSFS_CACHE_READ_AHEAD_THRESHOLD && block_count < cache_ctx->ra_window)
+    {
+        u32 ra_block_count = cache_ctx->ra_window;
+        if (ra_block_count > (lun_ctx->block_count - block_addr)) ra_block_count = (u32)(lun_ctx->block_count - block_addr);
+
+        USBHSFS_LOG_MSG("Reading ahead 0x%X block(s) from LBA 0x%lX (interface %d, LUN %u).", ra_block_count, block_addr, lun_ctx->usb_if_id, lun_ctx->lun);
+
+        cache_ctx->ra_block_count = 0;
+        if (!usbHsFsCacheReadFromLogicalUnit(lun_ctx, cache_ctx, cache_ctx->ra_buf, block_addr, ra_block_count)) return false;
+
+        cache_ctx->ra_block_addr = block_addr;
+        cache_ctx->ra_block_count = ra_block_count;
+
+        /* Grow the read-ahead window for the next refill. */
+        cache_ctx->ra_window *= 2;
+        if (cache_ctx->ra_window > cache_ctx->ra_max_block_count) cache_ctx->ra_window = cache_ctx->ra_max_block_count;
+
+        memcpy(data_buf, cache_ctx->ra_buf, (u64)block_count * block_length);
+        return true;
+    }
+
+    /* Serve small reads (FAT/MFT/inode metadata, directory entries, etc.) from the LRU pages. */
+    if (block_count <= cache_ctx->page_block_count)
+    {
+        u64 cur_block_addr = block_addr;
+
+        while(block_count)
+        {
+            UsbHsFsCachePage *page = usbHsFsCacheGetPage(lun_ctx, cache_ctx, cur_block_addr);
+            if (!page) return false;
+
+            u32 page_offset = (u32)(cur_block_addr - page->block_addr);
+            u32 xfer_block_count = (page->block_count - page_offset);
+            if (xfer_block_count > block_count) xfer_block_count = block_count;
+
+            memcpy(data_buf, page->data + ((u64)page_offset * block_length), (u64)xfer_block_count * block_length);
+
+            data_buf += ((u64)xfer_block_count * block_length);
+            cur_block_addr += xfer_block_count;
+            block_count -= xfer_block_count;
+        }
+
+        return true;
+    }
+
+    /* Large reads go straight to the LUN. */
+    return usbHsFsCacheReadFromLogicalUnit(lun_ctx, cache_ctx, data_buf, block_addr, block_count);
+}
+
+bool usbHsFsCacheWriteLogicalUnitBlocks(UsbHsFsDriveLogicalUnitContext *lun_ctx, const void *buf, u64 block_addr, u32 block_count)
+{
+    UsbHsFsCacheContext *cache_ctx = NULL;
+    const u8 *data_buf = (const u8*)buf;
+    bool ret = false;
+
+    /* Requests outside the LUN boundaries and writes to write-protected LUNs go straight to the LUN, which will reject them. */
+    if (!block_count || lun_ctx->write_protect || block_addr >= lun_ctx->block_count || block_count > (lun_ctx->block_count - block_addr) || \
+        !(cache_ctx = usbHsFsCacheGetContext(lun_ctx)))
+    {
+        return usbHsFsScsiWriteLogicalUnitBlocks(lun_ctx, buf, block_addr, block_count);
+    }
+
+    u32 block_length = cache_ctx->block_length;
+
+    /* Keep cached copies of these blocks in sync with the new data. */
+    for(u32 i = 0; i < USBHSFS_CACHE_PAGE_COUNT; i++)
+    {
+        UsbHsFsCachePage *page = &(cache_ctx->pages[i]);
+        if (page->block_count) usbHsFsCacheCopyOverlappingBlocks(page->data, page->block_addr, page->block_count, data_buf, block_addr, block_count, block_length);
+    }
+
+    if (cache_ctx->ra_block_count) usbHsFsCacheCopyOverlappingBlocks(cache_ctx->ra_buf, cache_ctx->ra_block_addr, cache_ctx->ra_block_count, data_buf, block_addr, block_count, block_length);
+
+    if (cache_ctx->wb_buf)
+    {
+        u64 wb_end_addr = (cache_ctx->wb_block_addr + cache_ctx->wb_block_count);
+
+        if (cache_ctx->wb_block_count)
+        {
+            /* Merge rewrites of blocks already held by the write-behind buffer (e.g. FAT sectors) in place. */
+            if (block_addr >= cache_ctx->wb_block_addr && (block_addr + block_count) <= wb_end_addr)
+            {
+                memcpy(cache_ctx->wb_buf + ((block_addr - cache_ctx->wb_block_addr) * block_length), data_buf, (u64)block_count * block_length);
+                return true;
+            }
+
+            /* Coalesce writes adjacent to the pending range. */
+            if (block_addr == wb_end_addr && block_count <= (cache_ctx->wb_max_block_count - cache_ctx->wb_block_count))
+            {
+                memcpy(cache_ctx->wb_buf + ((u64)cache_ctx->wb_block_count * block_length), data_buf, (u64)block_count * block_length);
+                cache_ctx->wb_block_count += block_count;
+                return true;
+            }
+
+            /* Flush the pending range before dealing with a non-adjacent write. */
+            if (!usbHsFsCacheFlushLogicalUnit(lun_ctx)) return false;
+        }
+
+        /* Start a new pending range if this write fits in the write-behind buffer. */
+        if (block_count < cache_ctx->wb_max_block_count)
+        {
+            memcpy(cache_ctx->wb_buf, data_buf, (u64)block_count * block_length);
+            cache_ctx->wb_block_addr = block_addr;
+            cache_ctx->wb_block_count = block_count;
+            return true;
+        }
+    }
+
+    /* Large writes go straight to the LUN. */
+    ret = usbHsFsScsiWriteLogicalUnitBlocks(lun_ctx, data_buf, block_addr, block_count);
+
+    /* Cached copies may no longer match the LUN contents if the write failed. */
+    if (!ret) usbHsFsCacheInvalidate(cache_ctx);
+
+    return ret;
+}
+
+bool usbHsFsCacheFlushLogicalUnit(UsbHsFsDriveLogicalUnitContext *lun_ctx)
+{
+    UsbHsFsCacheContext *cache_ctx = (lun_ctx ? (UsbHsFsCacheContext*)lun_ctx->cache_ctx : NULL);
+    if (!cache_ctx || !cache_ctx->wb_block_count) return true;
+
+    /* Write pending blocks. */
+    bool ret = usbHsFsScsiWriteLogicalUnitBlocks(lun_ctx, cache_ctx->wb_buf, cache_ctx->wb_block_addr, cache_ctx->wb_block_count);
+    if (!ret)
+    {
+        USBHSFS_LOG_MSG("Failed to flush 0x%X write-behind block(s) to LBA 0x%lX! (interface %d, LUN %u).", cache_ctx->wb_block_count, cache_ctx->wb_block_addr, \
+                        lun_ctx->usb_if_id, lun_ctx->lun);
+
+        /* Cached copies already hold the data we failed to write. */
+        usbHsFsCacheInvalidate(cache_ctx);
+    }
+
+    /* Drop the pending range regardless of the result. Retrying a failed write on every request would stall the whole drive. */
+    cache_ctx->wb_block_count = 0;
+
+    return ret;
+}
+
+void usbHsFsCacheDestroyLogicalUnit(UsbHsFsDriveLogicalUnitContext *lun_ctx)
+{
+    if (!lun_ctx || !lun_ctx->cache_ctx) return;
+
+    /* Flush pending data if the drive is still around. */
+    if (usbHsFsDriveIsValidLogicalUnitContext(lun_ctx)) usbHsFsCacheFlushLogicalUnit(lun_ctx);
+
+    /* Free cache context. */
+    usbHsFsCacheFreeContext((UsbHsFsCacheContext*)lun_ctx->cache_ctx);
+    lun_ctx->cache_ctx = NULL;
+}
+
+static UsbHsFsCacheContext *usbHsFsCacheGetContext(UsbHsFsDriveLogicalUnitContext *lun_ctx)
+{
+    UsbHsFsCacheContext *cache_ctx = (UsbHsFsCacheContext*)lun_ctx->cache_ctx;
+    if (cache_ctx) return cache_ctx;
+
+    u32 block_length = lun_ctx->block_length;
+    if (!block_length) return NULL;
+
+    /* Allocate memory for the cache context. */
+    cache_ctx = calloc(1, sizeof(UsbHsFsCacheContext));
+    if (!cache_ctx)
+    {
+        USBHSFS_LOG_MSG("Failed to allocate memory for the block cache context! (interface %d, LUN %u).", lun_ctx->usb_if_id, lun_ctx->lun);
+        return NULL;
+    }
+
+    cache_ctx->block_length = block_length;
+
+    /* Allocate memory for the LRU pages. Each page must hold at least a single block. */
+    cache_ctx->page_block_count = (USBHSFS_CACHE_PAGE_SIZE / block_length);
+    if (!cache_ctx->page_block_count) cache_ctx->page_block_count = 1;
+
+    u64 page_size = ((u64)cache_ctx->page_block_count * block_length);
+
+    cache_ctx->page_buf = memalign(USB_XFER_BUF_ALIGNMENT, page_size * USBHSFS_CACHE_PAGE_COUNT);
+    if (!cache_ctx->page_buf)
+    {
+        USBHSFS_LOG_MSG("Failed to allocate memory for the block cache pages! (interface %d, LUN %u).", lun_ctx->usb_if_id, lun_ctx->lun);
+        free(cache_ctx);
+        return NULL;
+    }
+
+    for(u32 i = 0; i < USBHSFS_CACHE_PAGE_COUNT; i++) cache_ctx->pages[i].data = (cache_ctx->page_buf + (i * page_size));
+
+    /* Allocate memory for the read-ahead and write-behind buffers. The cache keeps working without them if we're low on memory. */
+    cache_ctx->ra_max_block_count = (USBHSFS_CACHE_READ_AHEAD_MAX_SIZE / block_length);
+    if (cache_ctx->ra_max_block_count > cache_ctx->page_block_count)
+    {
+        cache_ctx->ra_buf = memalign(USB_XFER_BUF_ALIGNMENT, (u64)cache_ctx->ra_max_block_count * block_length);
+        if (!cache_ctx->ra_buf) USBHSFS_LOG_MSG("Failed to allocate memory for the read-ahead buffer! (interface %d, LUN %u).", lun_ctx->usb_if_id, lun_ctx->lun);
+    }
+
+    cache_ctx->ra_window = (USBHSFS_CACHE_READ_AHEAD_MIN_SIZE / block_length);
+    if (!cache_ctx->ra_window) cache_ctx->ra_window = 1;
+
+    if (!lun_ctx->write_protect)
+    {
+        cache_ctx->wb_max_block_count = (USBHSFS_CACHE_WRITE_BEHIND_SIZE / block_length);
+        if (cache_ctx->wb_max_block_count > 1)
+        {
+            cache_ctx->wb_buf = memalign(USB_XFER_BUF_ALIGNMENT, (u64)cache_ctx->wb_max_block_count * block_length);
+            if (!cache_ctx->wb_buf) USBHSFS_LOG_MSG("Failed to allocate memory for the write-behind buffer! (interface %d, LUN %u).", lun_ctx->usb_if_id, lun_ctx->lun);
+        }
+    }
+
+    /* Make sure the first read isn't mistaken for a sequential one. */
+    cache_ctx->next_read_addr = UINT64_MAX;
+
+    USBHSFS_LOG_MSG("Block cache ready: 0x%X-block pages, read-ahead %s, write-behind %s (interface %d, LUN %u).", cache_ctx->page_block_count, \
+                    cache_ctx->ra_buf ? "enabled" : "disabled", cache_ctx->wb_buf ? "enabled" : "disabled", lun_ctx->usb_if_id, lun_ctx->lun);
+
+    lun_ctx->cache_ctx = cache_ctx;
+
+    return cache_ctx;
+}
+
+static void usbHsFsCacheFreeContext(UsbHsFsCacheContext *cache_ctx)
+{
+    if (!cache_ctx) return;
+
+    if (cache_ctx->page_buf) free(cache_ctx->page_buf);
+    if (cache_ctx->ra_buf) free(cache_ctx->ra_buf);
+    if (cache_ctx->wb_buf) free(cache_ctx->wb_buf);
+
+    free(cache_ctx);
+}
+
+static void usbHsFsCacheInvalidate(UsbHsFsCacheContext *cache_ctx)
+{
+    for(u32 i = 0; i < USBHSFS_CACHE_PAGE_COUNT; i++) cache_ctx->pages[i].block_count = 0;
+    cache_ctx->ra_block_count = 0;
+}
+
+static void usbHsFsCacheCopyOverlappingBlocks(u8 *dst, u64 dst_addr, u32 dst_count, const u8 *src, u64 src_addr, u32 src_count, u32 block_length)
+{
+    /* Calculate the overlapping block range. */
+    u64 start_addr = (dst_addr > src_addr ? dst_addr : src_addr);
+    u64 dst_end_addr = (dst_addr + dst_count), src_end_addr = (src_addr + src_count);
+    u64 end_addr = (dst_end_addr < src_end_addr ? dst_end_addr : src_end_addr);
+    if (start_addr >= end_addr) return;
+
+    memcpy(dst + ((start_addr - dst_addr) * block_length), src + ((start_addr - src_addr) * block_length), (end_addr - start_addr) * block_length);
+}
+
+static bool usbHsFsCacheReadFromLogicalUnit(UsbHsFsDriveLogicalUnitContext *lun_ctx, UsbHsFsCacheContext *cache_ctx, void *buf, u64 block_addr, u32 block_count)
+{
+    /* Flush pending writes that overlap the requested range, so we don't read stale data. */
+    if (cache_ctx->wb_block_count && block_addr < (cache_ctx->wb_block_addr + cache_ctx->wb_block_count) && cache_ctx->wb_block_addr < (block_addr + block_count) && \
+        !usbHsFsCacheFlushLogicalUnit(lun_ctx)) return false;
+
+    return usbHsFsScsiReadLogicalUnitBlocks(lun_ctx, buf, block_addr, block_count);
+}
+
+static UsbHsFsCachePage *usbHsFsCacheGetPage(UsbHsFsDriveLogicalUnitContext *lun_ctx, UsbHsFsCacheContext *cache_ctx, u64 block_addr)
+{
+    UsbHsFsCachePage *victim = NULL;
+    u64 page_block_addr = (block_addr - (block_addr % cache_ctx->page_block_count));
+
+    /* Look for a page holding the requested block, keeping track of the least recently used one. */
+    for(u32 i = 0; i < USBHSFS_CACHE_PAGE_COUNT; i++)
+    {
+        UsbHsFsCachePage *page = &(cache_ctx->pages[i]);
+
+        if (page->block_count && page->block_addr == page_block_addr)
+        {
+            page->last_used = ++(cache_ctx->lru_counter);
+            return page;
+        }
+
+        if (!victim || (victim->block_count && (!page->block_count || page->last_used < victim->last_used))) victim = page;
+    }
+
+    /* Evict the least recently used page and fill it. The last page in the LUN may be shorter than the rest. */
+    u32 page_block_count = cache_ctx->page_block_count;
+    if (page_block_count > (lun_ctx->block_count - page_block_addr)) page_block_count = (u32)(lun_ctx->block_count - page_block_addr);
+
+    victim->block_count = 0;
+    if (!usbHsFsCacheReadFromLogicalUnit(lun_ctx, cache_ctx, victim->data, page_block_addr, page_block_count)) return NULL;
+
+    victim->block_addr = page_block_addr;
+    victim->block_count = page_block_count;
+    victim->last_used = ++(cache_ctx->lru_counter);
+
+    return victim;
+}
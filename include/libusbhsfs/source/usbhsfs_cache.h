@@ -0,0 +1,36 @@
+/*
+ * usbhsfs_cache.h
+ *
+ * Copyright (c) 2020-2023, DarkMatterCore <pabloacurielz@gmail.com>.
+ *
+ * This file is part of libusbhsfs (https://github.com/DarkMatterCore/libusbhsfs).
+ */
+
+#pragma once
+
+#ifndef __USBHSFS_CACHE_H__
+#define __USBHSFS_CACHE_H__
+
+#include "usbhsfs_drive.h"
+
+/// Per-LUN block cache placed between the filesystem libraries and the SCSI block I/O functions.
+/// Small reads (FAT/MFT/inode metadata) are served from an LRU of block pages, sequential streams of small reads trigger read-ahead,
+/// and adjacent writes are coalesced into a write-behind buffer that gets flushed on non-adjacent writes, overlapping reads, syncs and unmounts.
+
+/// None of these functions are thread safe - make sure to (un)lock mutexes elsewhere.
+
+/// Reads logical blocks from a LUN using the provided LUN context, going through its block cache. Suitable for filesystem libraries.
+/// The cache is allocated on first use. If allocation fails, this function falls back to usbHsFsScsiReadLogicalUnitBlocks().
+bool usbHsFsCacheReadLogicalUnitBlocks(UsbHsFsDriveLogicalUnitContext *lun_ctx, void *buf, u64 block_addr, u32 block_count);
+
+/// Writes logical blocks to a LUN using the provided LUN context, going through its block cache. Suitable for filesystem libraries.
+/// Data may be held in the write-behind buffer until the next flush. Write errors for buffered data are reported by the call that flushes it.
+bool usbHsFsCacheWriteLogicalUnitBlocks(UsbHsFsDriveLogicalUnitContext *lun_ctx, const void *buf, u64 block_addr, u32 block_count);
+
+/// Writes any pending write-behind data from the provided LUN context to the LUN.
+bool usbHsFsCacheFlushLogicalUnit(UsbHsFsDriveLogicalUnitContext *lun_ctx);
+
+/// Flushes pending write-behind data (if the drive is still available) and frees the block cache from the provided LUN context.
+void usbHsFsCacheDestroyLogicalUnit(UsbHsFsDriveLogicalUnitContext *lun_ctx);
+
+#endif  /* __USBHSFS_CACHE_H__ */
@@ -11,6 +11,7 @@
 #include "usbhsfs_request.h"
 #include "usbhsfs_scsi.h"
 #include "usbhsfs_mount.h"
+#include "usbhsfs_cache.h"
 
 /* Function prototypes. */
 
@@ -185,6 +186,7 @@ void usbHsFsDriveDestroyContext(UsbHsFsDriveContext *drive_ctx, bool stop_lun)
             if (!lun_ctx) continue;
 
             usbHsFsDriveDestroyLogicalUnitContext(lun_ctx, stop_lun);
+            usbHsFsCacheDestroyLogicalUnit(lun_ctx);
             free(lun_ctx);
         }
 
@@ -687,6 +689,9 @@ static void usbHsFsDriveDestroyLogicalUnitContext(UsbHsFsDriveLogicalUnitContext
         lun_ctx->fs_ctx = NULL;
     }
 
+    /* Flush pending writes and free the block cache. */
+    usbHsFsCacheDestroyLogicalUnit(lun_ctx);
+
     /* Stop current LUN. */
     if (stop_lun) usbHsFsScsiStopDriveLogicalUnit(lun_ctx);
 }
@@ -68,6 +68,7 @@ typedef struct {
     u64 capacity;                                       ///< LUN capacity (block count times block length).
     u32 fs_count;                                       ///< Number of mounted filesystems stored in this LUN.
     UsbHsFsDriveLogicalUnitFileSystemContext **fs_ctx;  ///< Dynamically allocated pointer array of fs_count filesystem contexts.
+    void *cache_ctx;                                    ///< Pointer to the dynamically allocated block cache context for this LUN. Managed by usbhsfs_cache.c.
 } UsbHsFsDriveLogicalUnitContext;
 
 /// Used to handle drives.
@@ -26,4 +26,7 @@ namespace netInstStuff {
     void sendExitCommands(std::string url);
     void installTitleNet(std::vector<std::string> ourUrlList, int ourStorage, std::vector<std::string> urlListAltNames, std::string ourSource);
     std::vector<std::string> OnSelected();
+    // Push sessions: OnSelected() returns {"pushSession", <file count>} when the sender
+    // opened with the push hello instead of a URL list. A storage of -1 declines it.
+    void installTitlePush(int ourStorage);
 }
\ No newline at end of file
@@ -53,10 +53,14 @@ public:
 	bool close();
 	u64 write(const  u8* ptr, u64 sz);
 	void flushHeader();
+	// Continues a plain NCA whose first offset bytes are already in the placeholder
+	void resume(u64 offset);
+	bool isCompressed() const;
 
 protected:
 	NcmContentId m_ncaId;
 	std::shared_ptr<nx::ncm::ContentStorage> m_contentStorage;
 	std::vector<u8> m_buffer;
 	std::shared_ptr<NcaBodyWriter> m_writer;
+	bool m_compressed = false;
 };
@@ -49,6 +49,7 @@ namespace nx::ncm
 
             void CreatePlaceholder(const NcmContentId &placeholderId, const NcmPlaceHolderId &registeredId, size_t size);
             void DeletePlaceholder(const NcmPlaceHolderId &placeholderId);
+            bool HasPlaceholder(const NcmPlaceHolderId &placeholderId);
             void WritePlaceholder(const NcmPlaceHolderId &placeholderId, u64 offset, void *buffer, size_t bufSize);
             void Register(const NcmPlaceHolderId &placeholderId, const NcmContentId &registeredId);
             void Delete(const NcmContentId &registeredId);
@@ -40,6 +40,9 @@ namespace inst::ui {
             std::vector<std::filesystem::path> ourFiles;
             std::vector<std::filesystem::path> selectedTitles;
             std::filesystem::path currentDir;
+            std::filesystem::path listingDir;
+            std::uint64_t listingRevision = 0;
+            bool listingFailed = false;
             std::filesystem::path rootDir;
             BottomHintTouchState bottomHintTouch;
             std::vector<BottomHintSegment> bottomHintSegments;
@@ -54,6 +57,9 @@ namespace inst::ui {
             bool hasLastTap = false;
             int lastTapIndex = -1;
             std::chrono::steady_clock::time_point lastTapTime{};
+            bool pullDirectoryListing();
+            void pollDirectoryListing();
+            void populateMenu();
             void followDirectory();
             void selectNsp(int selectedIndex);
     };
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Install progress model shared between transfer threads and the install page.
+// Producers only publish counters (relaxed atomics, no locks, no formatting); the UI thread
+// samples them at a fixed frame rate, derives speed/ETA itself and redraws the page once per frame.
+namespace inst::ui::progress {
+    enum class Stage : std::uint32_t {
+        Idle = 0,
+        Downloading,
+        Installing,
+    };
+
+    void Begin(Stage stage, const std::string& itemName, std::uint64_t totalBytes);
+    void SetTotal(std::uint64_t totalBytes);
+    void SetBytes(std::uint64_t bytes);
+    void AddBytes(std::uint64_t bytes);
+
+    // Redraws the install page from the model if a frame is due (or force is set). Returns true if it rendered.
+    bool Render(bool force = false);
+    // Sleeps until the next frame is due, then renders it. Meant for UI-thread loops that only wait on workers.
+    void Pump();
+    // Marks the current stage complete and renders the final state.
+    void Finish();
+}
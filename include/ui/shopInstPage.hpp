@@ -68,6 +68,7 @@ namespace inst::ui {
             std::vector<inst::save_sync::SaveSyncRemoteVersion> saveVersionSelectorVersions;
             int gridSelectedIndex = 0;
             int gridPage = -1;
+            std::uint64_t gridCacheGeneration = 0;
             bool shopGridMode = false;
             int shopGridIndex = 0;
             int shopGridPage = -1;
@@ -168,6 +169,7 @@ namespace inst::ui {
             void refreshSaveVersionSelectorDetailText();
             bool handleSaveVersionSelectorInput(u64 Down, u64 Up, u64 Held, pu::ui::Touch Pos);
             void handleSaveSyncAction(int selectedIndex);
+            void handleSaveSyncBulkAction();
             void showCurrentDescriptionDialog();
             bool tryGetCurrentDescription(std::string& outTitle, std::string& outDescription) const;
             void openDescriptionOverlay();
@@ -19,6 +19,9 @@ namespace inst::config {
     extern std::string shopPass;
     extern std::vector<std::string> updateInfo;
     extern int languageSetting;
+    extern int httpRetryCount;
+    extern int mtpTransferDepth;
+    extern int mtpTransferBufferMb;
     extern bool ignoreReqVers;
     extern bool validateNCAs;
     extern bool overClock;
@@ -33,6 +36,10 @@ namespace inst::config {
     extern bool shopHideInstalledSection;
     extern bool shopStartGridMode;
     extern bool offlineDbAutoCheckOnStartup;
+    extern bool httpStreamedNsp;
+    extern bool saveSyncStreamUpload;
+    extern bool saveSyncDelta;
+    extern bool saveSyncStreamRestore;
 
     struct ShopProfile {
         std::string fileName;
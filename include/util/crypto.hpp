@@ -26,23 +26,12 @@ namespace Crypto
         0x04, 0x40, 0x1A, 0x9E, 0x9A, 0x67, 0xF6, 0x72, 0x29, 0xFA, 0x04, 0xF0, 0x9D, 0xE4, 0xF4, 0x03    
     };
 
-    class Keys
-    {
-    public:
-        Keys()
-        {
-            u8 kek[0x10] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    // The NCA header key is derived through spl once per install session and shared by every
+    // NCA through HeaderCipher(). Thread-safe; ClearKeys() zeroises it and the cached cipher contexts.
+    void ClearKeys();
 
-            splCryptoGenerateAesKek(headerKekSource, 0, 0, kek);
-            splCryptoGenerateAesKey(kek, headerKeySource, headerKey);
-            splCryptoGenerateAesKey(kek, headerKeySource + 0x10, headerKey + 0x10);
-        }
-
-        u8 headerKekSource[0x10] = { 0x1F, 0x12, 0x91, 0x3A, 0x4A, 0xCB, 0xF0, 0x0D, 0x4C, 0xDE, 0x3A, 0xF6, 0xD5, 0x23, 0x88, 0x2A };
-        u8 headerKeySource[0x20] = { 0x5A, 0x3E, 0xD8, 0x4F, 0xDE, 0xC0, 0xD8, 0x26, 0x31, 0xF7, 0xE2, 0x5D, 0x19, 0x7B, 0xF5, 0xD0, 0x1C, 0x9B, 0x7B, 0xFA, 0xF6, 0x28, 0x18, 0x3D, 0x71, 0xF6, 0x4D, 0x73, 0xF1, 0x50, 0xB9, 0xD2 };
-
-        u8 headerKey[0x20] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
-    };
+    // Fills ctx for key, reusing the expanded schedule of recently used keys
+    void CreateCtrContext(Aes128CtrContext* ctx, const u8* key, const void* iv);
 
     void calculateMGF1andXOR(unsigned char* data, size_t data_size, const void* source, size_t source_size);
     bool rsa2048PssVerify(const void *data, size_t len, const unsigned char *signature, const unsigned char *modulus);
@@ -84,7 +73,7 @@ namespace Crypto
         Aes128Ctr(const u8* key, const AesCtr& iv)
         {
             counter = iv;
-            aes128CtrContextCreate(&ctx, key, &iv);
+            CreateCtrContext(&ctx, key, &iv);
             seek(0);
         }
 
@@ -121,6 +110,10 @@ namespace Crypto
             aes128XtsContextCreate(&ctx, key, key + 0x10, is_encryptor);
         }
 
+        explicit AesXtr(const Aes128XtsContext& context) : ctx(context)
+        {
+        }
+
         virtual ~AesXtr()
         {
         }
@@ -151,4 +144,8 @@ namespace Crypto
     protected:
         Aes128XtsContext ctx;
     };
+
+    // Header cipher built from the cached key and context; no spl round trip after the first NCA.
+    // Throws if spl can't derive the key, rather than decrypting with a zeroed one.
+    AesXtr HeaderCipher(bool is_encryptor);
 }
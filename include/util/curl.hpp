@@ -2,11 +2,23 @@
 #include <string>
 #include <cstdint>
 #include <functional>
+#include <cstddef>
 
 namespace inst::curl {
     using DownloadProgressCallback = std::function<void(std::uint64_t downloaded, std::uint64_t total)>;
+    // Receives the response body as it arrives. Returning false aborts the transfer.
+    using DownloadChunkCallback = std::function<bool(const void* data, std::size_t size)>;
+
+    // SHA-256 and length of a response body, computed while it was received.
+    struct DownloadDigest {
+        std::uint8_t sha256[0x20] = {};
+        std::uint64_t size = 0;
+    };
+
     bool downloadFile(const std::string ourUrl, const char *pagefilename, long timeout = 5000, bool writeProgress = false);
     bool downloadFileWithProgress(const std::string ourUrl, const char *pagefilename, long timeout, const DownloadProgressCallback& progressCb);
+    bool downloadFileWithDigest(const std::string ourUrl, const char *pagefilename, long timeout, const DownloadProgressCallback& progressCb, DownloadDigest& outDigest);
+    bool downloadToSink(const std::string ourUrl, long timeout, const DownloadChunkCallback& sink, const DownloadProgressCallback& progressCb = nullptr, DownloadDigest* outDigest = nullptr);
     bool downloadFileWithAuth(const std::string ourUrl, const char *pagefilename, const std::string& user, const std::string& pass, long timeout = 5000);
     bool downloadImageWithAuth(const std::string ourUrl, const char *pagefilename, const std::string& user, const std::string& pass, long timeout = 5000);
     std::string downloadToBuffer (const std::string ourUrl, int firstRange = -1, int secondRange = -1, long timeout = 5000);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Background directory listing for the SD card and USB HDD browsers.
+// A single worker thread lists the most recently opened directory, filtering and case-insensitively
+// sorting entries as they arrive, and streams partial results to the UI. Finished listings are kept
+// per path and served immediately on the next visit, then revalidated against the directory mtime.
+namespace inst::util::dirscan
+{
+    struct Listing {
+        std::filesystem::path dir;
+        std::vector<std::filesystem::path> dirs;
+        std::vector<std::filesystem::path> files;
+        bool complete = false;
+        bool failed = false;
+        std::uint64_t revision = 0;
+    };
+
+    // Makes dir the directory being listed. Extensions are lowercase and include the dot (".nsp").
+    void Open(const std::filesystem::path& dir, const std::vector<std::string>& extensions);
+    // Copies the listing of dir into out if its revision is newer than knownRevision.
+    bool Poll(const std::filesystem::path& dir, std::uint64_t knownRevision, Listing& out);
+    // Drops the cached listing for dir (e.g. after deleting files from it).
+    void Invalidate(const std::filesystem::path& dir);
+    void Shutdown();
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace inst::titlecache
+{
+    struct CachedTitle {
+        std::uint64_t applicationId = 0;
+        std::uint64_t recordStamp = 0;
+        std::uint32_t version = 0;
+        std::string name;
+        std::vector<std::uint8_t> iconThumbnail;
+    };
+
+    // Reads the on-SD cache in one sequential read. Cheap to call again once loaded.
+    void Load();
+    // Starts (or queues) a background pass that re-reads control data only for titles whose record stamp changed.
+    void RequestRefresh();
+    // Waits for a running refresh and stops the worker.
+    void Shutdown();
+    // Bumped whenever a refresh changed entries, so views can drop what they built from older data.
+    std::uint64_t GetGeneration();
+
+    bool TryGet(std::uint64_t baseTitleId, CachedTitle& outTitle);
+    bool TryGetName(std::uint64_t baseTitleId, std::string& outName);
+    bool TryGetIcon(std::uint64_t baseTitleId, std::vector<std::uint8_t>& outIcon);
+}
@@ -1,14 +1,50 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace Language {
+    using KeyId = std::uint64_t;
+
+    // FNV-1a over the dotted key path ("inst.info_page.downloading"). Load() flattens the language
+    // file into a table indexed by these ids, so lookups never touch the JSON tree.
+    constexpr KeyId HashKey(std::string_view key) {
+        KeyId hash = 14695981039346656037ULL;
+        for (const char c : key) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    // Carries a string literal key and its id into the _lang operator template, which makes the
+    // hash a compile-time constant at every call site.
+    template <std::size_t N>
+    struct KeyLiteral {
+        char text[N] = {};
+        KeyId id = 0;
+
+        consteval KeyLiteral(const char (&str)[N]) {
+            for (std::size_t i = 0; i < N; i++)
+                text[i] = str[i];
+            id = HashKey(std::string_view(text, N - 1));
+        }
+
+        constexpr std::string_view View() const {
+            return std::string_view(text, N - 1);
+        }
+    };
+
     void Load();
+    const std::string& Entry(KeyId id, std::string_view key);
     std::string LanguageEntry(std::string key);
     std::string GetRandomMsg();
     std::string GetShopHeaderLanguage();
 }
 
-inline std::string operator ""_lang (const char* key, size_t size) {
-    return Language::LanguageEntry(std::string(key, size));
+template <Language::KeyLiteral Key>
+inline const std::string& operator ""_lang () {
+    return Language::Entry(Key.id, Key.View());
 }
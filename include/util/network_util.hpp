@@ -70,12 +70,20 @@ namespace tin::network
             bool m_rangesSupported = false;
 
             static size_t ParseHTMLData(char* bytes, size_t size, size_t numItems, void* userData);
+            static size_t ParseContentRangeTotal(char* bytes, size_t size, size_t numItems, void* userData);
 
         public:
             HTTPDownload(std::string url);
     
+            bool IsRangeSupported() const { return m_rangesSupported; }
+            std::string GetUrl() const { return m_url; }
+            // Response header from the initial request, empty if not present
+            std::string GetHeaderValue(std::string key);
+
             void BufferDataRange(void* buffer, size_t offset, size_t size, std::function<void (size_t sizeRead)> progressFunc);
             int StreamDataRange(size_t offset, size_t size, std::function<size_t (u8* bytes, size_t size)> streamFunc);
+            // Downloads the whole file in a single GET without a Range header
+            int StreamDataSequential(std::function<size_t (u8* bytes, size_t size)> streamFunc);
     };
 
     void SetBasicAuth(const std::string& user, const std::string& pass);
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -26,9 +28,27 @@ namespace inst::save_sync {
         std::vector<SaveSyncRemoteVersion> remoteVersions;
     };
 
+    struct SaveSyncBatchResult {
+        std::uint64_t titleId = 0;
+        std::string titleName;
+        bool ok = false;
+        std::string error;
+    };
+
+    // Reported on the calling thread as a batch advances: the title concerned, what just
+    // happened to it, and how many titles of the batch are finished.
+    using SaveSyncBatchProgress = std::function<void(const SaveSyncEntry& entry, const std::string& status, std::size_t finished, std::size_t total)>;
+
     bool FetchRemoteSaveItems(const std::string& shopUrl, const std::string& user, const std::string& pass, std::vector<shopInstStuff::ShopItem>& outItems, std::string& warning);
     bool BuildEntries(const std::vector<shopInstStuff::ShopItem>& remoteItems, std::vector<SaveSyncEntry>& outEntries, std::string& warning);
     bool UploadSaveToServer(const std::string& shopUrl, const std::string& user, const std::string& pass, const SaveSyncEntry& entry, const std::string& note, std::string& error);
     bool DownloadSaveToConsole(const std::string& shopUrl, const std::string& user, const std::string& pass, const SaveSyncEntry& entry, const SaveSyncRemoteVersion* remoteVersion, std::string& error);
     bool DeleteSaveFromServer(const std::string& shopUrl, const std::string& user, const std::string& pass, const SaveSyncEntry& entry, const SaveSyncRemoteVersion* remoteVersion, std::string& error);
+
+    // Uploads every local save. Archives are built one at a time on the calling thread while
+    // the uploads run concurrently over a shared connection pool.
+    bool BackupAllSaves(const std::string& shopUrl, const std::string& user, const std::string& pass, const std::vector<SaveSyncEntry>& entries, const std::string& note, const SaveSyncBatchProgress& progress, std::vector<SaveSyncBatchResult>& results, std::string& error);
+    // Restores every title whose newest server backup is newer than its local save. Downloads
+    // run concurrently; extraction into the save mount stays on the calling thread.
+    bool RestoreNewerSaves(const std::string& shopUrl, const std::string& user, const std::string& pass, const std::vector<SaveSyncEntry>& entries, const SaveSyncBatchProgress& progress, std::vector<SaveSyncBatchResult>& results, std::string& error);
 }
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace inst::status
+{
+    struct Snapshot {
+        std::uint64_t generation = 0;
+        std::string timeText = "--:--";
+        bool internetUp = false;
+        bool wifiConnected = false;
+        std::uint32_t wifiStrength = 0;
+        int batteryPct = -1;
+        std::int64_t systemTotal = 0;
+        std::int64_t systemFree = 0;
+        std::int64_t sdTotal = 0;
+        std::int64_t sdFree = 0;
+    };
+
+    // Opens the time/nifm/psm/ncm sessions once and starts the background sampler thread.
+    void Start();
+    void Stop();
+    // Copies the latest published snapshot. Never waits on IPC; generation 0 means nothing was sampled yet.
+    Snapshot GetSnapshot();
+    // Returns the generation of the latest snapshot, so callers can skip redundant UI updates.
+    std::uint64_t GetGeneration();
+    // Queues a free space refresh (e.g. after an install finished or titles were deleted).
+    void RequestStorageRefresh();
+}
@@ -1,3 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
 namespace inst::zip {
     bool extractFile(const std::string filename, const std::string destination);
-}
\ No newline at end of file
+
+    // Extracts a zip archive from a forward-only byte stream, e.g. straight from a download,
+    // using the local file headers. Stored and deflated entries are supported; anything that
+    // needs the central directory (encryption, zip64, stored entries with data descriptors)
+    // sets IsUnsupported() so the caller can fall back to extractFile().
+    class StreamExtractor {
+        public:
+            explicit StreamExtractor(const std::string& destination);
+            ~StreamExtractor();
+
+            StreamExtractor(const StreamExtractor&) = delete;
+            StreamExtractor& operator=(const StreamExtractor&) = delete;
+
+            bool Feed(const void* data, std::size_t size);
+            // True once the central directory was reached and every entry passed its CRC check
+            bool Finish();
+            bool IsUnsupported() const { return m_unsupported; }
+
+        private:
+            enum class State { Header, Data, Descriptor, Done, Failed };
+
+            bool BeginEntry();
+            bool EndEntry(std::uint32_t crc);
+            bool WriteOut(const std::uint8_t* data, std::size_t size);
+            bool Fail(bool unsupported = false);
+
+            std::string m_destination;
+            State m_state = State::Header;
+            std::vector<std::uint8_t> m_pending;
+            bool m_unsupported = false;
+            std::uint32_t m_entries = 0;
+
+            std::uint16_t m_flags = 0;
+            std::uint16_t m_method = 0;
+            std::uint32_t m_expectedCrc = 0;
+            std::uint64_t m_remaining = 0;
+            std::uint32_t m_crc = 0;
+            FILE* m_out = nullptr;
+            z_stream m_zstream{};
+            bool m_zstreamInit = false;
+            std::vector<std::uint8_t> m_inflateBuf;
+    };
+}
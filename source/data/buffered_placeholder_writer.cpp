@@ -33,9 +33,15 @@ namespace tin::data
 {
     int NUM_BUFFER_SEGMENTS;
 
-    BufferedPlaceholderWriter::BufferedPlaceholderWriter(std::shared_ptr<nx::ncm::ContentStorage>& contentStorage, NcmContentId ncaId, size_t totalDataSize) :
-        m_totalDataSize(totalDataSize), m_contentStorage(contentStorage), m_ncaId(ncaId), m_writer(ncaId, contentStorage)
+    BufferedPlaceholderWriter::BufferedPlaceholderWriter(std::shared_ptr<nx::ncm::ContentStorage>& contentStorage, NcmContentId ncaId, size_t totalDataSize, size_t resumeOffset) :
+        m_totalDataSize(totalDataSize), m_sizeBuffered(resumeOffset), m_sizeWrittenToPlaceholder(resumeOffset), m_contentStorage(contentStorage), m_ncaId(ncaId), m_writer(ncaId, contentStorage)
     {
+        if (resumeOffset > totalDataSize)
+            THROW_FORMAT("Resume offset exceeds the total data size!\n");
+
+        if (resumeOffset > 0)
+            m_writer.resume(resumeOffset);
+
         // Though currently the number of segments is fixed, we want them allocated on the heap, not the stack
         m_bufferSegments = std::make_unique<BufferSegment[]>(NUM_BUFFER_SEGMENTS);
 
@@ -199,6 +205,12 @@ namespace tin::data
         return m_sizeWrittenToPlaceholder;
     }
 
+    bool BufferedPlaceholderWriter::IsResumable()
+    {
+        // NCZ bodies carry decompressor state that can't be restored
+        return m_sizeWrittenToPlaceholder >= NCA_HEADER_SIZE && !m_writer.isCompressed();
+    }
+
     void BufferedPlaceholderWriter::DebugPrintBuffers()
     {
         LOG_DEBUG("BufferedPlaceholderWriter Buffers: \n");
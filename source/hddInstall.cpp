@@ -28,6 +28,7 @@ SOFTWARE.
 #include <memory>
 #include "hddInstall.hpp"
 #include "install/install_nsp.hpp"
+#include "install/install_queue.hpp"
 #include "install/install_xci.hpp"
 #include "install/sdmc_xci.hpp"
 #include "install/sdmc_nsp.hpp"
@@ -37,6 +38,7 @@ SOFTWARE.
 #include "util/error.hpp"
 #include "util/config.hpp"
 #include "util/util.hpp"
+#include "util/dir_scanner.hpp"
 #include "util/lang.hpp"
 #include "ui/MainApplication.hpp"
 #include "ui/instPage.hpp"
@@ -56,7 +58,6 @@ namespace hddInstStuff {
         NcmStorageId m_destStorageId = NcmStorageId_SdCard;
 
         if (whereToInstall) m_destStorageId = NcmStorageId_BuiltInUser;
-        unsigned int titleItr;
 
         std::vector<int> previousClockValues;
         if (inst::config::overClock) {
@@ -65,44 +66,49 @@ namespace hddInstStuff {
             previousClockValues.push_back(inst::util::setClockSpeed(2, 1600000000)[0]);
         }
 
-        try
-        {
-            for (titleItr = 0; titleItr < ourTitleList.size(); titleItr++) {
-                inst::ui::instPage::setTopInstInfoText("inst.info_page.top_info0"_lang + inst::util::shortenString(ourTitleList[titleItr].filename().string(), 40, true) + "inst.hdd.source_string"_lang);
-                std::unique_ptr<tin::install::Install> installTask;
-
-                if (ourTitleList[titleItr].extension() == ".xci" || ourTitleList[titleItr].extension() == ".xcz") {
-                    auto sdmcXCI = std::make_shared<tin::install::xci::SDMCXCI>(ourTitleList[titleItr]);
-                    installTask = std::make_unique<tin::install::xci::XCIInstallTask>(m_destStorageId, inst::config::ignoreReqVers, sdmcXCI);
-                } else {
-                    auto sdmcNSP = std::make_shared<tin::install::nsp::SDMCNSP>(ourTitleList[titleItr]);
-                    installTask = std::make_unique<tin::install::nsp::NSPInstall>(m_destStorageId, inst::config::ignoreReqVers, sdmcNSP);
+        std::vector<tin::install::InstallQueueItem> queueItems;
+        for (const auto& titlePath : ourTitleList) {
+            tin::install::InstallQueueItem item;
+            item.name = titlePath.filename().string();
+            item.createTask = [titlePath, m_destStorageId]() -> std::unique_ptr<tin::install::Install> {
+                if (titlePath.extension() == ".xci" || titlePath.extension() == ".xcz") {
+                    auto sdmcXCI = std::make_shared<tin::install::xci::SDMCXCI>(titlePath);
+                    return std::make_unique<tin::install::xci::XCIInstallTask>(m_destStorageId, inst::config::ignoreReqVers, sdmcXCI);
                 }
-
-                LOG_DEBUG("%s\n", "Preparing installation");
-                inst::ui::instPage::setInstInfoText("inst.info_page.preparing"_lang);
-                inst::ui::instPage::setInstBarPerc(0);
-                installTask->Prepare();
-                installTask->Begin();
-
-                const u64 titleId = installTask->GetTitleId(0);
-                const NcmContentMetaType metaType = installTask->GetContentMetaType(0);
-                const u64 baseTitleId = tin::util::GetBaseTitleId(titleId, metaType);
-                inst::ui::instPage::setInstallIconFromTitleId(baseTitleId);
-            }
+                auto sdmcNSP = std::make_shared<tin::install::nsp::SDMCNSP>(titlePath);
+                return std::make_unique<tin::install::nsp::NSPInstall>(m_destStorageId, inst::config::ignoreReqVers, sdmcNSP);
+            };
+            queueItems.push_back(std::move(item));
         }
-        catch (std::exception& e)
+
+        tin::install::InstallQueueOptions queueOptions;
+        queueOptions.onTitleStart = [&](size_t index) {
+            inst::ui::instPage::setTopInstInfoText("inst.info_page.top_info0"_lang + inst::util::shortenString(ourTitleList[index].filename().string(), 40, true) + "inst.hdd.source_string"_lang);
+            inst::ui::instPage::setInstInfoText("inst.info_page.preparing"_lang);
+            inst::ui::instPage::setInstBarPerc(0);
+        };
+        queueOptions.onTaskPrepared = [](size_t, tin::install::Install& installTask) {
+            const u64 titleId = installTask.GetTitleId(0);
+            const NcmContentMetaType metaType = installTask.GetContentMetaType(0);
+            const u64 baseTitleId = tin::util::GetBaseTitleId(titleId, metaType);
+            inst::ui::instPage::setInstallIconFromTitleId(baseTitleId);
+        };
+
+        std::vector<tin::install::InstallQueueFailure> failures = tin::install::RunInstallQueue(queueItems, queueOptions);
+        if (!failures.empty())
         {
-            LOG_DEBUG("Failed to install");
-            LOG_DEBUG("%s", e.what());
-            fprintf(stdout, "%s", e.what());
-            inst::ui::instPage::setInstInfoText("inst.info_page.failed"_lang + inst::util::shortenString(ourTitleList[titleItr].filename().string(), 42, true));
+            const auto& failure = failures.front();
+            fprintf(stdout, "%s", failure.error.c_str());
+            inst::ui::instPage::setInstInfoText("inst.info_page.failed"_lang + inst::util::shortenString(failure.name, 42, true));
             inst::ui::instPage::setInstBarPerc(0);
             std::string audioPath = "romfs:/audio/bark.wav";
             if (!inst::config::soundEnabled) audioPath = "";
             if (std::filesystem::exists(inst::config::appDir + "/bark.wav")) audioPath = inst::config::appDir + "/bark.wav";
             std::thread audioThread(inst::util::playAudio, audioPath);
-            inst::ui::mainApp->CreateShowDialog("inst.info_page.failed"_lang + inst::util::shortenString(ourTitleList[titleItr].filename().string(), 42, true) + "!", "inst.info_page.failed_desc"_lang + "\n\n" + (std::string)e.what(), {"common.ok"_lang}, true);
+            std::string failureDesc = "inst.info_page.failed_desc"_lang + "\n\n" + failure.error;
+            for (size_t i = 1; i < failures.size(); i++)
+                failureDesc += "\n" + inst::util::shortenString(failures[i].name, 42, true);
+            inst::ui::mainApp->CreateShowDialog("inst.info_page.failed"_lang + inst::util::shortenString(failure.name, 42, true) + "!", failureDesc, {"common.ok"_lang}, true);
             audioThread.join();
             nspInstalled = false;
         }
@@ -127,6 +133,7 @@ namespace hddInstStuff {
                             if (std::filesystem::exists(ourTitleList[i])) {
                                 try {
                                     std::filesystem::remove(ourTitleList[i]);
+                                    inst::util::dirscan::Invalidate(ourTitleList[i].parent_path());
                                 } catch (...) { };
                             }
                         }
@@ -139,6 +146,7 @@ namespace hddInstStuff {
                         if (std::filesystem::exists(ourTitleList[0])) {
                             try {
                                 std::filesystem::remove(ourTitleList[0]);
+                                inst::util::dirscan::Invalidate(ourTitleList[0].parent_path());
                             } catch (...) { };
                         }
                     }
@@ -22,61 +22,42 @@ SOFTWARE.
 
 #include "install/http_nsp.hpp"
 
-#include <cstdio>
 #include <switch.h>
 #include <threads.h>
 #include "data/buffered_placeholder_writer.hpp"
+#include "install/install_journal.hpp"
 #include "util/title_util.hpp"
 #include "util/error.hpp"
 #include "util/debug.h"
 #include "util/util.hpp"
 #include "util/lang.hpp"
-#include "ui/instPage.hpp"
+#include "ui/installProgress.hpp"
 
 namespace tin::install::nsp
 {
-    namespace {
-        std::string FormatOneDecimal(double value)
-        {
-            char buf[32];
-            std::snprintf(buf, sizeof(buf), "%.1f", value);
-            return std::string(buf);
-        }
-
-        std::string FormatEta(std::uint64_t totalSeconds)
-        {
-            const std::uint64_t h = totalSeconds / 3600;
-            const std::uint64_t m = (totalSeconds % 3600) / 60;
-            const std::uint64_t s = totalSeconds % 60;
-            char buf[32];
-            if (h > 0) {
-                std::snprintf(buf, sizeof(buf), "%llu:%02llu:%02llu",
-                    static_cast<unsigned long long>(h),
-                    static_cast<unsigned long long>(m),
-                    static_cast<unsigned long long>(s));
-            } else {
-                std::snprintf(buf, sizeof(buf), "%llu:%02llu",
-                    static_cast<unsigned long long>(m),
-                    static_cast<unsigned long long>(s));
-            }
-            return std::string(buf);
-        }
-    }
-
     bool stopThreadsHttpNsp;
 
     HTTPNSP::HTTPNSP(std::string url) :
-        m_download(url)
+        HTTPNSP(tin::network::HTTPDownload(url))
     {
 
     }
 
+    HTTPNSP::HTTPNSP(tin::network::HTTPDownload download) :
+        m_download(std::move(download))
+    {
+        m_sourceId = tin::install::journal::MakeSourceId(m_download.GetUrl(), m_download.GetHeaderValue("content-length"), m_download.GetHeaderValue("etag"));
+    }
+
     struct StreamFuncArgs
     {
         tin::network::HTTPDownload* download;
         tin::data::BufferedPlaceholderWriter* bufferedPlaceholderWriter;
         u64 pfs0Offset;
         u64 ncaSize;
+        u64 resumeOffset;
+        const std::string* sourceId;
+        NcmContentId ncaId;
     };
 
     int CurlStreamFunc(void* in)
@@ -95,7 +76,7 @@ namespace tin::install::nsp
             return streamBufSize;
         };
 
-        if (args->download->StreamDataRange(args->pfs0Offset, args->ncaSize, streamFunc) == 1) stopThreadsHttpNsp = true;
+        if (args->download->StreamDataRange(args->pfs0Offset + args->resumeOffset, args->ncaSize - args->resumeOffset, streamFunc) == 1) stopThreadsHttpNsp = true;
         return 0;
     }
 
@@ -103,10 +84,21 @@ namespace tin::install::nsp
     {
         StreamFuncArgs* args = reinterpret_cast<StreamFuncArgs*>(in);
 
+        u64 lastCheckpoint = args->resumeOffset;
+
         while (!args->bufferedPlaceholderWriter->IsPlaceholderComplete() && !stopThreadsHttpNsp)
         {
             if (args->bufferedPlaceholderWriter->CanWriteSegmentToPlaceholder())
+            {
                 args->bufferedPlaceholderWriter->WriteSegmentToPlaceholder();
+
+                u64 written = args->bufferedPlaceholderWriter->GetSizeWrittenToPlaceholder();
+                if (written - lastCheckpoint >= tin::install::journal::CHECKPOINT_INTERVAL && args->bufferedPlaceholderWriter->IsResumable())
+                {
+                    tin::install::journal::SaveCheckpoint(*args->sourceId, args->ncaId, written);
+                    lastCheckpoint = written;
+                }
+            }
         }
 
         return 0;
@@ -120,12 +112,24 @@ namespace tin::install::nsp
         LOG_DEBUG("Retrieving %s\n", ncaFileName.c_str());
         size_t ncaSize = fileEntry->fileSize;
 
-        tin::data::BufferedPlaceholderWriter bufferedPlaceholderWriter(contentStorage, placeholderId, ncaSize);
+        u64 resumeOffset = this->GetResumeOffset(contentStorage, placeholderId);
+        if (resumeOffset >= ncaSize)
+        {
+            LOG_DEBUG("%s was already fully written by a previous attempt\n", ncaFileName.c_str());
+            return;
+        }
+        if (resumeOffset > 0)
+            LOG_DEBUG("Resuming %s at 0x%lx\n", ncaFileName.c_str(), resumeOffset);
+
+        tin::data::BufferedPlaceholderWriter bufferedPlaceholderWriter(contentStorage, placeholderId, ncaSize, resumeOffset);
         StreamFuncArgs args;
         args.download = &m_download;
         args.bufferedPlaceholderWriter = &bufferedPlaceholderWriter;
         args.pfs0Offset = this->GetDataOffset() + fileEntry->dataOffset;
         args.ncaSize = ncaSize;
+        args.resumeOffset = resumeOffset;
+        args.sourceId = &m_sourceId;
+        args.ncaId = placeholderId;
         thrd_t curlThread;
         thrd_t writeThread;
 
@@ -133,68 +137,51 @@ namespace tin::install::nsp
         thrd_create(&curlThread, CurlStreamFunc, &args);
         thrd_create(&writeThread, PlaceholderWriteFunc, &args);
 
-        u64 freq = armGetSystemTickFreq();
-        u64 startTime = armGetSystemTick();
-        size_t startSizeBuffered = 0;
-        double speed = 0.0;
-
-        inst::ui::instPage::setInstBarPerc(0);
+        inst::ui::progress::Begin(inst::ui::progress::Stage::Downloading, inst::util::formatUrlString(ncaFileName), bufferedPlaceholderWriter.GetTotalDataSize());
         while (!bufferedPlaceholderWriter.IsBufferDataComplete() && !stopThreadsHttpNsp)
         {
-            u64 newTime = armGetSystemTick();
-
-            if (newTime - startTime >= freq * 0.5)
-            {
-                size_t newSizeBuffered = bufferedPlaceholderWriter.GetSizeBuffered();
-                double mbBuffered = (newSizeBuffered / 1000000.0) - (startSizeBuffered / 1000000.0);
-                double duration = ((double)(newTime - startTime) / (double)freq);
-                speed =  mbBuffered / duration;
-
-                startTime = newTime;
-                startSizeBuffered = newSizeBuffered;
-
-                const double sizeBuffered = static_cast<double>(bufferedPlaceholderWriter.GetSizeBuffered());
-                const double totalSize = static_cast<double>(bufferedPlaceholderWriter.GetTotalDataSize());
-                int downloadProgress = (int)((sizeBuffered / totalSize) * 100.0);
-
-                std::string etaText = "--:--";
-                if (speed > 0.0 && totalSize > sizeBuffered) {
-                    const double remainingMb = (totalSize - sizeBuffered) / 1000000.0;
-                    const auto etaSeconds = static_cast<std::uint64_t>(remainingMb / speed);
-                    etaText = FormatEta(etaSeconds);
-                }
-
-                inst::ui::instPage::setInstInfoText("inst.info_page.downloading"_lang + inst::util::formatUrlString(ncaFileName) + "inst.info_page.at"_lang + std::to_string(speed).substr(0, std::to_string(speed).size()-4) + "MB/s");
-                inst::ui::instPage::setInstBarPerc((double)downloadProgress);
-                inst::ui::instPage::setProgressDetailText(
-                    "Downloaded " + FormatOneDecimal(sizeBuffered / 1000000.0) + " / " +
-                    FormatOneDecimal(totalSize / 1000000.0) + " MB (" +
-                    std::to_string(downloadProgress) + "%) • ETA " + etaText
-                );
-            }
+            inst::ui::progress::SetBytes(bufferedPlaceholderWriter.GetSizeBuffered());
+            inst::ui::progress::Pump();
         }
-        inst::ui::instPage::setInstBarPerc(100);
-        inst::ui::instPage::setProgressDetailText("Downloaded 100% • Verifying and installing...");
+        inst::ui::progress::Finish();
 
-        inst::ui::instPage::setInstInfoText("inst.info_page.top_info0"_lang + ncaFileName + "...");
-        inst::ui::instPage::setInstBarPerc(0);
+        inst::ui::progress::Begin(inst::ui::progress::Stage::Installing, ncaFileName, bufferedPlaceholderWriter.GetTotalDataSize());
         while (!bufferedPlaceholderWriter.IsPlaceholderComplete() && !stopThreadsHttpNsp)
         {
-            int installProgress = (int)(((double)bufferedPlaceholderWriter.GetSizeWrittenToPlaceholder() / (double)bufferedPlaceholderWriter.GetTotalDataSize()) * 100.0);
-
-            inst::ui::instPage::setInstBarPerc((double)installProgress);
-            inst::ui::instPage::setProgressDetailText(
-                "Installing " + FormatOneDecimal((double)bufferedPlaceholderWriter.GetSizeWrittenToPlaceholder() / 1000000.0) + " / " +
-                FormatOneDecimal((double)bufferedPlaceholderWriter.GetTotalDataSize() / 1000000.0) + " MB (" +
-                std::to_string(installProgress) + "%)"
-            );
+            inst::ui::progress::SetBytes(bufferedPlaceholderWriter.GetSizeWrittenToPlaceholder());
+            inst::ui::progress::Pump();
         }
-        inst::ui::instPage::setInstBarPerc(100);
-        inst::ui::instPage::setProgressDetailText("Installing 100%");
+        inst::ui::progress::Finish();
 
         thrd_join(curlThread, NULL);
         thrd_join(writeThread, NULL);
         if (stopThreadsHttpNsp) THROW_FORMAT(("inst.net.transfer_interput"_lang).c_str());
+
+        tin::install::journal::SaveCheckpoint(m_sourceId, placeholderId, ncaSize);
+    }
+
+    u64 HTTPNSP::GetResumeOffset(std::shared_ptr<nx::ncm::ContentStorage>& contentStorage, const NcmContentId& placeholderId)
+    {
+        u64 checkpoint = tin::install::journal::GetCheckpoint(m_sourceId, placeholderId);
+        if (checkpoint == 0)
+            return 0;
+
+        try
+        {
+            if (contentStorage->HasPlaceholder(*(NcmPlaceHolderId*)&placeholderId))
+                return checkpoint;
+            // Already registered: nothing left to download
+            if (contentStorage->Has(placeholderId))
+            {
+                const PFS0FileEntry* fileEntry = this->GetFileEntryByNcaId(placeholderId);
+                if (fileEntry != nullptr && checkpoint >= fileEntry->fileSize)
+                    return checkpoint;
+            }
+        }
+        catch (...) {}
+
+        tin::install::journal::ClearCheckpoint(placeholderId);
+        return 0;
     }
 
     void HTTPNSP::BufferData(void* buf, off_t offset, size_t size)
@@ -26,7 +26,7 @@ SOFTWARE.
 #include "util/error.hpp"
 #include "util/util.hpp"
 #include "util/lang.hpp"
-#include "ui/instPage.hpp"
+#include "ui/installProgress.hpp"
 
 namespace tin::install::xci
 {
@@ -45,22 +45,17 @@ namespace tin::install::xci
         size_t ncaSize = fileEntry->fileSize;
 
         NcaWriter writer(ncaId, contentStorage);
-        float progress = 0.0f;
         u64 fileStart = GetDataOffset() + fileEntry->dataOffset;
         u64 fileOff = 0;
         size_t readSize = 0x400000;
         auto readBuffer = std::make_unique<u8[]>(readSize);
 
         try {
-            inst::ui::instPage::setInstInfoText("inst.info_page.top_info0"_lang + ncaFileName + "...");
-            inst::ui::instPage::setInstBarPerc(0);
+            inst::ui::progress::Begin(inst::ui::progress::Stage::Installing, ncaFileName, ncaSize);
+            inst::ui::progress::Render(true);
             while (fileOff < ncaSize) {
-                progress = (float)fileOff / (float)ncaSize;
-
-                if (fileOff % (0x400000 * 3) == 0) {
-                    LOG_DEBUG("> Progress: %lu/%lu MB (%d%s)\r", (fileOff / 1000000), (ncaSize / 1000000), (int)(progress * 100.0), "%");
-                    inst::ui::instPage::setInstBarPerc((double)(progress * 100.0));
-                }
+                if (fileOff % (0x400000 * 3) == 0)
+                    LOG_DEBUG("> Progress: %lu/%lu MB\r", (fileOff / 1000000), (ncaSize / 1000000));
 
                 if (fileOff + readSize >= ncaSize)
                     readSize = ncaSize - fileOff;
@@ -68,8 +63,10 @@ namespace tin::install::xci
                 this->BufferData(readBuffer.get(), fileOff + fileStart, readSize);
                 writer.write(readBuffer.get(), readSize);
                 fileOff += readSize;
+                inst::ui::progress::SetBytes(fileOff);
+                inst::ui::progress::Render();
             }
-            inst::ui::instPage::setInstBarPerc(100);
+            inst::ui::progress::Finish();
         } catch (std::exception& e) {
             LOG_DEBUG("something went wrong: %s\n", e.what());
         }
@@ -23,9 +23,12 @@ SOFTWARE.
 #include "install/install.hpp"
 
 #include <switch.h>
+#include <atomic>
 #include <cstring>
 #include <memory>
 #include "util/error.hpp"
+#include "util/crypto.hpp"
+#include "install/nca_verify.hpp"
 
 #include "nx/ncm.hpp"
 #include "util/title_util.hpp"
@@ -35,15 +38,24 @@ SOFTWARE.
 // TODO: Check tik/cert is present
 namespace tin::install
 {
+    namespace
+    {
+        // The install queue keeps more than one task alive at a time, so only the first task
+        // enables media playback state and only the last one to go away disables it again.
+        std::atomic<int> g_activeInstalls{0};
+    }
+
     Install::Install(NcmStorageId destStorageId, bool ignoreReqFirmVersion) :
         m_destStorageId(destStorageId), m_ignoreReqFirmVersion(ignoreReqFirmVersion), m_contentMeta()
     {
-        appletSetMediaPlaybackState(true);
+        if (g_activeInstalls.fetch_add(1) == 0)
+            appletSetMediaPlaybackState(true);
     }
 
     Install::~Install()
     {
-        appletSetMediaPlaybackState(false);
+        if (g_activeInstalls.fetch_sub(1) == 1)
+            appletSetMediaPlaybackState(false);
     }
 
     // TODO: Implement RAII on NcmContentMetaDatabase
@@ -83,13 +95,38 @@ namespace tin::install
     // Validate and obtain all data needed for install
     void Install::Prepare()
     {
-        tin::data::ByteBuffer cnmtBuf;
+        this->PrepareMetadata();
+
+        for (size_t i = 0; i < m_contentMeta.size(); i++) {
+            this->InstallContentMetaRecords(m_installContentMetaBufs[i], i);
+            this->InstallApplicationRecord(i);
+        }
+    }
+
+    void Install::Begin()
+    {
+        LOG_DEBUG("Installing ticket and cert...\n");
+        try
+        {
+            this->InstallTicketCert();
+        }
+        catch (std::runtime_error& e)
+        {
+            LOG_DEBUG("WARNING: Ticket installation failed! This may not be an issue, depending on your use case.\nProceed with caution!\n");
+        }
+
+        this->InstallContent();
+    }
 
+    void Install::PrepareMetadata()
+    {
         std::vector<std::tuple<nx::ncm::ContentMeta, NcmContentInfo>> tupelList = this->ReadCNMT();
-        
+
+        m_contentMeta.clear();
+        m_installContentMetaBufs.clear();
         for (size_t i = 0; i < tupelList.size(); i++) {
             std::tuple<nx::ncm::ContentMeta, NcmContentInfo> cnmtTuple = tupelList[i];
-            
+
             m_contentMeta.push_back(std::get<0>(cnmtTuple));
             NcmContentInfo cnmtContentRecord = std::get<1>(cnmtTuple);
 
@@ -111,32 +148,110 @@ namespace tin::install
 
             tin::data::ByteBuffer installContentMetaBuf;
             m_contentMeta[i].GetInstallContentMeta(installContentMetaBuf, cnmtContentRecord, m_ignoreReqFirmVersion);
+            m_installContentMetaBufs.push_back(std::move(installContentMetaBuf));
+        }
+    }
 
-            this->InstallContentMetaRecords(installContentMetaBuf, i);
-            this->InstallApplicationRecord(i);
+    void Install::StageTicketCert()
+    {
+        LOG_DEBUG("Reading ticket and cert...\n");
+        m_stagedTicketCerts.clear();
+        this->ReadTicketCert();
+    }
+
+    void Install::InstallContent()
+    {
+        for (nx::ncm::ContentMeta contentMeta: m_contentMeta) {
+            LOG_DEBUG("Installing NCAs...\n");
+            for (auto& record : contentMeta.GetContentInfos())
+            {
+                LOG_DEBUG("Installing from %s\n", tin::util::GetNcaIdString(record.content_id).c_str());
+                this->InstallNCA(record.content_id);
+            }
         }
     }
 
-    void Install::Begin()
+    void Install::Commit()
     {
-        LOG_DEBUG("Installing ticket and cert...\n");
+        LOG_DEBUG("Importing ticket and cert...\n");
         try
         {
-            this->InstallTicketCert();
+            this->ImportStagedTicketCert();
         }
         catch (std::runtime_error& e)
         {
             LOG_DEBUG("WARNING: Ticket installation failed! This may not be an issue, depending on your use case.\nProceed with caution!\n");
         }
 
-        for (nx::ncm::ContentMeta contentMeta: m_contentMeta) {
-            LOG_DEBUG("Installing NCAs...\n");
-            for (auto& record : contentMeta.GetContentInfos())
-            {
-                LOG_DEBUG("Installing from %s\n", tin::util::GetNcaIdString(record.content_id).c_str());
-                this->InstallNCA(record.content_id);
+        for (size_t i = 0; i < m_contentMeta.size(); i++) {
+            this->InstallContentMetaRecords(m_installContentMetaBufs[i], i);
+            this->InstallApplicationRecord(i);
+        }
+    }
+
+    void Install::ImportStagedTicketCert()
+    {
+        for (auto& ticketCert : m_stagedTicketCerts)
+            ASSERT_OK(esImportTicket(ticketCert.tik.data(), ticketCert.tik.size(), ticketCert.cert.data(), ticketCert.cert.size()), "Failed to import ticket");
+        m_stagedTicketCerts.clear();
+    }
+
+    const std::vector<u8>* Install::FindPrefetchedNca(const NcmContentId& ncaId) const
+    {
+        for (auto& prefetched : m_prefetchedNcas) {
+            if (memcmp(&prefetched.first, &ncaId, sizeof(NcmContentId)) == 0)
+                return &prefetched.second;
+        }
+        return nullptr;
+    }
+
+    bool Install::AddPrefetchedHeader(const NcmContentId& ncaId, const u8* encrypted, size_t size)
+    {
+        if (size < tin::install::verify::SignedHeaderSize)
+            return false;
+
+        std::vector<u8> header(encrypted, encrypted + tin::install::verify::SignedHeaderSize);
+        Crypto::AesXtr crypto = Crypto::HeaderCipher(false);
+        crypto.decrypt(header.data(), header.data(), header.size(), 0, 0x200);
+        if (*(u32*)(header.data() + 0x200) != MAGIC_NCA3)
+            return false;
+
+        m_prefetchedHeaders.emplace_back(ncaId, std::move(header));
+        return true;
+    }
+
+    void Install::SubmitPrefetchedHeaders()
+    {
+        std::vector<tin::install::verify::SignedHeader> batch(m_prefetchedHeaders.size());
+        for (size_t i = 0; i < m_prefetchedHeaders.size(); i++)
+            memcpy(batch[i].data(), m_prefetchedHeaders[i].second.data(), tin::install::verify::SignedHeaderSize);
+        tin::install::verify::SubmitBatch(batch);
+    }
+
+    bool Install::ReadPrefetchedHeader(const NcmContentId& ncaId, tin::install::NcaHeader& outHeader)
+    {
+        for (auto it = m_prefetchedHeaders.begin(); it != m_prefetchedHeaders.end(); ++it) {
+            if (memcmp(&it->first, &ncaId, sizeof(NcmContentId)) == 0) {
+                // Only the signed part is kept; validation does not look past it
+                memset(&outHeader, 0, sizeof(outHeader));
+                memcpy(&outHeader, it->second.data(), it->second.size());
+                m_prefetchedHeaders.erase(it);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool Install::TakePrefetchedNca(const NcmContentId& ncaId, std::vector<u8>& outData)
+    {
+        for (auto it = m_prefetchedNcas.begin(); it != m_prefetchedNcas.end(); ++it) {
+            if (memcmp(&it->first, &ncaId, sizeof(NcmContentId)) == 0) {
+                outData = std::move(it->second);
+                m_prefetchedNcas.erase(it);
+                return true;
             }
         }
+        return false;
     }
 
     u64 Install::GetTitleId(int i)
@@ -0,0 +1,102 @@
+#include "install/install_journal.hpp"
+
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+
+#include "util/config.hpp"
+#include "util/error.hpp"
+#include "util/json.hpp"
+#include "util/title_util.hpp"
+
+namespace tin::install::journal
+{
+    namespace
+    {
+        const std::string kJournalPath = inst::config::appDir + "/install_journal.json";
+        // Entries left behind by abandoned installs are dropped after a week
+        constexpr std::int64_t kEntryLifetimeSeconds = 7 * 24 * 60 * 60;
+
+        std::mutex g_journalMutex;
+
+        nlohmann::json LoadJournal()
+        {
+            try {
+                std::ifstream file(kJournalPath);
+                if (!file.good())
+                    return nlohmann::json::object();
+                nlohmann::json j;
+                file >> j;
+                if (j.is_object())
+                    return j;
+            }
+            catch (...) {}
+            return nlohmann::json::object();
+        }
+
+        void StoreJournal(nlohmann::json& j)
+        {
+            const std::int64_t now = std::time(nullptr);
+            for (auto it = j.begin(); it != j.end();)
+            {
+                const std::int64_t updated = it->value("updated", static_cast<std::int64_t>(0));
+                if (now - updated > kEntryLifetimeSeconds)
+                    it = j.erase(it);
+                else
+                    ++it;
+            }
+
+            std::ofstream file(kJournalPath);
+            file << std::setw(4) << j << std::endl;
+        }
+    }
+
+    std::string MakeSourceId(const std::string& url, const std::string& size, const std::string& etag)
+    {
+        return url + "|" + size + "|" + etag;
+    }
+
+    u64 GetCheckpoint(const std::string& sourceId, const NcmContentId& ncaId)
+    {
+        std::lock_guard<std::mutex> lock(g_journalMutex);
+        nlohmann::json j = LoadJournal();
+        const std::string key = tin::util::GetNcaIdString(ncaId);
+        if (!j.contains(key))
+            return 0;
+
+        const auto& entry = j[key];
+        if (entry.value("source", std::string()) != sourceId)
+            return 0;
+        return entry.value("committed", static_cast<u64>(0));
+    }
+
+    void SaveCheckpoint(const std::string& sourceId, const NcmContentId& ncaId, u64 committed)
+    {
+        std::lock_guard<std::mutex> lock(g_journalMutex);
+        nlohmann::json j = LoadJournal();
+        j[tin::util::GetNcaIdString(ncaId)] = {
+            {"source", sourceId},
+            {"committed", committed},
+            {"updated", static_cast<std::int64_t>(std::time(nullptr))}
+        };
+        try {
+            StoreJournal(j);
+        }
+        catch (...) {
+            LOG_DEBUG("Failed to write install journal\n");
+        }
+    }
+
+    void ClearCheckpoint(const NcmContentId& ncaId)
+    {
+        std::lock_guard<std::mutex> lock(g_journalMutex);
+        nlohmann::json j = LoadJournal();
+        if (j.erase(tin::util::GetNcaIdString(ncaId)) == 0)
+            return;
+        try {
+            StoreJournal(j);
+        }
+        catch (...) {}
+    }
+}
@@ -23,10 +23,13 @@ SOFTWARE.
 #include "install/install_nsp.hpp"
 
 #include <machine/endian.h>
+#include <limits>
 #include <thread>
 
 #include "install/nca.hpp"
+#include "install/nca_verify.hpp"
 #include "nx/fs.hpp"
+#include "nx/nca_writer.h"
 #include "nx/ncm.hpp"
 #include "util/config.hpp"
 #include "util/crypto.hpp"
@@ -78,6 +81,46 @@ namespace tin::install::nsp
         return CNMTList;
     }
 
+    void NSPInstall::PrefetchMetadata()
+    {
+        // CNMT NCAs are tiny; reading them here lets the queue pull them off the source while the
+        // previous title is still being written, and InstallNCA later writes them from memory.
+        constexpr u64 maxPrefetchSize = 0x800000;
+
+        for (const PFS0FileEntry* fileEntry : m_NSP->GetFileEntriesByExtension("cnmt.nca")) {
+            if (fileEntry == nullptr || fileEntry->fileSize > maxPrefetchSize)
+                continue;
+
+            NcmContentId cnmtContentId = tin::util::GetNcaIdFromString(m_NSP->GetFileEntryName(fileEntry));
+            std::vector<u8> data(fileEntry->fileSize);
+            m_NSP->BufferData(data.data(), m_NSP->GetDataOffset() + fileEntry->dataOffset, data.size());
+            m_prefetchedNcas.emplace_back(cnmtContentId, std::move(data));
+        }
+
+        if (inst::config::validateNCAs)
+        {
+            // Read the signed part of every NCA header now, so the whole title's signatures
+            // are checked on the verifier thread while earlier content is still streaming
+            for (const char* extension : {"nca", "ncz", "cnmt.nca"}) {
+                for (const PFS0FileEntry* fileEntry : m_NSP->GetFileEntriesByExtension(extension)) {
+                    if (fileEntry == nullptr || fileEntry->fileSize < tin::install::verify::SignedHeaderSize)
+                        continue;
+
+                    NcmContentId ncaId = tin::util::GetNcaIdFromString(m_NSP->GetFileEntryName(fileEntry));
+                    if (const std::vector<u8>* cnmtData = this->FindPrefetchedNca(ncaId)) {
+                        this->AddPrefetchedHeader(ncaId, cnmtData->data(), cnmtData->size());
+                        continue;
+                    }
+
+                    tin::install::verify::SignedHeader encrypted;
+                    m_NSP->BufferData(encrypted.data(), m_NSP->GetDataOffset() + fileEntry->dataOffset, encrypted.size());
+                    this->AddPrefetchedHeader(ncaId, encrypted.data(), encrypted.size());
+                }
+            }
+            this->SubmitPrefetchedHeaders();
+        }
+    }
+
     void NSPInstall::InstallNCA(const NcmContentId& ncaId)
     {
         const PFS0FileEntry* fileEntry = m_NSP->GetFileEntryByNcaId(ncaId);
@@ -90,26 +133,38 @@ namespace tin::install::nsp
 
         std::shared_ptr<nx::ncm::ContentStorage> contentStorage(new nx::ncm::ContentStorage(m_destStorageId));
 
-        // Attempt to delete any leftover placeholders
-        try {
-            contentStorage->DeletePlaceholder(*(NcmPlaceHolderId*)&ncaId);
+        std::vector<u8> prefetched;
+        bool havePrefetched = this->TakePrefetchedNca(ncaId, prefetched);
+
+        // Attempt to delete any leftover placeholders, unless a previous attempt can be resumed from them
+        if (havePrefetched || m_NSP->GetResumeOffset(contentStorage, ncaId) == 0)
+        {
+            try {
+                contentStorage->DeletePlaceholder(*(NcmPlaceHolderId*)&ncaId);
+            }
+            catch (...) {}
         }
-        catch (...) {}
 
         LOG_DEBUG("Size: 0x%lx\n", ncaSize);
 
         if (inst::config::validateNCAs && !m_declinedValidation)
         {
             tin::install::NcaHeader* header = new NcaHeader;
-            m_NSP->BufferData(header, m_NSP->GetDataOffset() + fileEntry->dataOffset, sizeof(tin::install::NcaHeader));
+            if (!this->ReadPrefetchedHeader(ncaId, *header))
+            {
+                if (havePrefetched && prefetched.size() >= sizeof(tin::install::NcaHeader))
+                    memcpy(header, prefetched.data(), sizeof(tin::install::NcaHeader));
+                else
+                    m_NSP->BufferData(header, m_NSP->GetDataOffset() + fileEntry->dataOffset, sizeof(tin::install::NcaHeader));
 
-            Crypto::AesXtr crypto(Crypto::Keys().headerKey, false);
-            crypto.decrypt(header, header, sizeof(tin::install::NcaHeader), 0, 0x200);
+                Crypto::AesXtr crypto = Crypto::HeaderCipher(false);
+                crypto.decrypt(header, header, sizeof(tin::install::NcaHeader), 0, 0x200);
+            }
 
             if (header->magic != MAGIC_NCA3)
                 THROW_FORMAT("Invalid NCA magic");
 
-            if (!Crypto::rsa2048PssVerify(&header->magic, 0x200, header->fixed_key_sig, Crypto::NCAHeaderSignature))
+            if (!tin::install::verify::IsFixedKeySignatureValid(*header))
             {
                 std::string audioPath = "romfs:/audio/bark.wav";
                 if (!inst::config::soundEnabled) audioPath = "";
@@ -124,7 +179,16 @@ namespace tin::install::nsp
             delete header;
         }
 
-        m_NSP->StreamToPlaceholder(contentStorage, ncaId);
+        if (havePrefetched)
+        {
+            NcaWriter writer(ncaId, contentStorage);
+            writer.write(prefetched.data(), prefetched.size());
+            writer.close();
+        }
+        else
+        {
+            m_NSP->StreamToPlaceholder(contentStorage, ncaId);
+        }
 
         LOG_DEBUG("Registering placeholder...\n");
 
@@ -145,6 +209,13 @@ namespace tin::install::nsp
     }
 
     void NSPInstall::InstallTicketCert()
+    {
+        m_stagedTicketCerts.clear();
+        this->ReadTicketCert();
+        this->ImportStagedTicketCert();
+    }
+
+    void NSPInstall::ReadTicketCert()
     {
         // Read the tik files and put it into a buffer
         std::vector<const PFS0FileEntry*> tikFileEntries = m_NSP->GetFileEntriesByExtension("tik");
@@ -154,31 +225,58 @@ namespace tin::install::nsp
             THROW_FORMAT("Ticket / Cert missmatch");
         }
 
-        for (size_t i = 0; i < tikFileEntries.size(); i++)
+        if (tikFileEntries.empty())
+            return;
+
+        // Tik and cert files are small and usually stored next to each other, so
+        // fetch all of them with a single read sized from the file table.
+        u64 spanStart = std::numeric_limits<u64>::max();
+        u64 spanEnd = 0;
+        u64 payloadSize = 0;
+        for (const auto* entries : {&tikFileEntries, &certFileEntries})
         {
-            if (tikFileEntries[i] == nullptr) {
-                LOG_DEBUG("Remote tik file is missing.\n");
-                THROW_FORMAT("Remote tik file is not present!");
+            for (const PFS0FileEntry* entry : *entries)
+            {
+                if (entry == nullptr) {
+                    LOG_DEBUG("Remote tik/cert file is missing.\n");
+                    THROW_FORMAT("Remote tik/cert file is not present!");
+                }
+                spanStart = std::min(spanStart, entry->dataOffset);
+                spanEnd = std::max(spanEnd, entry->dataOffset + entry->fileSize);
+                payloadSize += entry->fileSize;
             }
+        }
 
-            u64 tikSize = tikFileEntries[i]->fileSize;
-            auto tikBuf = std::make_unique<u8[]>(tikSize);
-            LOG_DEBUG("> Reading tik\n");
-            m_NSP->BufferData(tikBuf.get(), m_NSP->GetDataOffset() + tikFileEntries[i]->dataOffset, tikSize);
+        std::unique_ptr<u8[]> spanBuf;
+        if (spanEnd - spanStart <= payloadSize + 0x10000)
+        {
+            LOG_DEBUG("> Reading tik/cert span\n");
+            spanBuf = std::make_unique<u8[]>(spanEnd - spanStart);
+            m_NSP->BufferData(spanBuf.get(), m_NSP->GetDataOffset() + spanStart, spanEnd - spanStart);
+        }
 
-            if (certFileEntries[i] == nullptr)
-            {
-                LOG_DEBUG("Remote cert file is missing.\n");
-                THROW_FORMAT("Remote cert file is not present!");
-            }
+        auto readEntry = [&](const PFS0FileEntry* entry) -> std::unique_ptr<u8[]>
+        {
+            auto buf = std::make_unique<u8[]>(entry->fileSize);
+            if (spanBuf)
+                memcpy(buf.get(), spanBuf.get() + (entry->dataOffset - spanStart), entry->fileSize);
+            else
+                m_NSP->BufferData(buf.get(), m_NSP->GetDataOffset() + entry->dataOffset, entry->fileSize);
+            return buf;
+        };
+
+        for (size_t i = 0; i < tikFileEntries.size(); i++)
+        {
+            u64 tikSize = tikFileEntries[i]->fileSize;
+            auto tikBuf = readEntry(tikFileEntries[i]);
 
             u64 certSize = certFileEntries[i]->fileSize;
-            auto certBuf = std::make_unique<u8[]>(certSize);
-            LOG_DEBUG("> Reading cert\n");
-            m_NSP->BufferData(certBuf.get(), m_NSP->GetDataOffset() + certFileEntries[i]->dataOffset, certSize);
+            auto certBuf = readEntry(certFileEntries[i]);
 
-            // Finally, let's actually import the ticket
-            ASSERT_OK(esImportTicket(tikBuf.get(), tikSize, certBuf.get(), certSize), "Failed to import ticket");
+            TicketCert ticketCert;
+            ticketCert.tik.assign(tikBuf.get(), tikBuf.get() + tikSize);
+            ticketCert.cert.assign(certBuf.get(), certBuf.get() + certSize);
+            m_stagedTicketCerts.push_back(std::move(ticketCert));
         }
     }
 }
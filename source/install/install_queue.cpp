@@ -0,0 +1,149 @@
+#include "install/install_queue.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <utility>
+
+#include "util/error.hpp"
+
+namespace tin::install
+{
+    namespace
+    {
+        std::unique_ptr<Install> CreateAndPrefetch(const InstallQueueItem& item)
+        {
+            std::unique_ptr<Install> task = item.createTask();
+            if (task)
+                task->PrefetchMetadata();
+            return task;
+        }
+    }
+
+    std::vector<InstallQueueFailure> RunInstallQueue(const std::vector<InstallQueueItem>& items, const InstallQueueOptions& options)
+    {
+        std::vector<InstallQueueFailure> failures;
+
+        std::future<std::unique_ptr<Install>> prefetch;
+        size_t prefetchIndex = 0;
+        std::future<void> commitLane;
+        size_t commitIndex = 0;
+
+        auto recordFailure = [&](size_t index, const char* error)
+        {
+            LOG_DEBUG("Install of %s failed: %s\n", items[index].name.c_str(), error);
+            failures.push_back({index, items[index].name, error});
+        };
+
+        auto waitForCommit = [&]()
+        {
+            if (!commitLane.valid())
+                return;
+            try
+            {
+                commitLane.get();
+            }
+            catch (std::exception& e)
+            {
+                recordFailure(commitIndex, e.what());
+            }
+        };
+
+        auto startPrefetch = [&](size_t index)
+        {
+            if (index >= items.size() || !items[index].createTask)
+                return;
+            prefetchIndex = index;
+            prefetch = std::async(std::launch::async, CreateAndPrefetch, std::cref(items[index]));
+        };
+
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            const InstallQueueItem& item = items[i];
+            if (options.onTitleStart)
+                options.onTitleStart(i);
+
+            try
+            {
+                if (!item.createTask)
+                {
+                    if (item.installDirect)
+                        item.installDirect();
+                    continue;
+                }
+
+                std::unique_ptr<Install> task;
+                if (prefetch.valid() && prefetchIndex == i)
+                {
+                    try
+                    {
+                        task = prefetch.get();
+                    }
+                    catch (std::exception& e)
+                    {
+                        // Retry on this thread so a persistent error surfaces for this title
+                        LOG_DEBUG("Prefetch of %s failed, retrying: %s\n", item.name.c_str(), e.what());
+                        task = CreateAndPrefetch(item);
+                    }
+                }
+                else
+                {
+                    task = CreateAndPrefetch(item);
+                }
+
+                if (!task)
+                {
+                    if (item.installDirect)
+                        item.installDirect();
+                    continue;
+                }
+
+                if (options.concurrentSourceReads)
+                    startPrefetch(i + 1);
+
+                LOG_DEBUG("%s\n", "Preparing installation");
+                task->PrepareMetadata();
+                if (options.onTaskPrepared)
+                    options.onTaskPrepared(i, *task);
+
+                try
+                {
+                    task->StageTicketCert();
+                }
+                catch (std::runtime_error& e)
+                {
+                    LOG_DEBUG("WARNING: Reading ticket failed: %s\n", e.what());
+                }
+
+                task->InstallContent();
+
+                // One commit lane: records for consecutive titles stay in order
+                waitForCommit();
+                commitIndex = i;
+                std::shared_ptr<Install> committing(std::move(task));
+                commitLane = std::async(std::launch::async, [committing]() { committing->Commit(); });
+            }
+            catch (std::exception& e)
+            {
+                recordFailure(i, e.what());
+                if (!options.continueAfterFailure)
+                    break;
+            }
+        }
+
+        waitForCommit();
+
+        if (prefetch.valid())
+        {
+            try
+            {
+                prefetch.get();
+            }
+            catch (...) {}
+        }
+
+        // Commit failures are recorded late; report in list order
+        std::stable_sort(failures.begin(), failures.end(), [](const InstallQueueFailure& a, const InstallQueueFailure& b) { return a.index < b.index; });
+        return failures;
+    }
+}
@@ -32,6 +32,8 @@ SOFTWARE.
 #include "util/util.hpp"
 #include "util/lang.hpp"
 #include "install/nca.hpp"
+#include "install/nca_verify.hpp"
+#include "nx/nca_writer.h"
 #include "ui/MainApplication.hpp"
 
 namespace inst::ui {
@@ -74,6 +76,46 @@ namespace tin::install::xci
         return CNMTList;
     }
 
+    void XCIInstallTask::PrefetchMetadata()
+    {
+        // CNMT NCAs are tiny; reading them here lets the queue pull them off the source while the
+        // previous title is still being written, and InstallNCA later writes them from memory.
+        constexpr u64 maxPrefetchSize = 0x800000;
+
+        for (const HFS0FileEntry* fileEntry : m_xci->GetFileEntriesByExtension("cnmt.nca")) {
+            if (fileEntry == nullptr || fileEntry->fileSize > maxPrefetchSize)
+                continue;
+
+            NcmContentId cnmtContentId = tin::util::GetNcaIdFromString(m_xci->GetFileEntryName(fileEntry));
+            std::vector<u8> data(fileEntry->fileSize);
+            m_xci->BufferData(data.data(), m_xci->GetDataOffset() + fileEntry->dataOffset, data.size());
+            m_prefetchedNcas.emplace_back(cnmtContentId, std::move(data));
+        }
+
+        if (inst::config::validateNCAs)
+        {
+            // Read the signed part of every NCA header now, so the whole title's signatures
+            // are checked on the verifier thread while earlier content is still streaming
+            for (const char* extension : {"nca", "ncz", "cnmt.nca"}) {
+                for (const HFS0FileEntry* fileEntry : m_xci->GetFileEntriesByExtension(extension)) {
+                    if (fileEntry == nullptr || fileEntry->fileSize < tin::install::verify::SignedHeaderSize)
+                        continue;
+
+                    NcmContentId ncaId = tin::util::GetNcaIdFromString(m_xci->GetFileEntryName(fileEntry));
+                    if (const std::vector<u8>* cnmtData = this->FindPrefetchedNca(ncaId)) {
+                        this->AddPrefetchedHeader(ncaId, cnmtData->data(), cnmtData->size());
+                        continue;
+                    }
+
+                    tin::install::verify::SignedHeader encrypted;
+                    m_xci->BufferData(encrypted.data(), m_xci->GetDataOffset() + fileEntry->dataOffset, encrypted.size());
+                    this->AddPrefetchedHeader(ncaId, encrypted.data(), encrypted.size());
+                }
+            }
+            this->SubmitPrefetchedHeaders();
+        }
+    }
+
     void XCIInstallTask::InstallNCA(const NcmContentId& ncaId)
     {
         const HFS0FileEntry* fileEntry = m_xci->GetFileEntryByNcaId(ncaId);
@@ -86,6 +128,9 @@ namespace tin::install::xci
 
         std::shared_ptr<nx::ncm::ContentStorage> contentStorage(new nx::ncm::ContentStorage(m_destStorageId));
 
+        std::vector<u8> prefetched;
+        bool havePrefetched = this->TakePrefetchedNca(ncaId, prefetched);
+
         // Attempt to delete any leftover placeholders
         try {
             contentStorage->DeletePlaceholder(*(NcmPlaceHolderId*)&ncaId);
@@ -97,15 +142,21 @@ namespace tin::install::xci
         if (inst::config::validateNCAs && !m_declinedValidation)
         {
             tin::install::NcaHeader* header = new NcaHeader;
-            m_xci->BufferData(header, m_xci->GetDataOffset() + fileEntry->dataOffset, sizeof(tin::install::NcaHeader));
+            if (!this->ReadPrefetchedHeader(ncaId, *header))
+            {
+                if (havePrefetched && prefetched.size() >= sizeof(tin::install::NcaHeader))
+                    memcpy(header, prefetched.data(), sizeof(tin::install::NcaHeader));
+                else
+                    m_xci->BufferData(header, m_xci->GetDataOffset() + fileEntry->dataOffset, sizeof(tin::install::NcaHeader));
 
-            Crypto::AesXtr crypto(Crypto::Keys().headerKey, false);
-            crypto.decrypt(header, header, sizeof(tin::install::NcaHeader), 0, 0x200);
+                Crypto::AesXtr crypto = Crypto::HeaderCipher(false);
+                crypto.decrypt(header, header, sizeof(tin::install::NcaHeader), 0, 0x200);
+            }
 
             if (header->magic != MAGIC_NCA3)
                 THROW_FORMAT("Invalid NCA magic");
 
-            if (!Crypto::rsa2048PssVerify(&header->magic, 0x200, header->fixed_key_sig, Crypto::NCAHeaderSignature))
+            if (!tin::install::verify::IsFixedKeySignatureValid(*header))
             {
                 std::string audioPath = "romfs:/audio/bark.wav";
                 if (!inst::config::soundEnabled) audioPath = "";
@@ -120,7 +171,16 @@ namespace tin::install::xci
             delete header;
         }
 
-        m_xci->StreamToPlaceholder(contentStorage, ncaId);
+        if (havePrefetched)
+        {
+            NcaWriter writer(ncaId, contentStorage);
+            writer.write(prefetched.data(), prefetched.size());
+            writer.close();
+        }
+        else
+        {
+            m_xci->StreamToPlaceholder(contentStorage, ncaId);
+        }
 
         // Clean up the line for whatever comes next
         LOG_DEBUG("                                                           \r");
@@ -143,6 +203,13 @@ namespace tin::install::xci
     }
 
     void XCIInstallTask::InstallTicketCert()
+    {
+        m_stagedTicketCerts.clear();
+        this->ReadTicketCert();
+        this->ImportStagedTicketCert();
+    }
+
+    void XCIInstallTask::ReadTicketCert()
     {
         // Read the tik files and put it into a buffer
         std::vector<const HFS0FileEntry*> tikFileEntries = m_xci->GetFileEntriesByExtension("tik");
@@ -176,8 +243,10 @@ namespace tin::install::xci
             LOG_DEBUG("> Reading cert\n");
             m_xci->BufferData(certBuf.get(), m_xci->GetDataOffset() + certFileEntries[i]->dataOffset, certSize);
 
-            // Finally, let's actually import the ticket
-            ASSERT_OK(esImportTicket(tikBuf.get(), tikSize, certBuf.get(), certSize), "Failed to import ticket");
+            TicketCert ticketCert;
+            ticketCert.tik.assign(tikBuf.get(), tikBuf.get() + tikSize);
+            ticketCert.cert.assign(certBuf.get(), certBuf.get() + certSize);
+            m_stagedTicketCerts.push_back(std::move(ticketCert));
         }
     }
 }
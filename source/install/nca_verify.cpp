@@ -0,0 +1,174 @@
+#include "install/nca_verify.hpp"
+
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "util/crypto.hpp"
+#include "util/error.hpp"
+
+namespace tin::install::verify
+{
+    namespace
+    {
+        constexpr size_t kMaxCachedResults = 4096;
+
+        enum class CheckState { Queued, Running, Done };
+
+        struct CheckResult
+        {
+            CheckState state = CheckState::Queued;
+            bool valid = false;
+        };
+
+        std::mutex g_mutex;
+        std::condition_variable g_cv;
+        std::unordered_map<std::string, CheckResult> g_results;
+        std::deque<std::pair<std::string, SignedHeader>> g_queue;
+        bool g_stop = false;
+        std::thread g_worker;
+
+        std::string HeaderKey(const u8* data)
+        {
+            u8 hash[SHA256_HASH_SIZE];
+            sha256CalculateHash(hash, data, SignedHeaderSize);
+            return std::string((const char*)hash, sizeof(hash));
+        }
+
+        bool CheckSignature(const u8* data)
+        {
+            try
+            {
+                // Signature 0 is at 0x0, the signed region starts at the magic (0x200)
+                return Crypto::rsa2048PssVerify(data + 0x200, 0x200, data, Crypto::NCAHeaderSignature);
+            }
+            catch (std::runtime_error& e)
+            {
+                LOG_DEBUG("NCA header signature check failed: %s\n", e.what());
+                return false;
+            }
+        }
+
+        // Caller holds g_mutex
+        void TrimLocked()
+        {
+            if (g_results.size() <= kMaxCachedResults)
+                return;
+            for (auto it = g_results.begin(); it != g_results.end();) {
+                if (it->second.state == CheckState::Done)
+                    it = g_results.erase(it);
+                else
+                    ++it;
+            }
+        }
+
+        void WorkerMain()
+        {
+            std::unique_lock<std::mutex> lock(g_mutex);
+            while (true) {
+                g_cv.wait(lock, [] { return g_stop || !g_queue.empty(); });
+                if (g_stop)
+                    return;
+
+                auto job = std::move(g_queue.front());
+                g_queue.pop_front();
+                auto it = g_results.find(job.first);
+                // Already picked up by an installer that could not wait
+                if (it == g_results.end() || it->second.state != CheckState::Queued)
+                    continue;
+                it->second.state = CheckState::Running;
+
+                lock.unlock();
+                const bool valid = CheckSignature(job.second.data());
+                lock.lock();
+
+                CheckResult& result = g_results[job.first];
+                result.valid = valid;
+                result.state = CheckState::Done;
+                g_cv.notify_all();
+            }
+        }
+    }
+
+    void SubmitBatch(const std::vector<SignedHeader>& headers)
+    {
+        if (headers.empty())
+            return;
+
+        std::vector<std::string> keys;
+        keys.reserve(headers.size());
+        for (const auto& header : headers)
+            keys.push_back(HeaderKey(header.data()));
+
+        std::lock_guard<std::mutex> lock(g_mutex);
+        TrimLocked();
+        for (size_t i = 0; i < headers.size(); i++) {
+            if (!g_results.emplace(keys[i], CheckResult{}).second)
+                continue;
+            g_queue.emplace_back(keys[i], headers[i]);
+        }
+
+        if (!g_worker.joinable()) {
+            g_stop = false;
+            g_worker = std::thread(WorkerMain);
+        }
+        g_cv.notify_all();
+    }
+
+    bool IsFixedKeySignatureValid(const NcaHeader& header)
+    {
+        const u8* data = (const u8*)&header;
+        const std::string key = HeaderKey(data);
+
+        std::unique_lock<std::mutex> lock(g_mutex);
+        auto it = g_results.find(key);
+        if (it == g_results.end()) {
+            it = g_results.emplace(key, CheckResult{}).first;
+        } else if (it->second.state == CheckState::Running) {
+            g_cv.wait(lock, [&key] {
+                auto current = g_results.find(key);
+                return current == g_results.end() || current->second.state == CheckState::Done;
+            });
+            it = g_results.find(key);
+            if (it != g_results.end())
+                return it->second.valid;
+            it = g_results.emplace(key, CheckResult{}).first;
+        }
+
+        if (it->second.state == CheckState::Done)
+            return it->second.valid;
+
+        // Not started yet: check here rather than waiting behind other queued headers
+        it->second.state = CheckState::Running;
+        lock.unlock();
+        const bool valid = CheckSignature(data);
+        lock.lock();
+
+        CheckResult& result = g_results[key];
+        result.valid = valid;
+        result.state = CheckState::Done;
+        g_cv.notify_all();
+        return valid;
+    }
+
+    void Shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            g_stop = true;
+            g_queue.clear();
+        }
+        g_cv.notify_all();
+        if (g_worker.joinable())
+            g_worker.join();
+
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_results.clear();
+        g_stop = false;
+    }
+}
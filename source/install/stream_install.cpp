@@ -0,0 +1,804 @@
+#include "install/stream_install.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+#include <unordered_map>
+
+#include "install/hfs0.hpp"
+#include "install/nca.hpp"
+#include "install/nca_verify.hpp"
+#include "install/pfs0.hpp"
+#include "util/config.hpp"
+#include "util/crypto.hpp"
+#include "util/error.hpp"
+#include "util/file_util.hpp"
+#include "util/title_util.hpp"
+#include "util/util.hpp"
+#include "util/lang.hpp"
+#include "ui/MainApplication.hpp"
+
+namespace inst::ui {
+    extern MainApplication *mainApp;
+}
+
+namespace tin::install::stream
+{
+    namespace
+    {
+        constexpr u32 kPfs0Magic = 0x30534650;
+        constexpr u32 kMaxContainerFiles = 0x4000;
+        constexpr u32 kMaxStringTableSize = 256 * 1024;
+        constexpr size_t kPullChunkSize = 0x800000;
+        // Largest hole between tik/cert payloads that is still read through rather than split
+        constexpr u64 kMaxTicketGap = 0x10000;
+        constexpr size_t kMaxPushHeaderSize = sizeof(PFS0BaseHeader) + kMaxContainerFiles * sizeof(PFS0FileEntry) + kMaxStringTableSize;
+
+        bool EndsWith(const std::string& value, const char* suffix)
+        {
+            const size_t len = std::strlen(suffix);
+            return value.size() >= len && value.compare(value.size() - len, len, suffix) == 0;
+        }
+
+        bool ReadHfs0Partition(ByteSource& source, s64 off, std::vector<u8>& out)
+        {
+            HFS0BaseHeader base{};
+            u64 bytes_read = 0;
+            if (R_FAILED(source.Read(&base, off, sizeof(base), &bytes_read))) return false;
+            if (base.magic != MAGIC_HFS0) return false;
+            if (base.numFiles == 0 || base.numFiles > kMaxContainerFiles) return false;
+            if (base.stringTableSize > kMaxStringTableSize) return false;
+
+            const size_t remaining = base.numFiles * sizeof(HFS0FileEntry) + base.stringTableSize;
+            out.resize(sizeof(base) + remaining);
+            std::memcpy(out.data(), &base, sizeof(base));
+            if (R_FAILED(source.Read(out.data() + sizeof(base), off + sizeof(base), remaining, &bytes_read))) return false;
+            return true;
+        }
+    }
+
+    // ReadAheadSource
+
+    ReadAheadSource::ReadAheadSource(size_t read_ahead_size) :
+        m_read_ahead_size(read_ahead_size)
+    {
+    }
+
+    Result ReadAheadSource::Read(void* buf, s64 off, s64 size, u64* bytes_read)
+    {
+        if (off < 0 || size <= 0) return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+
+        auto* out = static_cast<u8*>(buf);
+        u64 pos = static_cast<u64>(off);
+        u64 remaining = static_cast<u64>(size);
+        *bytes_read = 0;
+
+        while (remaining > 0)
+        {
+            if (pos >= m_cache_start && pos < m_cache_end)
+            {
+                const u64 chunk = std::min<u64>(remaining, m_cache_end - pos);
+                std::memcpy(out, m_cache.data() + (pos - m_cache_start), chunk);
+                out += chunk;
+                pos += chunk;
+                remaining -= chunk;
+                *bytes_read += chunk;
+                continue;
+            }
+
+            if (m_cache.size() != m_read_ahead_size)
+                m_cache.resize(m_read_ahead_size);
+
+            const size_t fetched = this->Fetch(m_cache.data(), pos, m_cache.size());
+            if (fetched == 0)
+            {
+                m_cache_start = m_cache_end = 0;
+                return MAKERESULT(Module_Libnx, LibnxError_IoError);
+            }
+            m_cache_start = pos;
+            m_cache_end = pos + fetched;
+        }
+
+        return 0;
+    }
+
+    HttpByteSource::HttpByteSource(tin::network::HTTPDownload& download, size_t read_ahead_size) :
+        ReadAheadSource(read_ahead_size), m_download(download)
+    {
+    }
+
+    size_t HttpByteSource::Fetch(void* buf, u64 off, size_t size)
+    {
+        size_t received = 0;
+        auto streamFunc = [&](u8* streamBuf, size_t streamBufSize) -> size_t
+        {
+            if (received + streamBufSize > size)
+                return 0;
+            std::memcpy(static_cast<u8*>(buf) + received, streamBuf, streamBufSize);
+            received += streamBufSize;
+            return streamBufSize;
+        };
+
+        if (m_download.StreamDataRange(off, size, streamFunc) != 0)
+            return 0;
+        return received;
+    }
+
+    // Container index
+
+    StreamEntry MakeStreamEntry(std::string name, u64 offset, u64 size)
+    {
+        StreamEntry entry;
+        entry.offset = offset;
+        entry.size = size;
+        if (EndsWith(name, ".nca") || EndsWith(name, ".ncz"))
+        {
+            entry.kind = StreamEntry::Kind::Nca;
+            entry.isCnmt = EndsWith(name, ".cnmt.nca") || EndsWith(name, ".cnmt.ncz");
+            if (name.size() >= 32)
+                entry.ncaId = tin::util::GetNcaIdFromString(name.substr(0, 32));
+        }
+        else if (EndsWith(name, ".tik"))
+        {
+            entry.kind = StreamEntry::Kind::Ticket;
+        }
+        else if (EndsWith(name, ".cert"))
+        {
+            entry.kind = StreamEntry::Kind::Cert;
+        }
+        entry.name = std::move(name);
+        return entry;
+    }
+
+    bool ParsePfs0Entries(const u8* data, size_t size, std::vector<StreamEntry>& out, size_t* out_header_size)
+    {
+        if (size < sizeof(PFS0BaseHeader))
+            return false;
+
+        PFS0BaseHeader base{};
+        std::memcpy(&base, data, sizeof(base));
+        if (base.magic != kPfs0Magic)
+            THROW_FORMAT("Invalid PFS0 magic");
+        if (base.numFiles > kMaxContainerFiles || base.stringTableSize > kMaxStringTableSize)
+            THROW_FORMAT("Invalid PFS0 header");
+
+        const size_t stringTableStart = sizeof(PFS0BaseHeader) + base.numFiles * sizeof(PFS0FileEntry);
+        const size_t headerSize = stringTableStart + base.stringTableSize;
+        if (out_header_size)
+            *out_header_size = headerSize;
+        if (size < headerSize)
+            return false;
+
+        out.clear();
+        out.reserve(base.numFiles);
+        for (u32 i = 0; i < base.numFiles; i++)
+        {
+            PFS0FileEntry fileEntry{};
+            std::memcpy(&fileEntry, data + sizeof(PFS0BaseHeader) + i * sizeof(PFS0FileEntry), sizeof(fileEntry));
+            if (fileEntry.stringTableOffset >= base.stringTableSize)
+                THROW_FORMAT("Invalid PFS0 string table offset");
+
+            const char* name = reinterpret_cast<const char*>(data + stringTableStart + fileEntry.stringTableOffset);
+            const size_t maxLen = base.stringTableSize - fileEntry.stringTableOffset;
+            out.push_back(MakeStreamEntry(std::string(name, strnlen(name, maxLen)), headerSize + fileEntry.dataOffset, fileEntry.fileSize));
+        }
+        return true;
+    }
+
+    bool ReadPfs0Entries(ByteSource& source, std::vector<StreamEntry>& out)
+    {
+        std::vector<u8> header(sizeof(PFS0BaseHeader));
+        u64 bytes_read = 0;
+        if (R_FAILED(source.Read(header.data(), 0, header.size(), &bytes_read)))
+            return false;
+
+        size_t headerSize = 0;
+        if (ParsePfs0Entries(header.data(), header.size(), out, &headerSize))
+            return true;
+
+        header.resize(headerSize);
+        if (R_FAILED(source.Read(header.data() + sizeof(PFS0BaseHeader), sizeof(PFS0BaseHeader), headerSize - sizeof(PFS0BaseHeader), &bytes_read)))
+            return false;
+        return ParsePfs0Entries(header.data(), header.size(), out, &headerSize);
+    }
+
+    bool ReadXciEntries(ByteSource& source, std::vector<StreamEntry>& out)
+    {
+        std::vector<u8> root;
+        s64 rootOffset = 0xF000;
+        if (!ReadHfs0Partition(source, rootOffset, root))
+        {
+            rootOffset = 0x10000;
+            if (!ReadHfs0Partition(source, rootOffset, root))
+                return false;
+        }
+
+        const auto* rootHeader = reinterpret_cast<const HFS0BaseHeader*>(root.data());
+        for (u32 i = 0; i < rootHeader->numFiles; i++)
+        {
+            if (std::strcmp(hfs0GetFileName(rootHeader, i), "secure") != 0)
+                continue;
+
+            std::vector<u8> secure;
+            const s64 secureOffset = rootOffset + static_cast<s64>(root.size() + hfs0GetFileEntry(rootHeader, i)->dataOffset);
+            if (!ReadHfs0Partition(source, secureOffset, secure))
+                return false;
+
+            const auto* secureHeader = reinterpret_cast<const HFS0BaseHeader*>(secure.data());
+            const u64 dataOffset = static_cast<u64>(secureOffset) + secure.size();
+            out.clear();
+            out.reserve(secureHeader->numFiles);
+            for (u32 j = 0; j < secureHeader->numFiles; j++)
+            {
+                const HFS0FileEntry* fileEntry = hfs0GetFileEntry(secureHeader, j);
+                out.push_back(MakeStreamEntry(hfs0GetFileName(secureHeader, fileEntry), dataOffset + fileEntry->dataOffset, fileEntry->fileSize));
+            }
+            return true;
+        }
+
+        return false;
+    }
+
+    // StreamInstallHelper
+
+    StreamInstallHelper::StreamInstallHelper(NcmStorageId destStorageId, bool ignoreReqFirmVersion) :
+        Install(destStorageId, ignoreReqFirmVersion)
+    {
+    }
+
+    void StreamInstallHelper::AddContentMeta(const nx::ncm::ContentMeta& meta, const NcmContentInfo& info)
+    {
+        m_contentMeta.push_back(meta);
+        m_cnmtInfos.push_back(info);
+    }
+
+    void StreamInstallHelper::CommitLatest()
+    {
+        if (m_contentMeta.empty()) return;
+        const size_t idx = m_contentMeta.size() - 1;
+        tin::data::ByteBuffer installBuf;
+        m_contentMeta[idx].GetInstallContentMeta(installBuf, m_cnmtInfos[idx], m_ignoreReqFirmVersion);
+        InstallContentMetaRecords(installBuf, idx);
+        InstallApplicationRecord(idx);
+    }
+
+    void StreamInstallHelper::CommitAll()
+    {
+        for (size_t i = 0; i < m_contentMeta.size(); i++)
+        {
+            tin::data::ByteBuffer installBuf;
+            m_contentMeta[i].GetInstallContentMeta(installBuf, m_cnmtInfos[i], m_ignoreReqFirmVersion);
+            InstallContentMetaRecords(installBuf, i);
+            InstallApplicationRecord(i);
+        }
+    }
+
+    // StreamInstaller
+
+    StreamInstaller::StreamInstaller(NcmStorageId destStorageId, bool ignoreReqFirmVersion) :
+        m_destStorageId(destStorageId)
+    {
+        m_helper = std::make_unique<StreamInstallHelper>(destStorageId, ignoreReqFirmVersion);
+    }
+
+    StreamInstaller::~StreamInstaller() = default;
+
+    void StreamInstaller::SetEntries(std::vector<StreamEntry> entries)
+    {
+        std::sort(entries.begin(), entries.end(), [](const StreamEntry& a, const StreamEntry& b) {
+            return a.offset < b.offset;
+        });
+
+        m_entries.clear();
+        m_entries.resize(entries.size());
+        for (size_t i = 0; i < entries.size(); i++)
+            m_entries[i].info = std::move(entries[i]);
+        m_hintIndex = 0;
+        m_ticketFailed = false;
+
+        // Pair every ticket with the cert of the same base name up front, so the
+        // ticket can be imported the moment the second half arrives.
+        std::unordered_map<std::string, size_t> certsByBase;
+        for (size_t i = 0; i < m_entries.size(); i++)
+        {
+            const auto& info = m_entries[i].info;
+            if (info.kind == StreamEntry::Kind::Cert)
+                certsByBase.emplace(info.name.substr(0, info.name.size() - 5), i);
+        }
+        for (size_t i = 0; i < m_entries.size() && !certsByBase.empty(); i++)
+        {
+            const auto& info = m_entries[i].info;
+            if (info.kind != StreamEntry::Kind::Ticket)
+                continue;
+            const auto it = certsByBase.find(info.name.substr(0, info.name.size() - 4));
+            if (it == certsByBase.end())
+                continue;
+            m_entries[i].pair = it->second;
+            m_entries[it->second].pair = i;
+            certsByBase.erase(it);
+        }
+
+        // No bytes will ever arrive for an empty tik/cert, so it is complete up front.
+        // A pair with an empty half has nothing to import and is dropped, like the old
+        // MTP path skipped it, rather than handing esImportTicket an empty buffer.
+        for (auto& entry : m_entries)
+        {
+            if (entry.info.size == 0 && entry.info.kind != StreamEntry::Kind::Nca)
+            {
+                entry.started = true;
+                entry.complete = true;
+                if (entry.pair != kNoPair)
+                {
+                    m_entries[entry.pair].pair = kNoPair;
+                    entry.pair = kNoPair;
+                }
+            }
+        }
+    }
+
+    u64 StreamInstaller::GetTotalSize() const
+    {
+        u64 total = 0;
+        for (const auto& entry : m_entries)
+            total += entry.info.size;
+        return total;
+    }
+
+    bool StreamInstaller::IsComplete() const
+    {
+        for (const auto& entry : m_entries)
+        {
+            if (entry.info.kind != StreamEntry::Kind::Other && !entry.complete)
+                return false;
+        }
+        return true;
+    }
+
+    bool StreamInstaller::StartEntry(EntryState& entry)
+    {
+        if (entry.started) return true;
+        entry.started = true;
+
+        switch (entry.info.kind)
+        {
+            case StreamEntry::Kind::Nca:
+                entry.storage = std::make_shared<nx::ncm::ContentStorage>(m_destStorageId);
+                try {
+                    entry.storage->DeletePlaceholder(*(NcmPlaceHolderId*)&entry.info.ncaId);
+                } catch (...) {}
+                entry.ncaWriter = std::make_unique<NcaWriter>(entry.info.ncaId, entry.storage);
+                entry.headerPending = m_validateNCAs && !m_declinedValidation;
+                break;
+            case StreamEntry::Kind::Ticket:
+            case StreamEntry::Kind::Cert:
+                entry.data.resize(entry.info.size);
+                break;
+            default:
+                break;
+        }
+        return true;
+    }
+
+    bool StreamInstaller::CommitCnmt(EntryState& entry)
+    {
+        try {
+            std::string cnmtPath = entry.storage->GetPath(entry.info.ncaId);
+            nx::ncm::ContentMeta meta = tin::util::GetContentMetaFromNCA(cnmtPath);
+            NcmContentInfo cnmtInfo{};
+            cnmtInfo.content_id = entry.info.ncaId;
+            ncmU64ToContentInfoSize(entry.info.size & 0xFFFFFFFFFFFF, &cnmtInfo);
+            cnmtInfo.content_type = NcmContentType_Meta;
+            m_helper->AddContentMeta(meta, cnmtInfo);
+            m_helper->CommitLatest();
+            if (m_onCnmt)
+                m_onCnmt(meta);
+            return true;
+        } catch (std::exception& e) {
+            LOG_DEBUG("Stream install: CNMT commit failed for %s: %s\n", entry.info.name.c_str(), e.what());
+            return false;
+        }
+    }
+
+    void StreamInstaller::VerifyNcaHeader(EntryState& entry)
+    {
+        if (m_declinedValidation)
+            return;
+        if (entry.data.size() < tin::install::verify::SignedHeaderSize)
+            THROW_FORMAT("Invalid NCA magic");
+
+        // Decrypt a copy; the encrypted bytes are what gets written to the placeholder
+        auto header = std::make_unique<tin::install::NcaHeader>();
+        std::memset(header.get(), 0, sizeof(tin::install::NcaHeader));
+        std::memcpy(header.get(), entry.data.data(), tin::install::verify::SignedHeaderSize);
+        Crypto::AesXtr crypto = Crypto::HeaderCipher(false);
+        crypto.decrypt(header.get(), header.get(), tin::install::verify::SignedHeaderSize, 0, 0x200);
+
+        if (header->magic != MAGIC_NCA3)
+            THROW_FORMAT("Invalid NCA magic");
+
+        if (!tin::install::verify::IsFixedKeySignatureValid(*header))
+        {
+            std::string audioPath = "romfs:/audio/bark.wav";
+            if (!inst::config::soundEnabled) audioPath = "";
+            if (std::filesystem::exists(inst::config::appDir + "/bark.wav")) audioPath = inst::config::appDir + "/bark.wav";
+            std::thread audioThread(inst::util::playAudio,audioPath);
+            int rc = inst::ui::mainApp->CreateShowDialog("inst.nca_verify.title"_lang, "inst.nca_verify.desc"_lang, {"common.cancel"_lang, "inst.nca_verify.opt1"_lang}, false);
+            audioThread.join();
+            if (rc != 1)
+                THROW_FORMAT(("inst.nca_verify.error"_lang + tin::util::GetNcaIdString(entry.info.ncaId)).c_str());
+            m_declinedValidation = true;
+        }
+    }
+
+    void StreamInstaller::CompleteNca(EntryState& entry)
+    {
+        entry.ncaWriter->close();
+        try {
+            entry.storage->Register(*(NcmPlaceHolderId*)&entry.info.ncaId, entry.info.ncaId);
+            entry.storage->DeletePlaceholder(*(NcmPlaceHolderId*)&entry.info.ncaId);
+        } catch (...) {}
+        entry.complete = true;
+        if (entry.info.isCnmt)
+            this->CommitCnmt(entry);
+
+        // The writer holds the NCZ decompression buffers; release them as soon as the entry is done.
+        entry.ncaWriter.reset();
+        entry.storage.reset();
+    }
+
+    bool StreamInstaller::WriteEntry(EntryState& entry, const u8* data, size_t size, u64 relOffset)
+    {
+        if (relOffset != entry.written)
+        {
+            // Host retries/overlaps can happen near transfer end; accept already-written prefix.
+            if (relOffset > entry.written)
+            {
+                LOG_DEBUG("Stream install: gap in %s (rel=%lu written=%lu)\n", entry.info.name.c_str(), relOffset, entry.written);
+                return false;
+            }
+            const auto overlap = static_cast<size_t>(std::min<u64>(entry.written - relOffset, size));
+            data += overlap;
+            size -= overlap;
+            if (size == 0)
+                return true;
+        }
+
+        if (entry.complete)
+            return true;
+
+        switch (entry.info.kind)
+        {
+            case StreamEntry::Kind::Nca:
+                if (!entry.ncaWriter) return false;
+                if (entry.headerPending)
+                {
+                    const auto take = static_cast<size_t>(std::min<u64>(size, tin::install::verify::SignedHeaderSize - entry.data.size()));
+                    entry.data.insert(entry.data.end(), data, data + take);
+                    entry.written += take;
+                    data += take;
+                    size -= take;
+                    if (entry.data.size() < tin::install::verify::SignedHeaderSize && entry.written < entry.info.size)
+                        return true;
+
+                    this->VerifyNcaHeader(entry);
+                    entry.headerPending = false;
+                    entry.ncaWriter->write(entry.data.data(), entry.data.size());
+                    std::vector<u8>().swap(entry.data);
+                }
+                if (size > 0)
+                {
+                    entry.ncaWriter->write(data, size);
+                    entry.written += size;
+                }
+                if (entry.written >= entry.info.size)
+                    this->CompleteNca(entry);
+                return true;
+            case StreamEntry::Kind::Ticket:
+            case StreamEntry::Kind::Cert:
+                std::memcpy(entry.data.data() + entry.written, data, static_cast<size_t>(std::min<u64>(size, entry.info.size - entry.written)));
+                break;
+            default:
+                // Non-NCA metadata payloads (eg xml) are not needed by installer logic.
+                break;
+        }
+
+        entry.written += size;
+        if (entry.written >= entry.info.size)
+        {
+            entry.complete = true;
+            if (entry.info.kind == StreamEntry::Kind::Ticket || entry.info.kind == StreamEntry::Kind::Cert)
+                this->ImportTicketPair(entry);
+        }
+        return true;
+    }
+
+    void StreamInstaller::ImportTicketPair(EntryState& entry)
+    {
+        if (entry.pair == kNoPair)
+            return;
+
+        auto& other = m_entries[entry.pair];
+        auto& ticket = entry.info.kind == StreamEntry::Kind::Ticket ? entry : other;
+        auto& cert = entry.info.kind == StreamEntry::Kind::Ticket ? other : entry;
+        if (!ticket.complete || !cert.complete || ticket.imported)
+            return;
+
+        ticket.imported = true;
+        const Result rc = esImportTicket(ticket.data.data(), ticket.data.size(), cert.data.data(), cert.data.size());
+        if (R_FAILED(rc))
+        {
+            LOG_DEBUG("Stream install: ticket import failed for %s (0x%08x)\n", ticket.info.name.c_str(), rc);
+            m_ticketFailed = true;
+        }
+
+        std::vector<u8>().swap(ticket.data);
+        std::vector<u8>().swap(cert.data);
+    }
+
+    bool StreamInstaller::PrefetchTicketCerts(ByteSource& source)
+    {
+        std::vector<EntryState*> pending;
+        for (auto& entry : m_entries)
+        {
+            if ((entry.info.kind == StreamEntry::Kind::Ticket || entry.info.kind == StreamEntry::Kind::Cert) && !entry.complete && entry.info.size > 0)
+                pending.push_back(&entry);
+        }
+
+        // Entries are sorted by offset; neighbours are read together in one request.
+        std::vector<u8> buf;
+        size_t i = 0;
+        while (i < pending.size())
+        {
+            const u64 start = pending[i]->info.offset;
+            u64 end = start + pending[i]->info.size;
+            size_t last = i + 1;
+            while (last < pending.size() && pending[last]->info.offset <= end + kMaxTicketGap)
+            {
+                end = std::max<u64>(end, pending[last]->info.offset + pending[last]->info.size);
+                last++;
+            }
+
+            buf.resize(static_cast<size_t>(end - start));
+            u64 bytesRead = 0;
+            if (R_FAILED(source.Read(buf.data(), static_cast<s64>(start), static_cast<s64>(buf.size()), &bytesRead)) || bytesRead != buf.size())
+            {
+                LOG_DEBUG("Stream install: ticket/cert prefetch failed at 0x%lx\n", start);
+                return false;
+            }
+
+            for (; i < last; i++)
+            {
+                auto& entry = *pending[i];
+                if (!this->StartEntry(entry))
+                    return false;
+                if (!this->WriteEntry(entry, buf.data() + (entry.info.offset - start), static_cast<size_t>(entry.info.size), 0))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    bool StreamInstaller::Feed(const void* buf, size_t size, u64 offset)
+    {
+        try {
+            const auto* data = static_cast<const u8*>(buf);
+            const u64 chunkStart = offset;
+            const u64 chunkEnd = offset + size;
+
+            if (m_hintIndex >= m_entries.size())
+                m_hintIndex = 0;
+            while (m_hintIndex > 0 && chunkStart < m_entries[m_hintIndex].info.offset)
+                --m_hintIndex;
+            while (m_hintIndex < m_entries.size() && chunkStart >= m_entries[m_hintIndex].info.offset + m_entries[m_hintIndex].info.size)
+                ++m_hintIndex;
+
+            for (size_t i = m_hintIndex; i < m_entries.size(); i++)
+            {
+                auto& entry = m_entries[i];
+                const u64 entryStart = entry.info.offset;
+                const u64 entryEnd = entryStart + entry.info.size;
+
+                if (chunkEnd <= entryStart) break;
+                if (chunkStart >= entryEnd) continue;
+
+                const u64 writeStart = std::max<u64>(chunkStart, entryStart);
+                const u64 writeEnd = std::min<u64>(chunkEnd, entryEnd);
+
+                if (!this->StartEntry(entry))
+                    return false;
+                if (!this->WriteEntry(entry, data + (writeStart - chunkStart), static_cast<size_t>(writeEnd - writeStart), writeStart - entryStart))
+                    return false;
+            }
+            return true;
+        } catch (std::exception& e) {
+            LOG_DEBUG("Stream install: feed failed at 0x%lx: %s\n", offset, e.what());
+            return false;
+        }
+    }
+
+    bool StreamInstaller::Pull(ByteSource& source, const ProgressFunc& progress)
+    {
+        const u64 total = this->GetTotalSize();
+        u64 processed = 0;
+        std::vector<u8> buf(kPullChunkSize);
+
+        try {
+            // Tickets are tiny; fetching them first lets them import while the NCAs stream.
+            if (!source.IsSequential())
+            {
+                if (!this->PrefetchTicketCerts(source))
+                    return false;
+            }
+
+            for (auto& entry : m_entries)
+            {
+                if (entry.complete)
+                {
+                    processed += entry.info.size;
+                    continue;
+                }
+
+                if (!this->StartEntry(entry))
+                    return false;
+
+                u64 offset = entry.info.offset;
+                u64 remaining = entry.info.size;
+                while (remaining > 0)
+                {
+                    const auto chunk = static_cast<size_t>(std::min<u64>(remaining, buf.size()));
+                    u64 bytesRead = 0;
+                    if (R_FAILED(source.Read(buf.data(), static_cast<s64>(offset), static_cast<s64>(chunk), &bytesRead)) || bytesRead == 0)
+                    {
+                        LOG_DEBUG("Stream install: source read failed for %s at 0x%lx\n", entry.info.name.c_str(), offset);
+                        return false;
+                    }
+                    if (!this->WriteEntry(entry, buf.data(), static_cast<size_t>(bytesRead), offset - entry.info.offset))
+                        return false;
+
+                    offset += bytesRead;
+                    remaining -= bytesRead;
+                    processed += bytesRead;
+                    if (progress)
+                        progress(processed, total);
+                }
+            }
+        } catch (std::exception& e) {
+            LOG_DEBUG("Stream install: pull failed: %s\n", e.what());
+            return false;
+        }
+        return true;
+    }
+
+    bool StreamInstaller::ImportTickets()
+    {
+        // Pairs normally import while streaming; this only picks up stragglers.
+        for (auto& entry : m_entries)
+        {
+            if (entry.info.kind == StreamEntry::Kind::Ticket && entry.complete && !entry.imported)
+                this->ImportTicketPair(entry);
+        }
+        return !m_ticketFailed;
+    }
+
+    bool StreamInstaller::Finalize()
+    {
+        bool ok = this->ImportTickets();
+
+        try {
+            m_helper->CommitAll();
+        } catch (std::exception& e) {
+            LOG_DEBUG("Stream install: CommitAll failed: %s\n", e.what());
+            ok = false;
+        }
+        return ok;
+    }
+
+    // Pfs0PushStream
+
+    Pfs0PushStream::Pfs0PushStream(NcmStorageId destStorageId, bool ignoreReqFirmVersion) :
+        m_installer(destStorageId, ignoreReqFirmVersion)
+    {
+    }
+
+    bool Pfs0PushStream::Feed(const void* buf, size_t size, u64 offset)
+    {
+        const auto* data = static_cast<const u8*>(buf);
+
+        if (!m_headerParsed)
+        {
+            if (offset < kMaxPushHeaderSize)
+            {
+                const auto end = std::min<u64>(offset + size, kMaxPushHeaderSize);
+                if (m_headerBytes.size() < end)
+                    m_headerBytes.resize(end);
+                std::memcpy(m_headerBytes.data() + offset, data, static_cast<size_t>(end - offset));
+            }
+
+            std::vector<StreamEntry> entries;
+            size_t headerSize = 0;
+            try {
+                if (!ParsePfs0Entries(m_headerBytes.data(), m_headerBytes.size(), entries, &headerSize))
+                {
+                    if (m_headerBytes.size() >= kMaxPushHeaderSize)
+                    {
+                        LOG_DEBUG("Stream install: PFS0 header exceeds 0x%lx bytes\n", kMaxPushHeaderSize);
+                        return false;
+                    }
+                    return true;
+                }
+            } catch (std::exception& e) {
+                LOG_DEBUG("Stream install: invalid container: %s\n", e.what());
+                return false;
+            }
+
+            for (const auto& entry : entries)
+                m_containerSize = std::max<u64>(m_containerSize, entry.offset + entry.size);
+            m_installer.SetEntries(std::move(entries));
+            m_headerParsed = true;
+
+            // Entry data that arrived alongside the header has to be replayed.
+            std::vector<u8> buffered;
+            buffered.swap(m_headerBytes);
+            if (!m_installer.Feed(buffered.data(), buffered.size(), 0))
+                return false;
+        }
+
+        return m_installer.Feed(data, size, offset);
+    }
+
+    bool Pfs0PushStream::Finalize()
+    {
+        if (!m_headerParsed || !m_installer.IsComplete())
+        {
+            LOG_DEBUG("Stream install: container ended before all entries were received\n");
+            return false;
+        }
+        return m_installer.Finalize();
+    }
+
+    bool InstallFromSource(ByteSource& source, bool isXci, NcmStorageId destStorageId, bool validateNCAs, const StreamInstaller::ProgressFunc& progress, const StreamInstaller::CnmtFunc& onCnmt)
+    {
+        std::vector<StreamEntry> entries;
+        try {
+            if (!(isXci ? ReadXciEntries(source, entries) : ReadPfs0Entries(source, entries)))
+                return false;
+        } catch (std::exception& e) {
+            LOG_DEBUG("Stream install: invalid container: %s\n", e.what());
+            return false;
+        }
+
+        StreamInstaller installer(destStorageId, inst::config::ignoreReqVers);
+        installer.SetEntries(std::move(entries));
+        installer.SetCnmtCallback(onCnmt);
+        installer.SetValidateNCAs(validateNCAs);
+        if (!installer.Pull(source, progress))
+            return false;
+        return installer.Finalize();
+    }
+
+    bool InstallNspFromHttpSequential(tin::network::HTTPDownload& download, NcmStorageId destStorageId, bool validateNCAs, const StreamInstaller::ProgressFunc& progress)
+    {
+        Pfs0PushStream stream(destStorageId, inst::config::ignoreReqVers);
+        stream.GetInstaller().SetValidateNCAs(validateNCAs);
+        u64 received = 0;
+
+        auto streamFunc = [&](u8* bytes, size_t size) -> size_t
+        {
+            // Returning a short count aborts the transfer
+            if (!stream.Feed(bytes, size, received))
+                return 0;
+            received += size;
+            if (progress && stream.IsHeaderParsed())
+                progress(std::min<u64>(received, stream.GetContainerSize()), stream.GetContainerSize());
+            return size;
+        };
+
+        if (download.StreamDataSequential(streamFunc) != 0)
+        {
+            LOG_DEBUG("Stream install: sequential download failed after 0x%lx bytes\n", received);
+            return false;
+        }
+        return stream.Finalize();
+    }
+}
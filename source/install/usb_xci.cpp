@@ -34,7 +34,7 @@ SOFTWARE.
 #include "util/util.hpp"
 #include "util/usb_comms_awoo.h"
 #include "util/lang.hpp"
-#include "ui/instPage.hpp"
+#include "ui/installProgress.hpp"
 
 namespace tin::install::xci
 {
@@ -126,54 +126,22 @@ namespace tin::install::xci
         thrd_create(&usbThread, USBThreadFunc, &args);
         thrd_create(&writeThread, USBPlaceholderWriteFunc, &args);
 
-        u64 freq = armGetSystemTickFreq();
-        u64 startTime = armGetSystemTick();
-        size_t startSizeBuffered = 0;
-        double speed = 0.0;
-
-        inst::ui::instPage::setInstBarPerc(0);
+        inst::ui::progress::Begin(inst::ui::progress::Stage::Downloading, inst::util::formatUrlString(ncaFileName), bufferedPlaceholderWriter.GetTotalDataSize());
         while (!bufferedPlaceholderWriter.IsBufferDataComplete() && !stopThreadsUsbXci)
         {
-            u64 newTime = armGetSystemTick();
-
-            if (newTime - startTime >= freq)
-            {
-                size_t newSizeBuffered = bufferedPlaceholderWriter.GetSizeBuffered();
-                double mbBuffered = (newSizeBuffered / 1000000.0) - (startSizeBuffered / 1000000.0);
-                double duration = ((double)(newTime - startTime) / (double)freq);
-                speed =  mbBuffered / duration;
-
-                startTime = newTime;
-                startSizeBuffered = newSizeBuffered;
-                int downloadProgress = (int)(((double)bufferedPlaceholderWriter.GetSizeBuffered() / (double)bufferedPlaceholderWriter.GetTotalDataSize()) * 100.0);
-                #ifdef NXLINK_DEBUG
-                    u64 totalSizeMB = bufferedPlaceholderWriter.GetTotalDataSize() / 1000000;
-                    u64 downloadSizeMB = bufferedPlaceholderWriter.GetSizeBuffered() / 1000000;
-                    LOG_DEBUG("> Download Progress: %lu/%lu MB (%i%s) (%.2f MB/s)\r", downloadSizeMB, totalSizeMB, downloadProgress, "%", speed);
-                #endif
-
-                inst::ui::instPage::setInstInfoText("inst.info_page.downloading"_lang + inst::util::formatUrlString(ncaFileName) + "inst.info_page.at"_lang + std::to_string(speed).substr(0, std::to_string(speed).size()-4) + "MB/s");
-                inst::ui::instPage::setInstBarPerc((double)downloadProgress);
-            }
+            inst::ui::progress::SetBytes(bufferedPlaceholderWriter.GetSizeBuffered());
+            inst::ui::progress::Pump();
         }
-        inst::ui::instPage::setInstBarPerc(100);
-
-        #ifdef NXLINK_DEBUG
-            u64 totalSizeMB = bufferedPlaceholderWriter.GetTotalDataSize() / 1000000;
-        #endif
+        inst::ui::progress::Finish();
+        LOG_DEBUG("> Download complete: %lu MB\n", bufferedPlaceholderWriter.GetTotalDataSize() / 1000000);
 
-        inst::ui::instPage::setInstInfoText("inst.info_page.top_info0"_lang + ncaFileName + "...");
-        inst::ui::instPage::setInstBarPerc(0);
+        inst::ui::progress::Begin(inst::ui::progress::Stage::Installing, ncaFileName, bufferedPlaceholderWriter.GetTotalDataSize());
         while (!bufferedPlaceholderWriter.IsPlaceholderComplete() && !stopThreadsUsbXci)
         {
-            int installProgress = (int)(((double)bufferedPlaceholderWriter.GetSizeWrittenToPlaceholder() / (double)bufferedPlaceholderWriter.GetTotalDataSize()) * 100.0);
-            #ifdef NXLINK_DEBUG
-                u64 installSizeMB = bufferedPlaceholderWriter.GetSizeWrittenToPlaceholder() / 1000000;
-                LOG_DEBUG("> Install Progress: %lu/%lu MB (%i%s)\r", installSizeMB, totalSizeMB, installProgress, "%");
-            #endif
-            inst::ui::instPage::setInstBarPerc((double)installProgress);
+            inst::ui::progress::SetBytes(bufferedPlaceholderWriter.GetSizeWrittenToPlaceholder());
+            inst::ui::progress::Pump();
         }
-        inst::ui::instPage::setInstBarPerc(100);
+        inst::ui::progress::Finish();
 
         thrd_join(usbThread, NULL);
         thrd_join(writeThread, NULL);
@@ -11,6 +11,7 @@
 
 #include "switch.h"
 #include <haze.hpp>
+#include <haze/threaded_file_transfer.hpp>
 
 #include "../include/mtp_install.hpp"
 #include "util/config.hpp"
@@ -365,9 +366,23 @@ struct FsInstallProxy final : FsProxyVfs {
 
         if (should_finalize) {
             CloseStreamInstall();
+            LogTransferStats();
         }
     }
 
+    static void LogTransferStats() {
+        // read stalls mean the install side could not keep up, write stalls mean USB was the bottleneck.
+        const auto stats = sphaira::thread::GetLastTransferStats();
+        LOG_DEBUG("MTP transfer: %lld bytes in %llu ms, depth %u x %llu KiB, read stall %llu ms, write stall %llu ms, max queued %u\n",
+            static_cast<long long>(stats.bytes),
+            static_cast<unsigned long long>(stats.elapsed_ns / 1000000),
+            stats.depth,
+            static_cast<unsigned long long>(stats.buffer_size / 1024),
+            static_cast<unsigned long long>(stats.read_stall_ns / 1000000),
+            static_cast<unsigned long long>(stats.write_stall_ns / 1000000),
+            stats.max_queued);
+    }
+
     bool MultiThreadTransfer(s64 /*size*/, bool read) override {
         (void)read;
         // Prefer throughput for install stream; write ordering is preserved by libhaze.
@@ -711,6 +726,11 @@ bool StartInstallServer(int storage_choice)
         g_entries.emplace_back(std::make_shared<FsAlbumProxy>());
     }
 
+    sphaira::thread::TransferConfig transfer_config{};
+    transfer_config.depth = static_cast<u32>(std::max(inst::config::mtpTransferDepth, 0));
+    transfer_config.buffer_size = static_cast<u64>(std::max(inst::config::mtpTransferBufferMb, 0)) * 0x100000;
+    sphaira::thread::SetTransferConfig(transfer_config);
+
     if (!haze::Initialize(nullptr, 0x2C, 2, g_entries, kMtpVid, kMtpPid)) {
         if (g_awoo_suspended) {
             const Result rc = awoo_usbCommsInitialize();
@@ -738,6 +758,7 @@ void StopInstallServer()
     if (!g_running) return;
     inst::mtp::CancelStreamInstall();
     haze::Exit();
+    sphaira::thread::FreeTransferBuffers();
     g_entries.clear();
     {
         std::lock_guard<std::mutex> shared_lock(g_shared.mutex);
@@ -29,6 +29,7 @@ SOFTWARE.
 #include <thread>
 #include <algorithm>
 #include <mutex>
+#include <poll.h>
 #include <switch.h>
 #include "netInstall.hpp"
 #include "install/install_nsp.hpp"
@@ -36,6 +37,8 @@ SOFTWARE.
 #include "install/install_xci.hpp"
 #include "install/http_xci.hpp"
 #include "install/install.hpp"
+#include "install/install_queue.hpp"
+#include "install/stream_install.hpp"
 #include "util/error.hpp"
 #include "util/network_util.hpp"
 #include "util/config.hpp"
@@ -44,6 +47,7 @@ SOFTWARE.
 #include "util/lang.hpp"
 #include "ui/MainApplication.hpp"
 #include "ui/instPage.hpp"
+#include "ui/installProgress.hpp"
 #include "ui/bottomHint.hpp"
 
 const unsigned int MAX_URL_SIZE = 1024;
@@ -52,6 +56,30 @@ const int REMOTE_INSTALL_PORT = 2000;
 static int m_serverSocket = 0;
 static int m_clientSocket = 0;
 
+// Push sessions share the remote install port. The PC keeps one connection open and
+// streams every file over it; TCP flow control throttles it to the install speed since
+// bytes are only received as fast as they are written to storage.
+// All fields are little-endian:
+//   sender   "HFPS" u32 version u32 fileCount
+//   receiver "HFPR" u32 status                 (after the user picked a storage)
+//   per file:
+//     sender   "FILE" u64 size u16 nameLength name
+//     receiver "RDY0" u32 status               (the file bytes follow only on PUSH_STATUS_OK)
+//     receiver "DONE" u32 status               (after the title was installed or failed)
+//   sender   "END0"
+//   receiver "BYE0" u32 status
+// "HFPS" read as a big-endian URL buffer size is far past MAX_URL_SIZE * MAX_URLS, so old
+// senders can never be mistaken for it.
+const char PUSH_HELLO_MAGIC[4] = {'H', 'F', 'P', 'S'};
+const u32 PUSH_PROTOCOL_VERSION = 1;
+const u32 PUSH_STATUS_OK = 0;
+const u32 PUSH_STATUS_BAD_VERSION = 1;
+const u32 PUSH_STATUS_DECLINED = 2;
+const u32 PUSH_STATUS_UNSUPPORTED = 3;
+const u32 PUSH_STATUS_FAILED = 4;
+const int PUSH_IDLE_TIMEOUT_MS = 30000;
+const size_t PUSH_CHUNK_SIZE = 0x100000;
+
 namespace {
     bool EnsureCurlInitialized()
     {
@@ -62,6 +90,108 @@ namespace {
         });
         return ok;
     }
+
+    // Receives exactly len bytes. Fails when the peer closes or stays silent for PUSH_IDLE_TIMEOUT_MS.
+    bool PushReceive(int sockfd, void* buf, size_t len)
+    {
+        u8* out = static_cast<u8*>(buf);
+        size_t read = 0;
+        int idleMs = 0;
+
+        while (read < len)
+        {
+            errno = 0;
+            ssize_t ret = recv(sockfd, out + read, len - read, 0);
+            if (ret > 0)
+            {
+                read += ret;
+                idleMs = 0;
+                continue;
+            }
+            if (ret == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+                return false;
+
+            struct pollfd pfd = {sockfd, POLLIN, 0};
+            if (poll(&pfd, 1, 100) == 0 && (idleMs += 100) >= PUSH_IDLE_TIMEOUT_MS)
+                return false;
+        }
+
+        return true;
+    }
+
+    bool PushSendReply(int sockfd, const char (&tag)[5], u32 status)
+    {
+        u8 reply[8];
+        std::memcpy(reply, tag, 4);
+        std::memcpy(reply + 4, &status, sizeof(status));
+        return tin::network::WaitSendNetworkData(sockfd, reply, sizeof(reply)) == sizeof(reply);
+    }
+
+    std::string PushExtension(const std::string& name)
+    {
+        auto pos = name.find_last_of('.');
+        if (pos == std::string::npos) return "";
+        auto ext = name.substr(pos);
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        return ext;
+    }
+
+    // One pushed file as a forward-only source, for containers the engine has to pull (XCI/XCZ).
+    class PushSocketSource final : public tin::install::stream::ByteSource
+    {
+        public:
+            PushSocketSource(int sockfd, u64 size) : m_sockfd(sockfd), m_size(size) {}
+
+            bool IsSequential() const override { return true; }
+
+            Result Read(void* buf, s64 off, s64 size, u64* bytes_read) override
+            {
+                *bytes_read = 0;
+                if (off < (s64)m_offset || (u64)(off + size) > m_size)
+                    return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+                if (!Skip((u64)off - m_offset) || !PushReceive(m_sockfd, buf, size))
+                {
+                    m_broken = true;
+                    return MAKERESULT(Module_Libnx, LibnxError_IoError);
+                }
+                m_offset += size;
+                *bytes_read = size;
+                return 0;
+            }
+
+            // Drops bytes up to the end of the file so the next frame header lines up
+            bool SkipToEnd()
+            {
+                return !m_broken && Skip(m_size - m_offset);
+            }
+
+            bool IsBroken() const { return m_broken; }
+
+        private:
+            bool Skip(u64 size)
+            {
+                while (size > 0)
+                {
+                    if (m_scratch.empty())
+                        m_scratch.resize(PUSH_CHUNK_SIZE);
+                    const size_t chunk = (size_t)std::min<u64>(size, m_scratch.size());
+                    if (!PushReceive(m_sockfd, m_scratch.data(), chunk))
+                    {
+                        m_broken = true;
+                        return false;
+                    }
+                    m_offset += chunk;
+                    size -= chunk;
+                }
+                return true;
+            }
+
+            int m_sockfd;
+            u64 m_size;
+            u64 m_offset = 0;
+            bool m_broken = false;
+            std::vector<u8> m_scratch;
+    };
 }
 
 namespace inst::ui {
@@ -142,7 +272,6 @@ namespace netInstStuff{
         NcmStorageId m_destStorageId = NcmStorageId_SdCard;
 
         if (ourStorage) m_destStorageId = NcmStorageId_BuiltInUser;
-        unsigned int urlItr;
 
         std::vector<std::string> urlNames;
         if (urlListAltNames.size() > 0) {
@@ -162,38 +291,71 @@ namespace netInstStuff{
             previousClockValues.push_back(inst::util::setClockSpeed(2, 1600000000)[0]);
         }
 
-        try {
-            for (urlItr = 0; urlItr < ourUrlList.size(); urlItr++) {
-                LOG_DEBUG("%s %s\n", "Install request from", ourUrlList[urlItr].c_str());
-                inst::ui::instPage::setTopInstInfoText("inst.info_page.top_info0"_lang + urlNames[urlItr] + ourSource);
-                std::unique_ptr<tin::install::Install> installTask;
-
-                if (inst::curl::downloadToBuffer(ourUrlList[urlItr], 0x100, 0x103) == "HEAD") {
-                    auto httpXCI = std::make_shared<tin::install::xci::HTTPXCI>(ourUrlList[urlItr]);
-                    installTask = std::make_unique<tin::install::xci::XCIInstallTask>(m_destStorageId, inst::config::ignoreReqVers, httpXCI);
-                } else {
-                    auto httpNSP = std::make_shared<tin::install::nsp::HTTPNSP>(ourUrlList[urlItr]);
-                    installTask = std::make_unique<tin::install::nsp::NSPInstall>(m_destStorageId, inst::config::ignoreReqVers, httpNSP);
+        std::vector<tin::install::InstallQueueItem> queueItems;
+        for (unsigned int i = 0; i < ourUrlList.size(); i++) {
+            tin::install::InstallQueueItem item;
+            item.name = urlNames[i];
+            const std::string url = ourUrlList[i];
+            // The range probe's download, handed to installDirect so the NSP isn't probed twice
+            auto probed = std::make_shared<std::unique_ptr<tin::network::HTTPDownload>>();
+            item.createTask = [url, probed, m_destStorageId]() -> std::unique_ptr<tin::install::Install> {
+                LOG_DEBUG("%s %s\n", "Install request from", url.c_str());
+                if (inst::curl::downloadToBuffer(url, 0x100, 0x103) == "HEAD") {
+                    auto httpXCI = std::make_shared<tin::install::xci::HTTPXCI>(url);
+                    return std::make_unique<tin::install::xci::XCIInstallTask>(m_destStorageId, inst::config::ignoreReqVers, httpXCI);
                 }
-
-                LOG_DEBUG("%s\n", "Preparing installation");
-                inst::ui::instPage::setInstInfoText("inst.info_page.preparing"_lang);
+                if (inst::config::httpStreamedNsp)
+                    return nullptr;
+                auto download = std::make_unique<tin::network::HTTPDownload>(url);
+                if (!download->IsRangeSupported()) {
+                    *probed = std::move(download);
+                    return nullptr;
+                }
+                auto httpNSP = std::make_shared<tin::install::nsp::HTTPNSP>(std::move(*download));
+                return std::make_unique<tin::install::nsp::NSPInstall>(m_destStorageId, inst::config::ignoreReqVers, httpNSP);
+            };
+            item.installDirect = [url, probed, displayName = urlNames[i], m_destStorageId]() {
+                std::unique_ptr<tin::network::HTTPDownload> probedDownload = std::move(*probed);
+                if (!probedDownload)
+                    probedDownload = std::make_unique<tin::network::HTTPDownload>(url);
+                tin::network::HTTPDownload& download = *probedDownload;
+                inst::ui::instPage::setInstInfoText("inst.info_page.downloading"_lang + displayName);
                 inst::ui::instPage::setInstBarPerc(0);
-                installTask->Prepare();
-                installTask->Begin();
-            }
+                int lastPercent = -1;
+                auto progress = [&lastPercent](u64 processed, u64 total) {
+                    int percent = (int)((double)processed / (double)total * 100.0);
+                    if (percent == lastPercent)
+                        return;
+                    lastPercent = percent;
+                    inst::ui::instPage::setInstBarPerc(percent);
+                };
+                if (!tin::install::stream::InstallNspFromHttpSequential(download, m_destStorageId, inst::config::validateNCAs, progress))
+                    THROW_FORMAT(("inst.net.transfer_interput"_lang).c_str());
+            };
+            queueItems.push_back(std::move(item));
         }
-        catch (std::exception& e) {
-            LOG_DEBUG("Failed to install");
-            LOG_DEBUG("%s", e.what());
-            fprintf(stdout, "%s", e.what());
-            inst::ui::instPage::setInstInfoText("inst.info_page.failed"_lang + urlNames[urlItr]);
+
+        tin::install::InstallQueueOptions queueOptions;
+        queueOptions.onTitleStart = [&](size_t index) {
+            inst::ui::instPage::setTopInstInfoText("inst.info_page.top_info0"_lang + urlNames[index] + ourSource);
+            inst::ui::instPage::setInstInfoText("inst.info_page.preparing"_lang);
+            inst::ui::instPage::setInstBarPerc(0);
+        };
+
+        std::vector<tin::install::InstallQueueFailure> failures = tin::install::RunInstallQueue(queueItems, queueOptions);
+        if (!failures.empty()) {
+            const auto& failure = failures.front();
+            fprintf(stdout, "%s", failure.error.c_str());
+            inst::ui::instPage::setInstInfoText("inst.info_page.failed"_lang + failure.name);
             inst::ui::instPage::setInstBarPerc(0);
             std::string audioPath = "romfs:/audio/bark.wav";
             if (!inst::config::soundEnabled) audioPath = "";
             if (std::filesystem::exists(inst::config::appDir + "/bark.wav")) audioPath = inst::config::appDir + "/bark.wav";
             std::thread audioThread(inst::util::playAudio,audioPath);
-            inst::ui::mainApp->CreateShowDialog("inst.info_page.failed"_lang + urlNames[urlItr] + "!", "inst.info_page.failed_desc"_lang + "\n\n" + (std::string)e.what(), {"common.ok"_lang}, true);
+            std::string failureDesc = "inst.info_page.failed_desc"_lang + "\n\n" + failure.error;
+            for (size_t i = 1; i < failures.size(); i++)
+                failureDesc += "\n" + failures[i].name;
+            inst::ui::mainApp->CreateShowDialog("inst.info_page.failed"_lang + failure.name + "!", failureDesc, {"common.ok"_lang}, true);
             audioThread.join();
             nspInstalled = false;
         }
@@ -225,6 +387,209 @@ namespace netInstStuff{
         return;
     }
 
+    enum class PushFileResult { Installed, Failed, Disconnected };
+
+    // Receives one file of a push session and installs it while it arrives.
+    // A title that fails to install is drained to its end so the session can go on.
+    PushFileResult ReceivePushFile(const std::string& displayName, u64 size, bool isXci, NcmStorageId destStorageId, std::string& error)
+    {
+        // Receiving and writing both run on this thread, so only render when a frame is due
+        inst::ui::progress::Begin(inst::ui::progress::Stage::Downloading, displayName, size);
+        inst::ui::progress::Render(true);
+        auto progress = [](u64 processed, u64 total) {
+            inst::ui::progress::SetTotal(total);
+            inst::ui::progress::SetBytes(processed);
+            inst::ui::progress::Render();
+        };
+
+        bool installed = true;
+        if (isXci)
+        {
+            PushSocketSource source(m_clientSocket, size);
+            try
+            {
+                installed = tin::install::stream::InstallFromSource(source, true, destStorageId, inst::config::validateNCAs, progress);
+            }
+            catch (std::exception& e)
+            {
+                error = e.what();
+                installed = false;
+            }
+            if (!source.SkipToEnd())
+                return PushFileResult::Disconnected;
+        }
+        else
+        {
+            tin::install::stream::Pfs0PushStream stream(destStorageId, inst::config::ignoreReqVers);
+            stream.GetInstaller().SetValidateNCAs(inst::config::validateNCAs);
+            auto buf = std::make_unique<u8[]>(PUSH_CHUNK_SIZE);
+            u64 received = 0;
+            while (received < size)
+            {
+                const size_t chunk = (size_t)std::min<u64>(size - received, PUSH_CHUNK_SIZE);
+                if (!PushReceive(m_clientSocket, buf.get(), chunk))
+                    return PushFileResult::Disconnected;
+                if (installed)
+                {
+                    try
+                    {
+                        installed = stream.Feed(buf.get(), chunk, received);
+                    }
+                    catch (std::exception& e)
+                    {
+                        error = e.what();
+                        installed = false;
+                    }
+                }
+                received += chunk;
+                progress(received, size);
+            }
+            try
+            {
+                installed = installed && stream.Finalize();
+            }
+            catch (std::exception& e)
+            {
+                error = e.what();
+                installed = false;
+            }
+        }
+
+        inst::ui::progress::Finish();
+        return installed ? PushFileResult::Installed : PushFileResult::Failed;
+    }
+
+    void installTitlePush(int ourStorage)
+    {
+        if (ourStorage < 0)
+        {
+            PushSendReply(m_clientSocket, "HFPR", PUSH_STATUS_DECLINED);
+            OnUnwound();
+            return;
+        }
+
+        inst::util::initInstallServices();
+        inst::ui::instPage::loadInstallScreen();
+        NcmStorageId m_destStorageId = NcmStorageId_SdCard;
+
+        if (ourStorage) m_destStorageId = NcmStorageId_BuiltInUser;
+
+        std::vector<int> previousClockValues;
+        if (inst::config::overClock) {
+            previousClockValues.push_back(inst::util::setClockSpeed(0, 1785000000)[0]);
+            previousClockValues.push_back(inst::util::setClockSpeed(1, 76800000)[0]);
+            previousClockValues.push_back(inst::util::setClockSpeed(2, 1600000000)[0]);
+        }
+
+        std::vector<std::string> installedNames;
+        std::vector<tin::install::InstallQueueFailure> failures;
+        bool connected = PushSendReply(m_clientSocket, "HFPR", PUSH_STATUS_OK);
+
+        while (connected)
+        {
+            char tag[4];
+            if (!PushReceive(m_clientSocket, tag, sizeof(tag)))
+                break;
+            if (!std::memcmp(tag, "END0", sizeof(tag)))
+            {
+                PushSendReply(m_clientSocket, "BYE0", PUSH_STATUS_OK);
+                break;
+            }
+
+            u64 fileSize = 0;
+            u16 nameLength = 0;
+            if (std::memcmp(tag, "FILE", sizeof(tag)) || !PushReceive(m_clientSocket, &fileSize, sizeof(fileSize)) || !PushReceive(m_clientSocket, &nameLength, sizeof(nameLength)) || nameLength > MAX_URL_SIZE)
+            {
+                LOG_DEBUG("Push session: malformed file header\n");
+                connected = false;
+                break;
+            }
+            std::string fileName(nameLength, '\0');
+            if (!PushReceive(m_clientSocket, fileName.data(), nameLength))
+            {
+                connected = false;
+                break;
+            }
+
+            const std::string displayName = inst::util::shortenString(fileName, 38, true);
+            const std::string ext = PushExtension(fileName);
+            const bool isXci = ext == ".xci" || ext == ".xcz";
+            if (!fileSize || (!isXci && ext != ".nsp" && ext != ".nsz"))
+            {
+                LOG_DEBUG("Push session: skipping %s\n", fileName.c_str());
+                failures.push_back({failures.size() + installedNames.size(), displayName, ""});
+                connected = PushSendReply(m_clientSocket, "RDY0", PUSH_STATUS_UNSUPPORTED);
+                continue;
+            }
+
+            inst::ui::instPage::setTopInstInfoText("inst.info_page.top_info0"_lang + displayName + "inst.net.source_string"_lang);
+            if (!PushSendReply(m_clientSocket, "RDY0", PUSH_STATUS_OK))
+            {
+                connected = false;
+                break;
+            }
+
+            LOG_DEBUG("Push session: receiving %s (0x%lx bytes)\n", fileName.c_str(), fileSize);
+            std::string error;
+            const PushFileResult result = ReceivePushFile(displayName, fileSize, isXci, m_destStorageId, error);
+            if (result == PushFileResult::Disconnected)
+            {
+                failures.push_back({failures.size() + installedNames.size(), displayName, "inst.net.transfer_interput"_lang});
+                connected = false;
+                break;
+            }
+            if (result == PushFileResult::Installed)
+                installedNames.push_back(displayName);
+            else
+                failures.push_back({failures.size() + installedNames.size(), displayName, error});
+            connected = PushSendReply(m_clientSocket, "DONE", result == PushFileResult::Installed ? PUSH_STATUS_OK : PUSH_STATUS_FAILED);
+        }
+
+        // A session that dropped before its "END0" lost whatever was still queued on the PC
+        if (!connected && failures.empty())
+            failures.push_back({installedNames.size(), "inst.net.source_string"_lang, "inst.net.transfer_interput"_lang});
+
+        if (previousClockValues.size() > 0) {
+            inst::util::setClockSpeed(0, previousClockValues[0]);
+            inst::util::setClockSpeed(1, previousClockValues[1]);
+            inst::util::setClockSpeed(2, previousClockValues[2]);
+        }
+
+        OnUnwound();
+
+        if (!failures.empty()) {
+            const auto& failure = failures.front();
+            fprintf(stdout, "%s", failure.error.c_str());
+            inst::ui::instPage::setInstInfoText("inst.info_page.failed"_lang + failure.name);
+            inst::ui::instPage::setInstBarPerc(0);
+            std::string audioPath = "romfs:/audio/bark.wav";
+            if (!inst::config::soundEnabled) audioPath = "";
+            if (std::filesystem::exists(inst::config::appDir + "/bark.wav")) audioPath = inst::config::appDir + "/bark.wav";
+            std::thread audioThread(inst::util::playAudio,audioPath);
+            std::string failureDesc = "inst.info_page.failed_desc"_lang;
+            if (!failure.error.empty())
+                failureDesc += "\n\n" + failure.error;
+            for (size_t i = 1; i < failures.size(); i++)
+                failureDesc += "\n" + failures[i].name;
+            inst::ui::mainApp->CreateShowDialog("inst.info_page.failed"_lang + failure.name + "!", failureDesc, {"common.ok"_lang}, true);
+            audioThread.join();
+        } else if (!installedNames.empty()) {
+            inst::ui::instPage::setInstInfoText("inst.info_page.complete"_lang);
+            inst::ui::instPage::setInstBarPerc(100);
+            std::string audioPath = "romfs:/audio/success.wav";
+            if (!inst::config::soundEnabled) audioPath = "";
+            if (std::filesystem::exists(inst::config::appDir + "/success.wav")) audioPath = inst::config::appDir + "/success.wav";
+            std::thread audioThread(inst::util::playAudio,audioPath);
+            if (installedNames.size() > 1) inst::ui::mainApp->CreateShowDialog(std::to_string(installedNames.size()) + "inst.info_page.desc0"_lang, Language::GetRandomMsg(), {"common.ok"_lang}, true);
+            else inst::ui::mainApp->CreateShowDialog(installedNames[0] + "inst.info_page.desc1"_lang, Language::GetRandomMsg(), {"common.ok"_lang}, true);
+            audioThread.join();
+        }
+
+        LOG_DEBUG("Push session done: %zu installed, %zu failed\n", installedNames.size(), failures.size());
+        inst::ui::instPage::loadMainMenu();
+        inst::util::deinitInstallServices();
+    }
+
     std::vector<std::string> OnSelected()
     {
         u64 freq = armGetSystemTickFreq();
@@ -305,6 +670,26 @@ namespace netInstStuff{
                     LOG_DEBUG("%s\n", "Server accepted");
                     u32 size = 0;
                     tin::network::WaitReceiveNetworkData(m_clientSocket, &size, sizeof(u32));
+
+                    if (!std::memcmp(&size, PUSH_HELLO_MAGIC, sizeof(size)))
+                    {
+                        u32 hello[2] = {0, 0};
+                        if (!PushReceive(m_clientSocket, hello, sizeof(hello)))
+                        {
+                            THROW_FORMAT(("inst.net.transfer_interput"_lang).c_str());
+                        }
+                        LOG_DEBUG("Push session: version %u, %u files\n", hello[0], hello[1]);
+
+                        if (hello[0] != PUSH_PROTOCOL_VERSION || !hello[1] || hello[1] > MAX_URLS)
+                        {
+                            PushSendReply(m_clientSocket, "HFPR", PUSH_STATUS_BAD_VERSION);
+                            OnUnwound();
+                            THROW_FORMAT("Unsupported push session (version %u, %u files)\n", hello[0], hello[1]);
+                        }
+
+                        return {"pushSession", std::to_string(hello[1])};
+                    }
+
                     size = ntohl(size);
 
                     LOG_DEBUG("Received url buf size: 0x%x\n", size);
@@ -461,6 +461,7 @@ u64 NcaWriter::write(const  u8* ptr, u64 sz)
                     if (*(u64*)ptr == NczHeader::MAGIC)
                     {
                          m_writer = std::shared_ptr<NcaBodyWriter>(new NczBodyWriter(m_ncaId, m_buffer.size(), m_contentStorage));
+                         m_compressed = true;
                     }
                     else
                     {
@@ -486,12 +487,29 @@ u64 NcaWriter::write(const  u8* ptr, u64 sz)
      return sz;
 }
 
+void NcaWriter::resume(u64 offset)
+{
+     if (offset < NCA_HEADER_SIZE)
+     {
+          THROW_FORMAT("cannot resume inside the nca header");
+     }
+
+     m_buffer.resize(NCA_HEADER_SIZE);
+     m_writer = std::shared_ptr<NcaBodyWriter>(new NcaBodyWriter(m_ncaId, offset, m_contentStorage));
+     m_compressed = false;
+}
+
+bool NcaWriter::isCompressed() const
+{
+     return m_compressed;
+}
+
 void NcaWriter::flushHeader()
 {
      tin::install::NcaHeader header;
      memcpy(&header, m_buffer.data(), sizeof(header));
-     Crypto::AesXtr decryptor(Crypto::Keys().headerKey, false);
-     Crypto::AesXtr encryptor(Crypto::Keys().headerKey, true);
+     Crypto::AesXtr decryptor = Crypto::HeaderCipher(false);
+     Crypto::AesXtr encryptor = Crypto::HeaderCipher(true);
      decryptor.decrypt(&header, &header, sizeof(header), 0, 0x200);
 
      if (header.magic == MAGIC_NCA3)
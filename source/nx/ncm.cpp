@@ -45,6 +45,13 @@ namespace nx::ncm
         ASSERT_OK(ncmContentStorageDeletePlaceHolder(&m_contentStorage, &placeholderId), "Failed to delete placeholder");
     }
 
+    bool ContentStorage::HasPlaceholder(const NcmPlaceHolderId &placeholderId)
+    {
+        bool hasPlaceholder = false;
+        ASSERT_OK(ncmContentStorageHasPlaceHolder(&m_contentStorage, &hasPlaceholder, &placeholderId), "Failed to check if placeholder is present");
+        return hasPlaceholder;
+    }
+
     void ContentStorage::WritePlaceholder(const NcmPlaceHolderId &placeholderId, u64 offset, void *buffer, size_t bufSize)
     {
         ASSERT_OK(ncmContentStorageWritePlaceHolder(&m_contentStorage, &placeholderId, offset, buffer, bufSize), "Failed to write to placeholder");
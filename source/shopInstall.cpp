@@ -15,8 +15,9 @@
 #include "install/http_xci.hpp"
 #include "install/install.hpp"
 #include "install/install_nsp.hpp"
+#include "install/install_queue.hpp"
 #include "install/install_xci.hpp"
-#include "nx/nca_writer.h"
+#include "install/stream_install.hpp"
 #include "util/file_util.hpp"
 #include "util/offline_title_db.hpp"
 #include "util/title_util.hpp"
@@ -1251,330 +1252,73 @@ namespace shopInstStuff {
     }
 
     namespace {
-        class StreamInstallHelper final : public tin::install::Install {
-        public:
-            StreamInstallHelper(NcmStorageId dest_storage, bool ignore_req)
-                : Install(dest_storage, ignore_req) {}
-
-            void AddContentMeta(const nx::ncm::ContentMeta& meta, const NcmContentInfo& info) {
-                m_contentMeta.push_back(meta);
-                m_cnmt_infos.push_back(info);
-            }
-
-            void CommitLatest() {
-                if (m_contentMeta.empty()) return;
-                const size_t idx = m_contentMeta.size() - 1;
-                tin::data::ByteBuffer install_buf;
-                m_contentMeta[idx].GetInstallContentMeta(install_buf, m_cnmt_infos[idx], m_ignoreReqFirmVersion);
-                InstallContentMetaRecords(install_buf, idx);
-                InstallApplicationRecord(idx);
-            }
-
-            void CommitAll() {
-                for (size_t i = 0; i < m_contentMeta.size(); i++) {
-                    tin::data::ByteBuffer install_buf;
-                    m_contentMeta[i].GetInstallContentMeta(install_buf, m_cnmt_infos[i], m_ignoreReqFirmVersion);
-                    InstallContentMetaRecords(install_buf, i);
-                    InstallApplicationRecord(i);
-                }
-            }
-
-        private:
-            std::vector<NcmContentInfo> m_cnmt_infos;
-            std::vector<std::tuple<nx::ncm::ContentMeta, NcmContentInfo>> ReadCNMT() override { return {}; }
-            void InstallTicketCert() override {}
-            void InstallNCA(const NcmContentId& /*ncaId*/) override {}
-        };
-
-        class HttpStreamSource {
-        public:
-            explicit HttpStreamSource(tin::network::HTTPDownload& download) : m_download(download) {}
+        static tin::install::stream::StreamInstaller::ProgressFunc MakeDownloadProgress() {
+            const u64 freq = armGetSystemTickFreq();
+            u64 lastTick = armGetSystemTick();
+            u64 lastProcessed = 0;
 
-            Result Read(void* buf, s64 off, s64 size, u64* bytes_read) {
-                if (off < 0 || size <= 0) return MAKERESULT(Module_Libnx, LibnxError_BadInput);
-                const size_t req_size = static_cast<size_t>(size);
-                const size_t req_off = static_cast<size_t>(off);
+            return [=](u64 processedBytes, u64 totalBytes) mutable {
+                const u64 now = armGetSystemTick();
+                if (now - lastTick < (freq / 2))
+                    return;
 
-                if (!m_cache.empty() && req_off >= m_cache_start && (req_off + req_size) <= m_cache_end) {
-                    const size_t rel = req_off - m_cache_start;
-                    std::memcpy(buf, m_cache.data() + rel, req_size);
-                    *bytes_read = static_cast<u64>(size);
-                    return 0;
+                double speed = 0.0;
+                double speedBytesPerSec = 0.0;
+                if (processedBytes > lastProcessed) {
+                    double deltaMb = (processedBytes - lastProcessed) / 1000000.0;
+                    double deltaSec = (double)(now - lastTick) / (double)freq;
+                    if (deltaSec > 0.0) {
+                        speed = deltaMb / deltaSec;
+                        speedBytesPerSec = (double)(processedBytes - lastProcessed) / deltaSec;
+                    }
                 }
+                lastTick = now;
+                lastProcessed = processedBytes;
 
-                const size_t fetch_size = std::max(req_size, kReadAheadSize);
-                m_cache.resize(fetch_size);
-                m_download.BufferDataRange(m_cache.data(), req_off, fetch_size, nullptr);
-                m_cache_start = req_off;
-                m_cache_end = req_off + fetch_size;
-
-                std::memcpy(buf, m_cache.data(), req_size);
-                *bytes_read = static_cast<u64>(size);
-                return 0;
-            }
-
-        private:
-            static constexpr size_t kReadAheadSize = 16 * 1024 * 1024;
-            tin::network::HTTPDownload& m_download;
-            std::vector<std::uint8_t> m_cache;
-            size_t m_cache_start = 0;
-            size_t m_cache_end = 0;
-        };
-
-        struct StreamHfs0Header {
-            u32 magic;
-            u32 total_files;
-            u32 string_table_size;
-            u32 padding;
-        };
-
-        struct StreamHfs0FileTableEntry {
-            u64 data_offset;
-            u64 data_size;
-            u32 name_offset;
-            u32 hash_size;
-            u64 padding;
-            u8 hash[0x20];
-        };
-
-        struct StreamHfs0 {
-            StreamHfs0Header header{};
-            std::vector<StreamHfs0FileTableEntry> file_table{};
-            std::vector<std::string> string_table{};
-            s64 data_offset{};
-        };
-
-        struct StreamCollectionEntry {
-            std::string name;
-            u64 offset{};
-            u64 size{};
-        };
-
-        static bool ReadHfs0Partition(HttpStreamSource& source, s64 off, StreamHfs0& out) {
-            u64 bytes_read = 0;
-            if (R_FAILED(source.Read(&out.header, off, sizeof(out.header), &bytes_read))) return false;
-            if (out.header.magic != 0x30534648) return false;
-            if (out.header.total_files == 0 || out.header.total_files > 0x4000) return false;
-            if (out.header.string_table_size > (256 * 1024)) return false;
-            off += bytes_read;
-
-            out.file_table.resize(out.header.total_files);
-            const auto file_table_size = static_cast<s64>(out.file_table.size() * sizeof(StreamHfs0FileTableEntry));
-            if (file_table_size > (4 * 1024 * 1024)) return false;
-            if (R_FAILED(source.Read(out.file_table.data(), off, file_table_size, &bytes_read))) return false;
-            off += bytes_read;
-
-            std::vector<char> string_table(out.header.string_table_size);
-            if (R_FAILED(source.Read(string_table.data(), off, string_table.size(), &bytes_read))) return false;
-            off += bytes_read;
-
-            out.string_table.clear();
-            out.string_table.reserve(out.header.total_files);
-            for (u32 i = 0; i < out.header.total_files; i++) {
-                out.string_table.emplace_back(string_table.data() + out.file_table[i].name_offset);
-            }
-
-            out.data_offset = off;
-            return true;
-        }
+                if (totalBytes > 0) {
+                    int progress = (int)((double)processedBytes / (double)totalBytes * 100.0);
+                    inst::ui::instPage::setInstBarPerc(progress);
 
-        static bool GetXciCollections(HttpStreamSource& source, std::vector<StreamCollectionEntry>& out) {
-            StreamHfs0 root{};
-            s64 root_offset = 0xF000;
-            if (!ReadHfs0Partition(source, root_offset, root)) {
-                root_offset = 0x10000;
-                if (!ReadHfs0Partition(source, root_offset, root)) {
-                    return false;
-                }
-            }
+                    std::string etaText = "--:--";
+                    if (speedBytesPerSec > 0.0 && processedBytes < totalBytes) {
+                        const auto etaSeconds = static_cast<std::uint64_t>((double)(totalBytes - processedBytes) / speedBytesPerSec);
+                        etaText = FormatEta(etaSeconds);
+                    }
 
-            for (u32 i = 0; i < root.header.total_files; i++) {
-                if (root.string_table[i] != "secure") continue;
-
-                StreamHfs0 secure{};
-                const auto secure_offset = root.data_offset + static_cast<s64>(root.file_table[i].data_offset);
-                if (!ReadHfs0Partition(source, secure_offset, secure)) return false;
-
-                out.clear();
-                out.reserve(secure.header.total_files);
-                for (u32 j = 0; j < secure.header.total_files; j++) {
-                    StreamCollectionEntry entry;
-                    entry.name = secure.string_table[j];
-                    entry.offset = static_cast<u64>(secure.data_offset + static_cast<s64>(secure.file_table[j].data_offset));
-                    entry.size = secure.file_table[j].data_size;
-                    out.emplace_back(std::move(entry));
+                    inst::ui::instPage::setInstInfoText("inst.info_page.downloading"_lang + FormatOneDecimal(speed) + "MB/s");
+                    inst::ui::instPage::setProgressDetailText(
+                        "Downloaded " + FormatOneDecimal((double)processedBytes / 1000000.0) + " / " +
+                        FormatOneDecimal((double)totalBytes / 1000000.0) + " MB (" +
+                        std::to_string(progress) + "%) • ETA " + etaText
+                    );
                 }
-                return true;
-            }
-
-            return false;
+            };
         }
 
         static bool InstallXciHttpStream(const std::string& url, NcmStorageId dest_storage) {
             tin::network::HTTPDownload download(url);
-            HttpStreamSource source(download);
-
-            std::vector<StreamCollectionEntry> collections;
-            if (!GetXciCollections(source, collections)) return false;
+            tin::install::stream::HttpByteSource source(download);
 
-            u64 totalBytes = 0;
-            for (const auto& c : collections) {
-                totalBytes += c.size;
-            }
-            u64 processedBytes = 0;
-            u64 lastTick = armGetSystemTick();
-            u64 lastProcessed = 0;
-            const u64 freq = armGetSystemTickFreq();
             inst::ui::instPage::setInstInfoText("inst.info_page.preparing"_lang);
             inst::ui::instPage::setInstBarPerc(0);
 
-            std::sort(collections.begin(), collections.end(), [](const auto& a, const auto& b) {
-                return a.offset < b.offset;
-            });
-
-            struct EntryState {
-                std::string name;
-                NcmContentId nca_id{};
-                std::uint64_t size = 0;
-                std::uint64_t written = 0;
-                bool started = false;
-                bool complete = false;
-                bool is_nca = false;
-                bool is_cnmt = false;
-                std::shared_ptr<nx::ncm::ContentStorage> storage;
-                std::unique_ptr<NcaWriter> nca_writer;
-                std::vector<std::uint8_t> ticket_buf;
-                std::vector<std::uint8_t> cert_buf;
-            };
-
-            auto ensureStarted = [&](EntryState& entry) {
-                if (entry.started) return true;
-                if (!entry.is_nca) {
-                    entry.started = true;
-                    return true;
-                }
-                entry.storage = std::make_shared<nx::ncm::ContentStorage>(dest_storage);
-                try { entry.storage->DeletePlaceholder(*(NcmPlaceHolderId*)&entry.nca_id); } catch (...) {}
-                entry.nca_writer = std::make_unique<NcaWriter>(entry.nca_id, entry.storage);
-                entry.started = true;
-                return true;
-            };
-
-            StreamInstallHelper helper(dest_storage, inst::config::ignoreReqVers);
-
-            std::unordered_map<std::string, EntryState> entries;
-            entries.reserve(collections.size());
-
-            std::vector<std::uint8_t> buf(0x800000);
-            for (const auto& collection : collections) {
-                EntryState entry;
-                entry.name = collection.name;
-                entry.size = collection.size;
-                entry.is_nca = entry.name.find(".nca") != std::string::npos || entry.name.find(".ncz") != std::string::npos;
-                entry.is_cnmt = entry.name.find(".cnmt.nca") != std::string::npos || entry.name.find(".cnmt.ncz") != std::string::npos;
-                if (entry.is_nca && entry.name.size() >= 32) {
-                    entry.nca_id = tin::util::GetNcaIdFromString(entry.name.substr(0, 32));
-                }
-
-                if (!ensureStarted(entry)) return false;
-
-                u64 remaining = collection.size;
-                u64 offset = collection.offset;
-                while (remaining > 0) {
-                    const auto chunk = static_cast<size_t>(std::min<u64>(remaining, buf.size()));
-                    u64 bytes_read = 0;
-                    if (R_FAILED(source.Read(buf.data(), static_cast<s64>(offset), static_cast<s64>(chunk), &bytes_read))) {
-                        return false;
-                    }
-                    if (bytes_read == 0) return false;
-
-                    if (entry.name.find(".tik") != std::string::npos) {
-                        entry.ticket_buf.insert(entry.ticket_buf.end(), buf.data(), buf.data() + bytes_read);
-                        entry.written += bytes_read;
-                        if (entry.written >= entry.size) entry.complete = true;
-                    } else if (entry.name.find(".cert") != std::string::npos) {
-                        entry.cert_buf.insert(entry.cert_buf.end(), buf.data(), buf.data() + bytes_read);
-                        entry.written += bytes_read;
-                        if (entry.written >= entry.size) entry.complete = true;
-                    } else if (entry.is_nca && entry.nca_writer) {
-                        entry.nca_writer->write(buf.data(), bytes_read);
-                        entry.written += bytes_read;
-                        if (entry.written >= entry.size) {
-                            entry.nca_writer->close();
-                            try {
-                                entry.storage->Register(*(NcmPlaceHolderId*)&entry.nca_id, entry.nca_id);
-                                entry.storage->DeletePlaceholder(*(NcmPlaceHolderId*)&entry.nca_id);
-                            } catch (...) {}
-                            entry.complete = true;
-                            if (entry.is_cnmt) {
-                                try {
-                                    std::string cnmt_path = entry.storage->GetPath(entry.nca_id);
-                                    nx::ncm::ContentMeta meta = tin::util::GetContentMetaFromNCA(cnmt_path);
-                                    NcmContentInfo cnmt_info{};
-                                    cnmt_info.content_id = entry.nca_id;
-                                    ncmU64ToContentInfoSize(entry.size & 0xFFFFFFFFFFFF, &cnmt_info);
-                                    cnmt_info.content_type = NcmContentType_Meta;
-                                    helper.AddContentMeta(meta, cnmt_info);
-                                    helper.CommitLatest();
-                                } catch (...) {}
-                            }
-                        }
-                    }
-
-                    offset += bytes_read;
-                    remaining -= bytes_read;
-                    processedBytes += bytes_read;
-
-                    const u64 now = armGetSystemTick();
-                    if (now - lastTick >= (freq / 2)) {
-                        double speed = 0.0;
-                        double speedBytesPerSec = 0.0;
-                        if (processedBytes > lastProcessed) {
-                            double deltaMb = (processedBytes - lastProcessed) / 1000000.0;
-                            double deltaSec = (double)(now - lastTick) / (double)freq;
-                            if (deltaSec > 0.0) {
-                                speed = deltaMb / deltaSec;
-                                speedBytesPerSec = (double)(processedBytes - lastProcessed) / deltaSec;
-                            }
-                        }
-                        lastTick = now;
-                        lastProcessed = processedBytes;
-
-                        if (totalBytes > 0) {
-                            int progress = (int)((double)processedBytes / (double)totalBytes * 100.0);
-                            inst::ui::instPage::setInstBarPerc(progress);
-
-                            std::string etaText = "--:--";
-                            if (speedBytesPerSec > 0.0 && processedBytes < totalBytes) {
-                                const auto etaSeconds = static_cast<std::uint64_t>((double)(totalBytes - processedBytes) / speedBytesPerSec);
-                                etaText = FormatEta(etaSeconds);
-                            }
+            if (!tin::install::stream::InstallFromSource(source, true, dest_storage, inst::config::validateNCAs, MakeDownloadProgress()))
+                return false;
 
-                            inst::ui::instPage::setInstInfoText("inst.info_page.downloading"_lang + FormatOneDecimal(speed) + "MB/s");
-                            inst::ui::instPage::setProgressDetailText(
-                                "Downloaded " + FormatOneDecimal((double)processedBytes / 1000000.0) + " / " +
-                                FormatOneDecimal((double)totalBytes / 1000000.0) + " MB (" +
-                                std::to_string(progress) + "%) • ETA " + etaText
-                            );
-                        }
-                    }
-                }
+            inst::ui::instPage::setInstBarPerc(100);
+            inst::ui::instPage::setProgressDetailText("Downloaded 100% • Verifying and installing...");
+            return true;
+        }
 
-                entries.emplace(entry.name, std::move(entry));
-            }
+        // Single GET, entries are installed as their bytes arrive. Used when the
+        // server can't serve ranges or when random access is disabled in config.
+        static bool InstallNspHttpSequential(tin::network::HTTPDownload& download, NcmStorageId dest_storage) {
+            inst::ui::instPage::setInstInfoText("inst.info_page.preparing"_lang);
+            inst::ui::instPage::setInstBarPerc(0);
 
-            for (auto& [name, entry] : entries) {
-                if (entry.name.find(".tik") != std::string::npos) {
-                    const auto base = entry.name.substr(0, entry.name.size() - 4);
-                    auto it = entries.find(base + ".cert");
-                    if (it != entries.end() && !entry.ticket_buf.empty() && !it->second.cert_buf.empty()) {
-                        ASSERT_OK(esImportTicket(entry.ticket_buf.data(), entry.ticket_buf.size(), it->second.cert_buf.data(), it->second.cert_buf.size()),
-                            "Failed to import ticket");
-                    }
-                }
-            }
+            if (!tin::install::stream::InstallNspFromHttpSequential(download, dest_storage, inst::config::validateNCAs, MakeDownloadProgress()))
+                return false;
 
-            helper.CommitAll();
             inst::ui::instPage::setInstBarPerc(100);
             inst::ui::instPage::setProgressDetailText("Downloaded 100% • Verifying and installing...");
             return true;
@@ -1631,45 +1375,69 @@ namespace shopInstStuff {
         else
             tin::network::ClearBasicAuth();
 
-        std::string currentName;
-        try {
-            for (size_t i = 0; i < items.size(); i++) {
-                LOG_DEBUG("%s %s\n", "Install request from", items[i].url.c_str());
-                currentName = names[i];
-                UpdateInstallIcon(items[i]);
-                inst::ui::instPage::setTopInstInfoText("inst.info_page.top_info0"_lang + currentName + sourceLabel);
-                std::unique_ptr<tin::install::Install> installTask;
-                bool isXci = IsXciExtension(items[i].name) || IsXciExtension(items[i].url) || IsXciMagic(items[i].url);
-                if (isXci) {
+        std::vector<tin::install::InstallQueueItem> queueItems;
+        for (size_t i = 0; i < items.size(); i++) {
+            tin::install::InstallQueueItem queueItem;
+            queueItem.name = names[i];
+            const std::string url = items[i].url;
+            const std::string itemName = items[i].name;
+            // Decided once by createTask (possibly on the prefetch thread) and read by installDirect
+            auto isXci = std::make_shared<bool>(false);
+            // The range probe's download, handed to installDirect so the NSP isn't probed twice
+            auto probed = std::make_shared<std::unique_ptr<tin::network::HTTPDownload>>();
+            queueItem.createTask = [url, itemName, isXci, probed, destStorageId]() -> std::unique_ptr<tin::install::Install> {
+                LOG_DEBUG("%s %s\n", "Install request from", url.c_str());
+                *isXci = IsXciExtension(itemName) || IsXciExtension(url) || IsXciMagic(url);
+                if (*isXci || inst::config::httpStreamedNsp)
+                    return nullptr;
+                auto download = std::make_unique<tin::network::HTTPDownload>(url);
+                if (!download->IsRangeSupported()) {
+                    *probed = std::move(download);
+                    return nullptr;
+                }
+                auto httpNSP = std::make_shared<tin::install::nsp::HTTPNSP>(std::move(*download));
+                return std::make_unique<tin::install::nsp::NSPInstall>(destStorageId, inst::config::ignoreReqVers, httpNSP);
+            };
+            queueItem.installDirect = [url, isXci, probed, destStorageId]() {
+                if (*isXci) {
                     inst::ui::instPage::setInstInfoText("inst.info_page.preparing"_lang);
-                    if (!InstallXciHttpStream(items[i].url, destStorageId)) {
+                    if (!InstallXciHttpStream(url, destStorageId)) {
                         THROW_FORMAT("Failed to install XCI from shop.");
                     }
-                    continue;
-                } else {
-                    auto httpNSP = std::make_shared<tin::install::nsp::HTTPNSP>(items[i].url);
-                    installTask = std::make_unique<tin::install::nsp::NSPInstall>(destStorageId, inst::config::ignoreReqVers, httpNSP);
+                    return;
                 }
-
-                LOG_DEBUG("%s\n", "Preparing installation");
-                inst::ui::instPage::setInstInfoText("inst.info_page.preparing"_lang);
-                inst::ui::instPage::setInstBarPerc(0);
-                installTask->Prepare();
-                installTask->Begin();
-            }
+                std::unique_ptr<tin::network::HTTPDownload> download = std::move(*probed);
+                if (!download)
+                    download = std::make_unique<tin::network::HTTPDownload>(url);
+                if (!InstallNspHttpSequential(*download, destStorageId)) {
+                    THROW_FORMAT("Failed to install NSP from shop.");
+                }
+            };
+            queueItems.push_back(std::move(queueItem));
         }
-        catch (std::exception& e) {
-            LOG_DEBUG("Failed to install");
-            LOG_DEBUG("%s", e.what());
-            fprintf(stdout, "%s", e.what());
-            std::string failedName = currentName.empty() ? names.front() : currentName;
-            inst::ui::instPage::setInstInfoText("inst.info_page.failed"_lang + failedName);
+
+        tin::install::InstallQueueOptions queueOptions;
+        queueOptions.onTitleStart = [&](size_t index) {
+            UpdateInstallIcon(items[index]);
+            inst::ui::instPage::setTopInstInfoText("inst.info_page.top_info0"_lang + names[index] + sourceLabel);
+            inst::ui::instPage::setInstInfoText("inst.info_page.preparing"_lang);
+            inst::ui::instPage::setInstBarPerc(0);
+        };
+
+        std::vector<tin::install::InstallQueueFailure> failures = tin::install::RunInstallQueue(queueItems, queueOptions);
+        if (!failures.empty()) {
+            const auto& failure = failures.front();
+            fprintf(stdout, "%s", failure.error.c_str());
+            inst::ui::instPage::setInstInfoText("inst.info_page.failed"_lang + failure.name);
             inst::ui::instPage::setInstBarPerc(0);
             std::string audioPath = "romfs:/audio/bark.wav";
             if (!inst::config::soundEnabled) audioPath = "";
             if (std::filesystem::exists(inst::config::appDir + "/bark.wav")) audioPath = inst::config::appDir + "/bark.wav";
             std::thread audioThread(inst::util::playAudio, audioPath);
-            inst::ui::mainApp->CreateShowDialog("inst.info_page.failed"_lang + failedName + "!", "inst.info_page.failed_desc"_lang + "\n\n" + (std::string)e.what(), {"common.ok"_lang}, true);
+            std::string failureDesc = "inst.info_page.failed_desc"_lang + "\n\n" + failure.error;
+            for (size_t i = 1; i < failures.size(); i++)
+                failureDesc += "\n" + failures[i].name;
+            inst::ui::mainApp->CreateShowDialog("inst.info_page.failed"_lang + failure.name + "!", failureDesc, {"common.ok"_lang}, true);
             audioThread.join();
             nspInstalled = false;
         }
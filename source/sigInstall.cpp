@@ -1,3 +1,5 @@
+#include <filesystem>
+#include <vector>
 #include <switch.h>
 #include "util/error.hpp"
 #include "ui/MainApplication.hpp"
@@ -12,6 +14,38 @@ namespace inst::ui {
 }
 
 namespace sig {
+    namespace {
+        // Moves every extracted file over the live tree. Only runs once the whole
+        // archive has been extracted and verified into the staging directory.
+        bool moveStagedFiles(const std::filesystem::path& staging, const std::filesystem::path& destination) {
+            // List first; entries are renamed out of the tree being walked
+            std::vector<std::filesystem::path> entries;
+            std::error_code ec;
+            for (auto it = std::filesystem::recursive_directory_iterator(staging, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+                entries.push_back(it->path());
+            if (ec) return false;
+
+            for (const auto& entry : entries) {
+                const std::filesystem::path target = destination / std::filesystem::relative(entry, staging, ec);
+                if (ec) return false;
+                if (std::filesystem::is_directory(entry, ec)) {
+                    std::filesystem::create_directories(target, ec);
+                } else {
+                    std::filesystem::create_directories(target.parent_path(), ec);
+                    ec.clear();
+                    std::filesystem::remove(target, ec);
+                    ec.clear();
+                    std::filesystem::rename(entry, target, ec);
+                }
+                if (ec) {
+                    LOG_DEBUG("Failed to move %s into place\n", target.string().c_str());
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+
     void installSigPatches () {
         bpcInitialize();
         try {
@@ -31,15 +65,48 @@ namespace sig {
                 if (!inst::util::copyFile("sdmc:/bootloader/patches.ini", inst::config::appDir + "/patches.ini.old")) {
                     if (inst::ui::mainApp->CreateShowDialog("sig.backup_failed"_lang, "sig.backup_failed_desc"_lang, {"common.yes"_lang, "common.no"_lang}, false)) return;
                 }
-                std::string ourPath = inst::config::appDir + "/patches.zip";
-                bool didDownload = inst::curl::downloadFile(inst::config::sigPatchesUrl, ourPath.c_str());
-                bool didExtract = false;
-                if (didDownload) didExtract = inst::zip::extractFile(ourPath, "sdmc:/");
-                else {
+                // Unzip while downloading into a staging directory; only archives that need the
+                // central directory are downloaded to SD first. Nothing under sdmc:/ changes
+                // until the whole archive has been extracted and verified.
+                const std::string stagingDir = inst::config::appDir + "/patches_staging";
+                std::error_code ec;
+                std::filesystem::remove_all(stagingDir, ec);
+                inst::zip::StreamExtractor extractor(stagingDir + "/");
+                inst::curl::DownloadDigest digest;
+                bool extractAborted = false;
+                bool didDownload = inst::curl::downloadToSink(inst::config::sigPatchesUrl, 5000, [&](const void* data, std::size_t size) {
+                    if (extractor.Feed(data, size) && !extractor.IsUnsupported())
+                        return true;
+                    // Stop the transfer as soon as the stream can't be extracted; an unsupported
+                    // archive is downloaded again below for the seekable fallback.
+                    extractAborted = true;
+                    return false;
+                }, nullptr, &digest);
+                bool didExtract = didDownload && extractor.Finish();
+                #ifdef NXLINK_DEBUG
+                if (didDownload) {
+                    char sha256Hex[sizeof(digest.sha256) * 2 + 1] = {};
+                    for (std::size_t i = 0; i < sizeof(digest.sha256); i++)
+                        std::snprintf(sha256Hex + i * 2, 3, "%02x", digest.sha256[i]);
+                    LOG_DEBUG("Signature patches: %llu bytes, sha256 %s\n", (unsigned long long)digest.size, sha256Hex);
+                }
+                #endif
+                // A bad archive aborts the transfer too, but should be reported as an extract failure
+                if (extractAborted) didDownload = true;
+                if (didDownload && extractor.IsUnsupported()) {
+                    LOG_DEBUG("Signature patch archive needs a seekable extract, staging it\n");
+                    std::string ourPath = inst::config::appDir + "/patches.zip";
+                    std::filesystem::remove_all(stagingDir, ec);
+                    didDownload = inst::curl::downloadFile(inst::config::sigPatchesUrl, ourPath.c_str());
+                    if (didDownload) didExtract = inst::zip::extractFile(ourPath, stagingDir + "/");
+                    std::filesystem::remove(ourPath);
+                }
+                if (didDownload && didExtract) didExtract = moveStagedFiles(stagingDir, "sdmc:/");
+                std::filesystem::remove_all(stagingDir, ec);
+                if (!didDownload) {
                     inst::ui::mainApp->CreateShowDialog("sig.download_failed"_lang, "sig.download_failed_desc"_lang, {"common.ok"_lang}, true);
                     return;
                 }
-                std::filesystem::remove(ourPath);
                 if (didExtract) {
                     patchesVersion = inst::util::readTextFromFile("sdmc:/atmosphere/exefs_patches/es_patches/patches.txt");
                     versionText = "";
@@ -2,8 +2,8 @@
 #include "util/lang.hpp"
 #include "util/config.hpp"
 #include "util/util.hpp"
+#include "util/status_service.hpp"
 #include <chrono>
-#include <ctime>
 #include <cstdio>
 #include <filesystem>
 #include <sstream>
@@ -343,68 +343,23 @@ namespace inst::ui {
         });
 
         this->AddThread([this]() {
-            static u64 lastTick = 0;
-            const u64 now = armGetSystemTick();
-            const u64 freq = armGetSystemTickFreq();
-            if (lastTick != 0 && (now - lastTick) < freq)
+            // Sessions and sampling live on the status service thread; only pick up new snapshots here.
+            static std::uint64_t lastGeneration = 0;
+            const std::uint64_t generation = inst::status::GetGeneration();
+            if (generation == lastGeneration)
                 return;
-            lastTick = now;
-
-            std::string timeText = "--:--";
-            if (R_SUCCEEDED(timeInitialize())) {
-                u64 posix = 0;
-                if (R_SUCCEEDED(timeGetCurrentTime(TimeType_LocalSystemClock, &posix))) {
-                    std::time_t t = static_cast<std::time_t>(posix);
-                    std::tm* local = std::localtime(&t);
-                    char buf[16] = {0};
-                    if (local && std::strftime(buf, sizeof(buf), "%I:%M %p", local) > 0)
-                        timeText = buf;
-                }
-                timeExit();
-            }
-
-            bool internetUp = false;
-            bool wifiConnected = false;
-            u32 wifiStrength = 0;
-            if (R_SUCCEEDED(nifmInitialize(NifmServiceType_User))) {
-                NifmInternetConnectionStatus status = static_cast<NifmInternetConnectionStatus>(0);
-                NifmInternetConnectionType type = static_cast<NifmInternetConnectionType>(0);
-                if (R_SUCCEEDED(nifmGetInternetConnectionStatus(&type, &wifiStrength, &status))) {
-                    internetUp = (status == NifmInternetConnectionStatus_Connected);
-                    wifiConnected = internetUp && (type == NifmInternetConnectionType_WiFi);
-                }
-                nifmExit();
-            }
-
-            int batteryPct = -1;
-            if (R_SUCCEEDED(psmInitialize())) {
-                u32 pct = 0;
-                if (R_SUCCEEDED(psmGetBatteryChargePercentage(&pct))) {
-                    batteryPct = static_cast<int>(pct);
-                }
-                psmExit();
-            }
-
-            s64 systemTotal = 0;
-            s64 systemFree = 0;
-            s64 sdTotalBytes = 0;
-            s64 sdFreeBytes = 0;
-            if (R_SUCCEEDED(ncmInitialize())) {
-                NcmContentStorage storage{};
-                Result rc = ncmOpenContentStorage(&storage, NcmStorageId_BuiltInUser);
-                if (R_SUCCEEDED(rc)) {
-                    ncmContentStorageGetTotalSpaceSize(&storage, &systemTotal);
-                    ncmContentStorageGetFreeSpaceSize(&storage, &systemFree);
-                    ncmContentStorageClose(&storage);
-                }
-                rc = ncmOpenContentStorage(&storage, NcmStorageId_SdCard);
-                if (R_SUCCEEDED(rc)) {
-                    ncmContentStorageGetTotalSpaceSize(&storage, &sdTotalBytes);
-                    ncmContentStorageGetFreeSpaceSize(&storage, &sdFreeBytes);
-                    ncmContentStorageClose(&storage);
-                }
-                ncmExit();
-            }
+            lastGeneration = generation;
+
+            const inst::status::Snapshot status = inst::status::GetSnapshot();
+            const std::string& timeText = status.timeText;
+            const bool internetUp = status.internetUp;
+            const bool wifiConnected = status.wifiConnected;
+            const u32 wifiStrength = status.wifiStrength;
+            const int batteryPct = status.batteryPct;
+            const s64 systemTotal = status.systemTotal;
+            const s64 systemFree = status.systemFree;
+            const s64 sdTotalBytes = status.sdTotal;
+            const s64 sdFreeBytes = status.sdFree;
 
             const int cardWidth = 180;
             const int cardGap = 12;
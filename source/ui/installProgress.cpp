@@ -0,0 +1,190 @@
+#include "ui/installProgress.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <switch.h>
+#include "ui/MainApplication.hpp"
+#include "ui/instPage.hpp"
+#include "util/lang.hpp"
+
+namespace inst::ui {
+    extern MainApplication *mainApp;
+}
+
+namespace inst::ui::progress {
+    namespace {
+        constexpr u64 kFrameIntervalNs = 1000000000ULL / 30;
+        constexpr u64 kSpeedSampleNs = 500000000ULL;
+        constexpr double kSpeedSmoothing = 0.3;
+
+        std::atomic<Stage> g_stage{Stage::Idle};
+        std::atomic<std::uint64_t> g_itemId{0};
+        std::atomic<std::uint64_t> g_bytes{0};
+        std::atomic<std::uint64_t> g_total{0};
+
+        // The item name is only written by Begin() and only read when the renderer sees a new item id.
+        std::mutex g_itemNameMutex;
+        std::string g_itemName;
+
+        // Renderer state, only touched by the UI thread.
+        struct RenderState {
+            std::uint64_t itemId = 0;
+            Stage stage = Stage::Idle;
+            std::string itemName;
+            u64 lastFrameTick = 0;
+            u64 sampleTick = 0;
+            std::uint64_t sampleBytes = 0;
+            double speed = 0.0;
+            std::string lastSpeedText;
+        };
+        RenderState g_render;
+
+        std::string FormatOneDecimal(double value)
+        {
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "%.1f", value);
+            return std::string(buf);
+        }
+
+        std::string FormatEta(std::uint64_t totalSeconds)
+        {
+            const std::uint64_t h = totalSeconds / 3600;
+            const std::uint64_t m = (totalSeconds % 3600) / 60;
+            const std::uint64_t s = totalSeconds % 60;
+            char buf[32];
+            if (h > 0) {
+                std::snprintf(buf, sizeof(buf), "%llu:%02llu:%02llu",
+                    static_cast<unsigned long long>(h),
+                    static_cast<unsigned long long>(m),
+                    static_cast<unsigned long long>(s));
+            } else {
+                std::snprintf(buf, sizeof(buf), "%llu:%02llu",
+                    static_cast<unsigned long long>(m),
+                    static_cast<unsigned long long>(s));
+            }
+            return std::string(buf);
+        }
+
+        void UpdateSpeed(u64 nowTick, std::uint64_t bytes)
+        {
+            const u64 elapsedNs = armTicksToNs(nowTick - g_render.sampleTick);
+            if (elapsedNs < kSpeedSampleNs)
+                return;
+            if (bytes >= g_render.sampleBytes) {
+                const double rate = static_cast<double>(bytes - g_render.sampleBytes) / (static_cast<double>(elapsedNs) / 1000000000.0);
+                g_render.speed = (g_render.speed <= 0.0) ? rate : (g_render.speed * (1.0 - kSpeedSmoothing)) + (rate * kSpeedSmoothing);
+            }
+            g_render.sampleTick = nowTick;
+            g_render.sampleBytes = bytes;
+        }
+    }
+
+    void Begin(Stage stage, const std::string& itemName, std::uint64_t totalBytes)
+    {
+        {
+            std::lock_guard<std::mutex> lock(g_itemNameMutex);
+            g_itemName = itemName;
+        }
+        g_bytes.store(0, std::memory_order_relaxed);
+        g_total.store(totalBytes, std::memory_order_relaxed);
+        g_stage.store(stage, std::memory_order_relaxed);
+        g_itemId.fetch_add(1, std::memory_order_release);
+    }
+
+    void SetTotal(std::uint64_t totalBytes)
+    {
+        g_total.store(totalBytes, std::memory_order_relaxed);
+    }
+
+    void SetBytes(std::uint64_t bytes)
+    {
+        g_bytes.store(bytes, std::memory_order_relaxed);
+    }
+
+    void AddBytes(std::uint64_t bytes)
+    {
+        g_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    bool Render(bool force)
+    {
+        const u64 nowTick = armGetSystemTick();
+        if (!force && g_render.lastFrameTick != 0 && armTicksToNs(nowTick - g_render.lastFrameTick) < kFrameIntervalNs)
+            return false;
+        g_render.lastFrameTick = nowTick;
+
+        const std::uint64_t itemId = g_itemId.load(std::memory_order_acquire);
+        const Stage stage = g_stage.load(std::memory_order_relaxed);
+        const std::uint64_t total = g_total.load(std::memory_order_relaxed);
+        const std::uint64_t bytes = std::min(g_bytes.load(std::memory_order_relaxed), total ? total : UINT64_MAX);
+
+        auto& page = mainApp->instpage;
+        const bool newItem = itemId != g_render.itemId;
+        if (newItem) {
+            {
+                std::lock_guard<std::mutex> lock(g_itemNameMutex);
+                g_render.itemName = g_itemName;
+            }
+            g_render.itemId = itemId;
+            g_render.stage = stage;
+            g_render.sampleTick = nowTick;
+            g_render.sampleBytes = bytes;
+            g_render.speed = 0.0;
+            g_render.lastSpeedText.clear();
+            if (stage == Stage::Installing)
+                page->installInfoText->SetText("inst.info_page.top_info0"_lang + g_render.itemName + "...");
+        } else {
+            UpdateSpeed(nowTick, bytes);
+        }
+
+        if (stage == Stage::Idle)
+            return false;
+
+        const double mbDone = static_cast<double>(bytes) / 1000000.0;
+        const double mbTotal = static_cast<double>(total) / 1000000.0;
+        const double mbSpeed = g_render.speed / 1000000.0;
+        const int percent = total ? static_cast<int>((static_cast<double>(bytes) * 100.0) / static_cast<double>(total)) : 0;
+
+        std::string etaText = "--:--";
+        if (g_render.speed > 0.0 && total > bytes)
+            etaText = FormatEta(static_cast<std::uint64_t>(static_cast<double>(total - bytes) / g_render.speed));
+
+        const std::string speedText = FormatOneDecimal(mbSpeed);
+        if (stage == Stage::Downloading && (newItem || speedText != g_render.lastSpeedText))
+            page->installInfoText->SetText("inst.info_page.downloading"_lang + g_render.itemName + "inst.info_page.at"_lang + speedText + "MB/s");
+        g_render.lastSpeedText = speedText;
+
+        page->installBar->SetVisible(true);
+        page->installBar->SetProgress(static_cast<double>(percent));
+
+        std::string detail = (stage == Stage::Downloading) ? "Downloaded " : "Installing ";
+        detail += FormatOneDecimal(mbDone) + " / " + FormatOneDecimal(mbTotal) + " MB (" + std::to_string(percent) + "%) • ETA " + etaText;
+        if (stage == Stage::Installing && mbSpeed > 0.0)
+            detail += " • " + speedText + " MB/s";
+        page->progressDetailText->SetText(detail);
+        page->progressDetailText->SetX((1280 - page->progressDetailText->GetTextWidth()) / 2);
+        page->progressDetailText->SetVisible(true);
+
+        mainApp->CallForRender();
+        return true;
+    }
+
+    void Pump()
+    {
+        if (g_render.lastFrameTick != 0) {
+            const u64 elapsedNs = armTicksToNs(armGetSystemTick() - g_render.lastFrameTick);
+            if (elapsedNs < kFrameIntervalNs)
+                svcSleepThread(static_cast<s64>(kFrameIntervalNs - elapsedNs));
+        }
+        Render(true);
+    }
+
+    void Finish()
+    {
+        const std::uint64_t total = g_total.load(std::memory_order_relaxed);
+        if (total)
+            g_bytes.store(total, std::memory_order_relaxed);
+        Render(true);
+    }
+}
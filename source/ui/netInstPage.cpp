@@ -143,6 +143,11 @@ namespace inst::ui {
         if (!this->ourUrls.size()) {
             mainApp->LoadLayout(mainApp->mainPage);
             return;
+        } else if (this->ourUrls[0] == "pushSession") {
+            int dialogResult = mainApp->CreateShowDialog("inst.target.desc00"_lang + this->ourUrls[1] + "inst.target.desc01"_lang, "common.cancel_desc"_lang, {"inst.target.opt0"_lang, "inst.target.opt1"_lang}, false);
+            netInstStuff::installTitlePush(dialogResult);
+            if (dialogResult == -1) this->startNetwork();
+            return;
         } else if (this->ourUrls[0] == "supplyUrl") {
             std::string keyboardResult;
             switch (mainApp->CreateShowDialog("inst.net.src.title"_lang, "common.cancel_desc"_lang, {"inst.net.src.opt0"_lang, "inst.net.src.opt1"_lang}, false)) {
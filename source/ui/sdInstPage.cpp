@@ -4,6 +4,7 @@
 #include "ui/sdInstPage.hpp"
 #include "sdInstall.hpp"
 #include "util/util.hpp"
+#include "util/dir_scanner.hpp"
 #include "util/config.hpp"
 #include "util/lang.hpp"
 #include "ui/bottomHint.hpp"
@@ -103,14 +104,48 @@ namespace inst::ui {
         if (clearItems) this->selectedTitles = {};
         if (ourPath == "sdmc:") this->currentDir = std::filesystem::path(ourPath.string() + "/");
         else this->currentDir = ourPath;
-        this->menu->ClearItems();
-        try {
-            this->ourDirectories = util::getDirsAtPath(this->currentDir);
-            this->ourFiles = util::getDirectoryFiles(this->currentDir, {".nsp", ".nsz", ".xci", ".xcz"});
-        } catch (std::exception& e) {
+        if (clearItems || this->currentDir != this->listingDir) {
+            inst::util::dirscan::Open(this->currentDir, {".nsp", ".nsz", ".xci", ".xcz"});
+            this->listingDir = this->currentDir;
+            this->listingRevision = 0;
+            this->listingFailed = false;
+            this->ourDirectories.clear();
+            this->ourFiles.clear();
+        }
+        this->pullDirectoryListing();
+        if (this->listingFailed && this->currentDir != "sdmc:/") {
             this->drawMenuItems(false, this->currentDir.parent_path());
             return;
         }
+        this->populateMenu();
+    }
+
+    bool sdInstPage::pullDirectoryListing() {
+        inst::util::dirscan::Listing listing;
+        if (!inst::util::dirscan::Poll(this->currentDir, this->listingRevision, listing))
+            return false;
+        this->listingRevision = listing.revision;
+        this->listingFailed = listing.failed;
+        this->ourDirectories = std::move(listing.dirs);
+        this->ourFiles = std::move(listing.files);
+        return true;
+    }
+
+    void sdInstPage::pollDirectoryListing() {
+        if (!this->pullDirectoryListing())
+            return;
+        if (this->listingFailed && this->currentDir != "sdmc:/") {
+            this->drawMenuItems(false, this->currentDir.parent_path());
+            return;
+        }
+        const int selectedIndex = this->menu->GetSelectedIndex();
+        this->populateMenu();
+        if (selectedIndex > 0 && selectedIndex < (int)this->menu->GetItems().size())
+            this->menu->SetSelectedIndex(selectedIndex);
+    }
+
+    void sdInstPage::populateMenu() {
+        this->menu->ClearItems();
         if (this->currentDir != "sdmc:/") {
             std::string itm = "..";
             auto ourEntry = pu::ui::elm::MenuItem::New(itm);
@@ -183,6 +218,7 @@ namespace inst::ui {
 
     void sdInstPage::onInput(u64 Down, u64 Up, u64 Held, pu::ui::Touch Pos) {
         (void)Held;
+        this->pollDirectoryListing();
         int bottomTapX = 0;
         if (DetectBottomHintTap(Pos, this->bottomHintTouch, 668, 52, bottomTapX)) {
             Down |= FindBottomHintButton(this->bottomHintSegments, bottomTapX);
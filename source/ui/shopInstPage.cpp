@@ -11,9 +11,11 @@
 #include <SDL2/SDL.h>
 #include <switch.h>
 #include "ui/MainApplication.hpp"
+#include "ui/instPage.hpp"
 #include "ui/shopInstPage.hpp"
 #include "util/config.hpp"
 #include "util/curl.hpp"
+#include "util/installed_title_cache.hpp"
 #include "util/lang.hpp"
 #include "util/offline_title_db.hpp"
 #include "util/save_sync.hpp"
@@ -1392,7 +1394,7 @@ namespace inst::ui {
                 this->setButtonsText(" Download    / Select Version     Back");
         }
         else if (this->isSaveSyncSection())
-            this->setButtonsText(" Manage Save     Refresh    / Section     Cancel");
+            this->setButtonsText(" Manage Save     Bulk Sync     Refresh    / Section     Cancel");
         else if (this->isInstalledSection())
             this->setButtonsText("inst.shop.buttons_installed"_lang);
         else
@@ -1910,6 +1912,98 @@ namespace inst::ui {
         this->refreshSaveSyncSection(selectedTitleId, previousSectionIndex);
     }
 
+    void shopInstPage::handleSaveSyncBulkAction() {
+        if (this->saveSyncEntries.empty())
+            return;
+
+        int previousSectionIndex = this->selectedSectionIndex;
+        if (previousSectionIndex < 0)
+            previousSectionIndex = 0;
+
+        std::size_t localCount = 0;
+        for (const auto& entry : this->saveSyncEntries) {
+            if (entry.localAvailable)
+                localCount++;
+        }
+
+        const int choice = mainApp->CreateShowDialog(
+            "Save Sync",
+            "Bulk actions apply to every title in the Saves section.",
+            {"Back up all saves (" + std::to_string(localCount) + ")", "Restore all newer", "common.cancel"_lang},
+            false);
+        if (choice != 0 && choice != 1)
+            return;
+        const bool backup = choice == 0;
+
+        if (!backup) {
+            const int confirm = mainApp->CreateShowDialog(
+                "Save Sync",
+                "Replace every local save that has a newer server backup?",
+                {"common.yes"_lang, "common.no"_lang},
+                false);
+            if (confirm != 0)
+                return;
+        }
+
+        std::string note;
+        if (backup)
+            note = inst::util::softwareKeyboard("Save note (optional)", "", 120);
+
+        inst::ui::instPage::loadInstallScreen();
+        inst::ui::instPage::setTopInstInfoText(backup ? "Backing up saves" : "Restoring newer saves");
+        inst::ui::instPage::setInstInfoText("inst.info_page.preparing"_lang);
+        inst::ui::instPage::setInstBarPerc(0);
+
+        const auto progress = [](const inst::save_sync::SaveSyncEntry& entry, const std::string& status, std::size_t finished, std::size_t total) {
+            inst::ui::instPage::setInstInfoText(inst::util::shortenString(entry.titleName, 38, true) + ": " + status);
+            inst::ui::instPage::setProgressDetailText(std::to_string(finished) + " / " + std::to_string(total));
+            inst::ui::instPage::setInstBarPerc(total > 0 ? (static_cast<double>(finished) * 100.0) / static_cast<double>(total) : 100.0);
+        };
+
+        std::vector<inst::save_sync::SaveSyncBatchResult> results;
+        std::string error;
+        bool ok = false;
+        if (backup)
+            ok = inst::save_sync::BackupAllSaves(this->activeShopUrl, inst::config::shopUser, inst::config::shopPass, this->saveSyncEntries, note, progress, results, error);
+        else
+            ok = inst::save_sync::RestoreNewerSaves(this->activeShopUrl, inst::config::shopUser, inst::config::shopPass, this->saveSyncEntries, progress, results, error);
+
+        inst::ui::instPage::setInstBarPerc(100);
+        inst::ui::instPage::clearProgressDetailText();
+
+        std::string summary;
+        if (!ok) {
+            summary = error.empty() ? "Save sync failed." : error;
+        } else if (results.empty()) {
+            summary = backup ? "No local saves to back up." : "All local saves are up to date.";
+        } else {
+            std::size_t failedCount = 0;
+            std::ostringstream failures;
+            for (const auto& result : results) {
+                if (result.ok)
+                    continue;
+                // Keep the dialog readable on large batches.
+                if (failedCount < 5)
+                    failures << "\n" << inst::util::shortenString(result.titleName, 32, true) << ": " << inst::util::shortenString(result.error, 48, false);
+                failedCount++;
+            }
+            summary = std::to_string(results.size() - failedCount) + " of " + std::to_string(results.size()) + (backup ? " saves uploaded." : " saves restored.");
+            if (failedCount > 0) {
+                summary += failures.str();
+                if (failedCount > 5)
+                    summary += "\n+" + std::to_string(failedCount - 5) + " more";
+            }
+        }
+        inst::ui::instPage::setInstInfoText(summary.substr(0, summary.find('\n')));
+        mainApp->CreateShowDialog("Save Sync", summary, {"common.ok"_lang}, true);
+        inst::ui::instPage::loadMainMenu();
+
+        const std::uint64_t selectedTitleId = (this->shopGridIndex >= 0 && this->shopGridIndex < static_cast<int>(this->visibleItems.size()))
+            ? this->visibleItems[this->shopGridIndex].titleId
+            : 0;
+        this->refreshSaveSyncSection(selectedTitleId, previousSectionIndex);
+    }
+
     void shopInstPage::buildLegacyOwnedSections() {
         if (this->shopSections.empty())
             return;
@@ -2707,8 +2801,16 @@ namespace inst::ui {
         int pageStart = page * kGridItemsPerPage;
         int maxIndex = (int)this->visibleItems.size();
 
+        // A background cache refresh may have brought in icons for titles that were showing a placeholder.
+        const std::uint64_t cacheGeneration = inst::titlecache::GetGeneration();
+        if (cacheGeneration != this->gridCacheGeneration) {
+            this->gridCacheGeneration = cacheGeneration;
+            this->gridPage = -1;
+        }
+
         if (page != this->gridPage) {
-            bool nsReady = R_SUCCEEDED(nsInitialize());
+            bool nsReady = false;
+            bool nsTried = false;
             for (int i = 0; i < kGridItemsPerPage; i++) {
                 int itemIndex = pageStart + i;
                 int row = i / kGridCols;
@@ -2725,7 +2827,21 @@ namespace inst::ui {
 
                 const auto& item = this->visibleItems[itemIndex];
                 bool applied = false;
-                if (nsReady && item.hasTitleId) {
+                if (item.hasTitleId) {
+                    const u64 baseId = tin::util::GetBaseTitleId(item.titleId, static_cast<NcmContentMetaType>(item.appType));
+                    std::vector<std::uint8_t> cachedIcon;
+                    if (inst::titlecache::TryGetIcon(baseId, cachedIcon)) {
+                        this->gridImages[i]->SetJpegImage(cachedIcon.data(), static_cast<s32>(cachedIcon.size()));
+                        this->gridImages[i]->SetWidth(kGridTileWidth);
+                        this->gridImages[i]->SetHeight(kGridTileHeight);
+                        applied = true;
+                    }
+                }
+                if (!applied && item.hasTitleId && !nsTried) {
+                    nsReady = R_SUCCEEDED(nsInitialize());
+                    nsTried = true;
+                }
+                if (!applied && nsReady && item.hasTitleId) {
                     u64 baseId = tin::util::GetBaseTitleId(item.titleId, static_cast<NcmContentMetaType>(item.appType));
                     NsApplicationControlData appControlData;
                     u64 sizeRead = 0;
@@ -3527,6 +3643,10 @@ namespace inst::ui {
             return;
         }
         if (this->shopGridMode) {
+            if ((Down & HidNpadButton_Plus) && this->isSaveSyncSection()) {
+                this->handleSaveSyncBulkAction();
+                return;
+            }
             if (Down & HidNpadButton_Plus) {
                 if (!this->isInstalledSection() && !this->isSaveSyncSection() && !this->visibleItems.empty() && this->selectedItems.empty()) {
                     this->selectTitle(this->shopGridIndex);
@@ -3767,6 +3887,10 @@ namespace inst::ui {
             this->startShop(true);
         }
         if (Down & HidNpadButton_Plus) {
+            if (this->isSaveSyncSection()) {
+                this->handleSaveSyncBulkAction();
+                return;
+            }
             if (!this->isInstalledSection() && !this->isSaveSyncSection()) {
                 if (this->selectedItems.empty()) {
                     this->selectTitle(this->menu->GetSelectedIndex());
@@ -27,6 +27,7 @@ SOFTWARE.
 #include "usbInstall.hpp"
 #include "install/usb_nsp.hpp"
 #include "install/install_nsp.hpp"
+#include "install/install_queue.hpp"
 #include "install/usb_xci.hpp"
 #include "install/install_xci.hpp"
 #include "util/error.hpp"
@@ -96,7 +97,6 @@ namespace usbInstStuff {
         NcmStorageId m_destStorageId = NcmStorageId_SdCard;
 
         if (ourStorage) m_destStorageId = NcmStorageId_BuiltInUser;
-        unsigned int fileItr;
 
         std::vector<std::string> fileNames;
         for (long unsigned int i = 0; i < ourTitleList.size(); i++) {
@@ -110,38 +110,47 @@ namespace usbInstStuff {
             previousClockValues.push_back(inst::util::setClockSpeed(2, 1600000000)[0]);
         }
 
-        try {
-            for (fileItr = 0; fileItr < ourTitleList.size(); fileItr++) {
-                inst::ui::instPage::setTopInstInfoText("inst.info_page.top_info0"_lang + fileNames[fileItr] + "inst.usb.source_string"_lang);
-                std::unique_ptr<tin::install::Install> installTask;
-
-                if (ourTitleList[fileItr].compare(ourTitleList[fileItr].size() - 3, 2, "xc") == 0) {
-                    auto usbXCI = std::make_shared<tin::install::xci::USBXCI>(ourTitleList[fileItr]);
-                    installTask = std::make_unique<tin::install::xci::XCIInstallTask>(m_destStorageId, inst::config::ignoreReqVers, usbXCI);
-                } else {
-                    auto usbNSP = std::make_shared<tin::install::nsp::USBNSP>(ourTitleList[fileItr]);
-                    installTask = std::make_unique<tin::install::nsp::NSPInstall>(m_destStorageId, inst::config::ignoreReqVers, usbNSP);
+        std::vector<tin::install::InstallQueueItem> queueItems;
+        for (unsigned int i = 0; i < ourTitleList.size(); i++) {
+            tin::install::InstallQueueItem item;
+            item.name = fileNames[i];
+            const std::string fileName = ourTitleList[i];
+            item.createTask = [fileName, m_destStorageId]() -> std::unique_ptr<tin::install::Install> {
+                if (fileName.compare(fileName.size() - 3, 2, "xc") == 0) {
+                    auto usbXCI = std::make_shared<tin::install::xci::USBXCI>(fileName);
+                    return std::make_unique<tin::install::xci::XCIInstallTask>(m_destStorageId, inst::config::ignoreReqVers, usbXCI);
                 }
+                auto usbNSP = std::make_shared<tin::install::nsp::USBNSP>(fileName);
+                return std::make_unique<tin::install::nsp::NSPInstall>(m_destStorageId, inst::config::ignoreReqVers, usbNSP);
+            };
+            queueItems.push_back(std::move(item));
+        }
 
-                LOG_DEBUG("%s\n", "Preparing installation");
-                inst::ui::instPage::setInstInfoText("inst.info_page.preparing"_lang);
-                inst::ui::instPage::setInstBarPerc(0);
-                installTask->Prepare();
+        // USB is a single pipe: no reads for the next title while one is streaming,
+        // and a failed transfer leaves the host out of sync for the rest of the list
+        tin::install::InstallQueueOptions queueOptions;
+        queueOptions.concurrentSourceReads = false;
+        queueOptions.continueAfterFailure = false;
+        queueOptions.onTitleStart = [&](size_t index) {
+            inst::ui::instPage::setTopInstInfoText("inst.info_page.top_info0"_lang + fileNames[index] + "inst.usb.source_string"_lang);
+            inst::ui::instPage::setInstInfoText("inst.info_page.preparing"_lang);
+            inst::ui::instPage::setInstBarPerc(0);
+        };
 
-                installTask->Begin();
-            }
-        }
-        catch (std::exception& e) {
-            LOG_DEBUG("Failed to install");
-            LOG_DEBUG("%s", e.what());
-            fprintf(stdout, "%s", e.what());
-            inst::ui::instPage::setInstInfoText("inst.info_page.failed"_lang + fileNames[fileItr]);
+        std::vector<tin::install::InstallQueueFailure> failures = tin::install::RunInstallQueue(queueItems, queueOptions);
+        if (!failures.empty()) {
+            const auto& failure = failures.front();
+            fprintf(stdout, "%s", failure.error.c_str());
+            inst::ui::instPage::setInstInfoText("inst.info_page.failed"_lang + failure.name);
             inst::ui::instPage::setInstBarPerc(0);
             std::string audioPath = "romfs:/audio/bark.wav";
             if (!inst::config::soundEnabled) audioPath = "";
             if (std::filesystem::exists(inst::config::appDir + "/bark.wav")) audioPath = inst::config::appDir + "/bark.wav";
             std::thread audioThread(inst::util::playAudio,audioPath);
-            inst::ui::mainApp->CreateShowDialog("inst.info_page.failed"_lang + fileNames[fileItr] + "!", "inst.info_page.failed_desc"_lang + "\n\n" + (std::string)e.what(), {"common.ok"_lang}, true);
+            std::string failureDesc = "inst.info_page.failed_desc"_lang + "\n\n" + failure.error;
+            for (size_t i = 1; i < failures.size(); i++)
+                failureDesc += "\n" + failures[i].name;
+            inst::ui::mainApp->CreateShowDialog("inst.info_page.failed"_lang + failure.name + "!", failureDesc, {"common.ok"_lang}, true);
             audioThread.join();
             nspInstalled = false;
         }
@@ -18,6 +18,9 @@ namespace inst::config {
     std::string shopPass;
     std::vector<std::string> updateInfo;
     int languageSetting;
+    int httpRetryCount;
+    int mtpTransferDepth;
+    int mtpTransferBufferMb;
     bool autoUpdate;
     bool deletePrompt;
     bool gayMode;
@@ -32,6 +35,10 @@ namespace inst::config {
     bool shopHideInstalledSection;
     bool shopStartGridMode;
     bool offlineDbAutoCheckOnStartup;
+    bool httpStreamedNsp;
+    bool saveSyncStreamUpload;
+    bool saveSyncDelta;
+    bool saveSyncStreamRestore;
 
     namespace {
         std::string ToLower(std::string value)
@@ -488,6 +495,13 @@ namespace inst::config {
             {"shopHideInstalledSection", shopHideInstalledSection},
             {"shopStartGridMode", shopStartGridMode},
             {"offlineDbAutoCheckOnStartup", offlineDbAutoCheckOnStartup},
+            {"httpStreamedNsp", httpStreamedNsp},
+            {"httpRetryCount", httpRetryCount},
+            {"mtpTransferDepth", mtpTransferDepth},
+            {"mtpTransferBufferMb", mtpTransferBufferMb},
+            {"saveSyncStreamUpload", saveSyncStreamUpload},
+            {"saveSyncDelta", saveSyncDelta},
+            {"saveSyncStreamRestore", saveSyncStreamRestore},
             {"shopRememberSelection", false},
             {"shopSelection", nlohmann::json::array()}
         };
@@ -518,6 +532,13 @@ namespace inst::config {
         shopHideInstalledSection = false;
         shopStartGridMode = false;
         offlineDbAutoCheckOnStartup = true;
+        httpStreamedNsp = false;
+        httpRetryCount = 5;
+        mtpTransferDepth = 4;
+        mtpTransferBufferMb = 4;
+        saveSyncStreamUpload = true;
+        saveSyncDelta = true;
+        saveSyncStreamRestore = true;
 
         try {
             std::ifstream file(inst::config::configPath);
@@ -545,6 +566,13 @@ namespace inst::config {
             if (j.contains("shopHideInstalledSection")) shopHideInstalledSection = j["shopHideInstalledSection"].get<bool>();
             if (j.contains("shopStartGridMode")) shopStartGridMode = j["shopStartGridMode"].get<bool>();
             if (j.contains("offlineDbAutoCheckOnStartup")) offlineDbAutoCheckOnStartup = j["offlineDbAutoCheckOnStartup"].get<bool>();
+            if (j.contains("httpStreamedNsp")) httpStreamedNsp = j["httpStreamedNsp"].get<bool>();
+            if (j.contains("httpRetryCount")) httpRetryCount = j["httpRetryCount"].get<int>();
+            if (j.contains("mtpTransferDepth")) mtpTransferDepth = j["mtpTransferDepth"].get<int>();
+            if (j.contains("mtpTransferBufferMb")) mtpTransferBufferMb = j["mtpTransferBufferMb"].get<int>();
+            if (j.contains("saveSyncStreamUpload")) saveSyncStreamUpload = j["saveSyncStreamUpload"].get<bool>();
+            if (j.contains("saveSyncDelta")) saveSyncDelta = j["saveSyncDelta"].get<bool>();
+            if (j.contains("saveSyncStreamRestore")) saveSyncStreamRestore = j["saveSyncStreamRestore"].get<bool>();
         }
         catch (...) {
             // If loading values from the config fails, we just load the defaults and overwrite the old config
@@ -1,8 +1,10 @@
 #include "util/crypto.hpp"
 
+#include <mutex>
 #include <stdexcept>
 #include <string.h>
 #include <mbedtls/bignum.h>
+#include "util/error.hpp"
 
 void Crypto::calculateMGF1andXOR(unsigned char* data, size_t data_size, const void* source, size_t source_size) {
     unsigned char h_buf[RSA_2048_BYTES] = {0};
@@ -87,4 +89,108 @@ bool Crypto::rsa2048PssVerify(const void *data, size_t len, const unsigned char
     sha256CalculateHash(validate_hash, validate_buf, 0x48);
 
     return memcmp(h_buf, validate_hash, 0x20) == 0;
-}
\ No newline at end of file
+}
+
+namespace
+{
+    const u8 kHeaderKekSource[0x10] = { 0x1F, 0x12, 0x91, 0x3A, 0x4A, 0xCB, 0xF0, 0x0D, 0x4C, 0xDE, 0x3A, 0xF6, 0xD5, 0x23, 0x88, 0x2A };
+    const u8 kHeaderKeySource[0x20] = { 0x5A, 0x3E, 0xD8, 0x4F, 0xDE, 0xC0, 0xD8, 0x26, 0x31, 0xF7, 0xE2, 0x5D, 0x19, 0x7B, 0xF5, 0xD0, 0x1C, 0x9B, 0x7B, 0xFA, 0xF6, 0x28, 0x18, 0x3D, 0x71, 0xF6, 0x4D, 0x73, 0xF1, 0x50, 0xB9, 0xD2 };
+
+    struct CtrCacheEntry
+    {
+        bool used = false;
+        u8 key[0x10];
+        Aes128CtrContext ctx;
+    };
+
+    std::mutex g_keyMutex;
+    bool g_headerKeyReady = false;
+    u8 g_headerKey[0x20];
+    Aes128XtsContext g_headerDecryptor;
+    Aes128XtsContext g_headerEncryptor;
+
+    // NCZ sections of one title usually share a handful of keys
+    std::mutex g_ctrMutex;
+    CtrCacheEntry g_ctrCache[8];
+    size_t g_ctrNext = 0;
+
+    void secureZero(void* p, size_t size)
+    {
+        volatile u8* bytes = (volatile u8*)p;
+        while (size--)
+            *bytes++ = 0;
+    }
+
+    // Caller holds g_keyMutex
+    bool ensureHeaderKey()
+    {
+        if (g_headerKeyReady)
+            return true;
+
+        u8 kek[0x10] = {};
+        bool ok = R_SUCCEEDED(splCryptoGenerateAesKek(kHeaderKekSource, 0, 0, kek))
+            && R_SUCCEEDED(splCryptoGenerateAesKey(kek, kHeaderKeySource, g_headerKey))
+            && R_SUCCEEDED(splCryptoGenerateAesKey(kek, kHeaderKeySource + 0x10, g_headerKey + 0x10));
+        secureZero(kek, sizeof(kek));
+
+        // Not cached on failure so the next NCA retries once spl is available
+        if (!ok)
+        {
+            secureZero(g_headerKey, sizeof(g_headerKey));
+            return false;
+        }
+
+        aes128XtsContextCreate(&g_headerDecryptor, g_headerKey, g_headerKey + 0x10, false);
+        aes128XtsContextCreate(&g_headerEncryptor, g_headerKey, g_headerKey + 0x10, true);
+        g_headerKeyReady = true;
+        return true;
+    }
+}
+
+Crypto::AesXtr Crypto::HeaderCipher(bool is_encryptor)
+{
+    std::lock_guard<std::mutex> lock(g_keyMutex);
+    if (!ensureHeaderKey())
+        THROW_FORMAT("Failed to derive the NCA header key");
+    return AesXtr(is_encryptor ? g_headerEncryptor : g_headerDecryptor);
+}
+
+void Crypto::CreateCtrContext(Aes128CtrContext* ctx, const u8* key, const void* iv)
+{
+    std::lock_guard<std::mutex> lock(g_ctrMutex);
+    for (auto& entry : g_ctrCache)
+    {
+        if (entry.used && memcmp(entry.key, key, sizeof(entry.key)) == 0)
+        {
+            *ctx = entry.ctx;
+            aes128CtrContextResetCtr(ctx, iv);
+            return;
+        }
+    }
+
+    aes128CtrContextCreate(ctx, key, iv);
+    CtrCacheEntry& slot = g_ctrCache[g_ctrNext];
+    g_ctrNext = (g_ctrNext + 1) % (sizeof(g_ctrCache) / sizeof(g_ctrCache[0]));
+    slot.used = true;
+    memcpy(slot.key, key, sizeof(slot.key));
+    slot.ctx = *ctx;
+}
+
+void Crypto::ClearKeys()
+{
+    {
+        std::lock_guard<std::mutex> lock(g_keyMutex);
+        secureZero(g_headerKey, sizeof(g_headerKey));
+        secureZero(&g_headerDecryptor, sizeof(g_headerDecryptor));
+        secureZero(&g_headerEncryptor, sizeof(g_headerEncryptor));
+        g_headerKeyReady = false;
+    }
+
+    std::lock_guard<std::mutex> lock(g_ctrMutex);
+    for (auto& entry : g_ctrCache)
+    {
+        secureZero(&entry, sizeof(entry));
+        entry.used = false;
+    }
+    g_ctrNext = 0;
+}
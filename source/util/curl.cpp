@@ -1,4 +1,5 @@
 #include <curl/curl.h>
+#include <switch.h>
 #include <string>
 #include <sstream>
 #include <iostream>
@@ -137,6 +138,23 @@ int progress_callback_file(void *clientp, curl_off_t dltotal, curl_off_t dlnow,
     return 0;
 }
 
+struct DownloadSinkContext {
+    const inst::curl::DownloadChunkCallback* sink = nullptr;
+    Sha256Context sha;
+    std::uint64_t size = 0;
+};
+
+static size_t writeDataSink(void *ptr, size_t size, size_t nmemb, void *userdata) {
+    auto* ctx = static_cast<DownloadSinkContext*>(userdata);
+    const size_t count = size * nmemb;
+    // Hash before handing the chunk on, so the digest covers exactly what the sink saw
+    sha256ContextUpdate(&ctx->sha, ptr, count);
+    ctx->size += count;
+    if (!(*ctx->sink)(ptr, count))
+        return 0;
+    return count;
+}
+
 static constexpr long kDefaultConnectTimeoutMs = 15000;
 static constexpr long kLowSpeedLimitBytesPerSec = 1;
 static constexpr long kLowSpeedTimeSeconds = 45;
@@ -280,6 +298,74 @@ namespace inst::curl {
         return false;
     }
 
+    bool downloadToSink(const std::string ourUrl, long timeout, const DownloadChunkCallback& sink, const DownloadProgressCallback& progressCb, DownloadDigest* outDigest) {
+        if (!ensureCurlGlobalInit()) {
+            LOG_DEBUG("curl global init failed\n");
+            return false;
+        }
+
+        CURL *curl_handle = curl_easy_init();
+        if (curl_handle == nullptr) {
+            LOG_DEBUG("curl_easy_init failed\n");
+            return false;
+        }
+
+        applyCommonCurlOptions(curl_handle, ourUrl, timeout, false);
+        curl_easy_setopt(curl_handle, CURLOPT_FAILONERROR, 1L);
+
+        DownloadSinkContext sinkCtx{};
+        sinkCtx.sink = &sink;
+        sha256ContextCreate(&sinkCtx.sha);
+        curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, writeDataSink);
+        curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, &sinkCtx);
+
+        DownloadProgressContext progressCtx{};
+        if (progressCb) {
+            progressCtx.cb = &progressCb;
+            curl_easy_setopt(curl_handle, CURLOPT_NOPROGRESS, 0L);
+            curl_easy_setopt(curl_handle, CURLOPT_XFERINFOFUNCTION, progress_callback_file);
+            curl_easy_setopt(curl_handle, CURLOPT_XFERINFODATA, &progressCtx);
+        }
+
+        const CURLcode result = curl_easy_perform(curl_handle);
+        long responseCode = 0;
+        curl_easy_getinfo(curl_handle, CURLINFO_RESPONSE_CODE, &responseCode);
+        curl_easy_cleanup(curl_handle);
+
+        const bool ok = (result == CURLE_OK) && (responseCode >= 200 && responseCode < 300);
+        if (!ok) {
+            LOG_DEBUG("downloadToSink failed rc=%s http=%ld url=%s\n", curl_easy_strerror(result), responseCode, ourUrl.c_str());
+            return false;
+        }
+
+        if (progressCb)
+            progressCb(sinkCtx.size, progressCtx.lastTotal > 0 ? static_cast<std::uint64_t>(progressCtx.lastTotal) : sinkCtx.size);
+        if (outDigest != nullptr) {
+            sha256ContextGetHash(&sinkCtx.sha, outDigest->sha256);
+            outDigest->size = sinkCtx.size;
+        }
+        return true;
+    }
+
+    bool downloadFileWithDigest(const std::string ourUrl, const char *pagefilename, long timeout, const DownloadProgressCallback& progressCb, DownloadDigest& outDigest) {
+        FILE *pagefile = fopen(pagefilename, "wb");
+        if (pagefile == nullptr) {
+            LOG_DEBUG("Failed to open download output file: %s\n", pagefilename);
+            return false;
+        }
+
+        const DownloadChunkCallback writeChunk = [pagefile](const void* data, std::size_t size) {
+            return fwrite(data, 1, size, pagefile) == size;
+        };
+        bool ok = downloadToSink(ourUrl, timeout, writeChunk, progressCb, &outDigest);
+        if (fclose(pagefile) != 0)
+            ok = false;
+
+        if (!ok)
+            removeFileIfExistsNoThrow(pagefilename);
+        return ok;
+    }
+
     bool downloadFileWithAuth(const std::string ourUrl, const char *pagefilename, const std::string& user, const std::string& pass, long timeout) {
         if (!ensureCurlGlobalInit()) {
             LOG_DEBUG("curl global init failed\n");
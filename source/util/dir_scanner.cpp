@@ -0,0 +1,244 @@
+#include "util/dir_scanner.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include "util/error.hpp"
+#include "util/util.hpp"
+
+namespace inst::util::dirscan
+{
+    namespace {
+        constexpr std::size_t kMaxCachedDirs = 32;
+        constexpr std::size_t kPublishBatchEntries = 128;
+        constexpr auto kPublishInterval = std::chrono::milliseconds(150);
+
+        struct CacheEntry {
+            std::filesystem::file_time_type mtime{};
+            std::vector<std::string> extensions;
+            std::vector<std::filesystem::path> dirs;
+            std::vector<std::filesystem::path> files;
+            std::uint64_t lastUse = 0;
+        };
+
+        struct Request {
+            std::filesystem::path dir;
+            std::vector<std::string> extensions;
+            std::uint64_t token = 0;
+            bool pending = false;
+        };
+
+        std::mutex g_mutex;
+        std::condition_variable g_cv;
+        std::unordered_map<std::string, CacheEntry> g_cache;
+        std::uint64_t g_useCounter = 0;
+        Listing g_current;
+        Request g_request;
+        std::atomic<std::uint64_t> g_activeToken{0};
+        std::uint64_t g_revisionCounter = 0;
+        bool g_stop = false;
+        std::thread g_worker;
+
+        bool PathLess(const std::filesystem::path& a, const std::filesystem::path& b)
+        {
+            return inst::util::ignoreCaseCompare(a.string(), b.string());
+        }
+
+        bool MatchesExtension(const std::filesystem::path& path, const std::vector<std::string>& extensions)
+        {
+            if (extensions.empty())
+                return true;
+            std::string ext = path.extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+            return std::find(extensions.begin(), extensions.end(), ext) != extensions.end();
+        }
+
+        // Sorts a freshly read batch and merges it into an already sorted list.
+        void MergeSorted(std::vector<std::filesystem::path>& into, std::vector<std::filesystem::path>& batch)
+        {
+            if (batch.empty())
+                return;
+            std::sort(batch.begin(), batch.end(), PathLess);
+            const auto mid = static_cast<std::ptrdiff_t>(into.size());
+            into.insert(into.end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+            std::inplace_merge(into.begin(), into.begin() + mid, into.end(), PathLess);
+            batch.clear();
+        }
+
+        void EvictLocked()
+        {
+            while (g_cache.size() > kMaxCachedDirs) {
+                auto oldest = g_cache.begin();
+                for (auto it = g_cache.begin(); it != g_cache.end(); ++it) {
+                    if (it->second.lastUse < oldest->second.lastUse)
+                        oldest = it;
+                }
+                g_cache.erase(oldest);
+            }
+        }
+
+        void Scan(const Request& request)
+        {
+            const std::string key = request.dir.string();
+            std::error_code ec;
+            const auto mtime = std::filesystem::last_write_time(request.dir, ec);
+
+            bool revalidating = false;
+            {
+                std::lock_guard<std::mutex> lock(g_mutex);
+                auto it = g_cache.find(key);
+                if (it != g_cache.end() && it->second.extensions == request.extensions) {
+                    if (!ec && it->second.mtime == mtime)
+                        return;
+                    revalidating = true;
+                }
+            }
+
+            // A cached listing is already on screen while revalidating, so only swap in the complete result.
+            const bool stream = !revalidating;
+            std::vector<std::filesystem::path> dirs;
+            std::vector<std::filesystem::path> files;
+            std::vector<std::filesystem::path> dirBatch;
+            std::vector<std::filesystem::path> fileBatch;
+            auto lastPublish = std::chrono::steady_clock::now();
+            bool failed = false;
+
+            auto publish = [&](bool complete) -> bool {
+                MergeSorted(dirs, dirBatch);
+                MergeSorted(files, fileBatch);
+                std::lock_guard<std::mutex> lock(g_mutex);
+                if (g_activeToken.load(std::memory_order_relaxed) != request.token)
+                    return false;
+                g_current.dir = request.dir;
+                g_current.dirs = dirs;
+                g_current.files = files;
+                g_current.complete = complete;
+                g_current.failed = failed;
+                g_current.revision = ++g_revisionCounter;
+                return true;
+            };
+
+            std::filesystem::directory_iterator it(request.dir, ec);
+            if (ec)
+                failed = true;
+            std::size_t sinceLastPublish = 0;
+            for (; !failed && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+                if (ec) {
+                    failed = true;
+                    break;
+                }
+                if (g_activeToken.load(std::memory_order_relaxed) != request.token)
+                    return;
+
+                const auto& entry = *it;
+                std::error_code typeEc;
+                if (entry.is_directory(typeEc)) {
+                    dirBatch.push_back(entry.path());
+                } else if (entry.is_regular_file(typeEc) && MatchesExtension(entry.path(), request.extensions)) {
+                    fileBatch.push_back(entry.path());
+                }
+
+                if (stream && ++sinceLastPublish >= kPublishBatchEntries) {
+                    sinceLastPublish = 0;
+                    const auto now = std::chrono::steady_clock::now();
+                    if (now - lastPublish >= kPublishInterval) {
+                        lastPublish = now;
+                        if (!publish(false))
+                            return;
+                    }
+                }
+            }
+
+            if (failed)
+                LOG_DEBUG("Directory scan of %s failed: %s\n", key.c_str(), ec.message().c_str());
+            if (!publish(true))
+                return;
+            if (failed)
+                return;
+
+            std::lock_guard<std::mutex> lock(g_mutex);
+            CacheEntry& cached = g_cache[key];
+            cached.mtime = mtime;
+            cached.extensions = request.extensions;
+            cached.dirs = std::move(dirs);
+            cached.files = std::move(files);
+            cached.lastUse = ++g_useCounter;
+            EvictLocked();
+        }
+
+        void WorkerLoop()
+        {
+            while (true) {
+                Request request;
+                {
+                    std::unique_lock<std::mutex> lock(g_mutex);
+                    g_cv.wait(lock, [] { return g_stop || g_request.pending; });
+                    if (g_stop)
+                        return;
+                    request = g_request;
+                    g_request.pending = false;
+                }
+                Scan(request);
+            }
+        }
+    }
+
+    void Open(const std::filesystem::path& dir, const std::vector<std::string>& extensions)
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        const std::uint64_t token = g_activeToken.load(std::memory_order_relaxed) + 1;
+        g_activeToken.store(token, std::memory_order_relaxed);
+
+        g_current = Listing{};
+        g_current.dir = dir;
+        auto it = g_cache.find(dir.string());
+        if (it != g_cache.end() && it->second.extensions == extensions) {
+            it->second.lastUse = ++g_useCounter;
+            g_current.dirs = it->second.dirs;
+            g_current.files = it->second.files;
+            g_current.complete = true;
+        }
+        g_current.revision = ++g_revisionCounter;
+
+        g_request.dir = dir;
+        g_request.extensions = extensions;
+        g_request.token = token;
+        g_request.pending = true;
+        if (!g_worker.joinable()) {
+            g_stop = false;
+            g_worker = std::thread(WorkerLoop);
+        }
+        g_cv.notify_all();
+    }
+
+    bool Poll(const std::filesystem::path& dir, std::uint64_t knownRevision, Listing& out)
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (g_current.dir != dir || g_current.revision <= knownRevision)
+            return false;
+        out = g_current;
+        return true;
+    }
+
+    void Invalidate(const std::filesystem::path& dir)
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_cache.erase(dir.string());
+    }
+
+    void Shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            g_stop = true;
+            g_activeToken.fetch_add(1, std::memory_order_relaxed);
+        }
+        g_cv.notify_all();
+        if (g_worker.joinable())
+            g_worker.join();
+    }
+}
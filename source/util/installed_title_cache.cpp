@@ -0,0 +1,472 @@
+#include "util/installed_title_cache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <csetjmp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <switch.h>
+#include <jpeglib.h>
+#include "util/config.hpp"
+#include "util/error.hpp"
+
+namespace inst::titlecache
+{
+    namespace {
+        constexpr std::array<char, 8> kCacheMagic = {'C', 'F', 'I', 'N', 'S', 'T', 'C', '1'};
+        constexpr std::uint32_t kCacheVersion = 1;
+        constexpr std::uint32_t kMaxCacheEntries = 8192;
+        constexpr std::uint32_t kMaxNameBytes = 0x200;
+        constexpr std::uint32_t kMaxIconBytes = 0x20000;
+        constexpr std::uintmax_t kMaxCacheFileBytes = 64ULL * 1024ULL * 1024ULL;
+        // Smallest edge the thumbnails are decoded down to; the installed grid draws 120x120 tiles.
+        constexpr unsigned kThumbnailMinEdge = 120;
+        constexpr int kThumbnailQuality = 85;
+
+        struct CacheHeader {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t entryCount;
+        };
+
+        struct CacheEntryRecord {
+            std::uint64_t applicationId;
+            std::uint64_t recordStamp;
+            std::uint32_t version;
+            std::uint32_t nameSize;
+            std::uint32_t iconSize;
+            std::uint32_t reserved;
+        };
+
+        std::mutex g_mutex;
+        std::unordered_map<std::uint64_t, CachedTitle> g_entries;
+        bool g_loaded = false;
+        std::atomic<std::uint64_t> g_generation{0};
+
+        std::mutex g_workerMutex;
+        std::thread g_worker;
+        bool g_workerRunning = false;
+        bool g_refreshQueued = false;
+        // Set by Shutdown so a long first-run pass doesn't hold up exiting the app
+        std::atomic<bool> g_stopRequested{false};
+
+        std::string GetCachePath()
+        {
+            return inst::config::appDir + "/installed_titles.bin";
+        }
+
+        std::uint64_t HashBytes(std::uint64_t hash, const void* data, std::size_t size)
+        {
+            const auto* bytes = static_cast<const std::uint8_t*>(data);
+            for (std::size_t i = 0; i < size; i++) {
+                hash ^= bytes[i];
+                hash *= 0x100000001b3ULL;
+            }
+            return hash;
+        }
+
+        // Stamp that changes whenever the application record or any of its installed content metas change,
+        // so updates and DLC installed without touching the record still invalidate the entry.
+        std::uint64_t ComputeRecordStamp(const NsApplicationRecord& record, std::uint32_t& outVersion)
+        {
+            std::uint64_t hash = HashBytes(0xcbf29ce484222325ULL, &record, sizeof(record));
+            outVersion = 0;
+
+            s32 metaCount = 0;
+            if (R_FAILED(nsCountApplicationContentMeta(record.application_id, &metaCount)) || metaCount <= 0)
+                return hash;
+            std::vector<NsApplicationContentMetaStatus> list(metaCount);
+            s32 metaOut = 0;
+            if (R_FAILED(nsListApplicationContentMetaStatus(record.application_id, 0, list.data(), metaCount, &metaOut)) || metaOut <= 0)
+                return hash;
+            for (s32 i = 0; i < metaOut; i++) {
+                hash = HashBytes(hash, &list[i], sizeof(list[i]));
+                if (list[i].meta_type == NcmContentMetaType_Application || list[i].meta_type == NcmContentMetaType_Patch)
+                    outVersion = std::max<std::uint32_t>(outVersion, list[i].version);
+            }
+            return hash;
+        }
+
+        struct JpegErrorManager {
+            jpeg_error_mgr pub;
+            jmp_buf jump;
+        };
+
+        // libjpeg's default error_exit calls exit(), so unwind back to the caller instead.
+        void JpegErrorExit(j_common_ptr info)
+        {
+            std::longjmp(reinterpret_cast<JpegErrorManager*>(info->err)->jump, 1);
+        }
+
+        // Decodes at 1/denom scale into a malloc'd RGB buffer. No C++ objects live past setjmp here.
+        bool DecodeScaledJpeg(const std::uint8_t* jpeg, std::size_t jpegSize, unsigned char** outPixels, unsigned* outWidth, unsigned* outHeight)
+        {
+            jpeg_decompress_struct info{};
+            JpegErrorManager err{};
+            unsigned char* volatile pixels = nullptr;
+            info.err = jpeg_std_error(&err.pub);
+            err.pub.error_exit = JpegErrorExit;
+            if (setjmp(err.jump)) {
+                jpeg_destroy_decompress(&info);
+                std::free(pixels);
+                return false;
+            }
+
+            jpeg_create_decompress(&info);
+            jpeg_mem_src(&info, jpeg, static_cast<unsigned long>(jpegSize));
+            jpeg_read_header(&info, TRUE);
+
+            unsigned denom = 1;
+            while (denom < 8 && (info.image_width / (denom * 2)) >= kThumbnailMinEdge && (info.image_height / (denom * 2)) >= kThumbnailMinEdge)
+                denom *= 2;
+            if (denom == 1) {
+                jpeg_destroy_decompress(&info);
+                return false;
+            }
+            info.scale_num = 1;
+            info.scale_denom = denom;
+            info.out_color_space = JCS_RGB;
+            jpeg_start_decompress(&info);
+
+            const std::size_t stride = static_cast<std::size_t>(info.output_width) * 3;
+            pixels = static_cast<unsigned char*>(std::malloc(stride * info.output_height));
+            if (!pixels) {
+                jpeg_destroy_decompress(&info);
+                return false;
+            }
+            while (info.output_scanline < info.output_height) {
+                JSAMPROW row = pixels + (static_cast<std::size_t>(info.output_scanline) * stride);
+                jpeg_read_scanlines(&info, &row, 1);
+            }
+            jpeg_finish_decompress(&info);
+
+            *outPixels = pixels;
+            *outWidth = info.output_width;
+            *outHeight = info.output_height;
+            jpeg_destroy_decompress(&info);
+            return true;
+        }
+
+        bool EncodeRgbJpeg(const unsigned char* pixels, unsigned width, unsigned height, unsigned char** outBuf, unsigned long* outSize)
+        {
+            jpeg_compress_struct info{};
+            JpegErrorManager err{};
+            info.err = jpeg_std_error(&err.pub);
+            err.pub.error_exit = JpegErrorExit;
+            if (setjmp(err.jump)) {
+                jpeg_destroy_compress(&info);
+                std::free(*outBuf);
+                *outBuf = nullptr;
+                return false;
+            }
+
+            jpeg_create_compress(&info);
+            jpeg_mem_dest(&info, outBuf, outSize);
+            info.image_width = width;
+            info.image_height = height;
+            info.input_components = 3;
+            info.in_color_space = JCS_RGB;
+            jpeg_set_defaults(&info);
+            jpeg_set_quality(&info, kThumbnailQuality, TRUE);
+            jpeg_start_compress(&info, TRUE);
+            const std::size_t stride = static_cast<std::size_t>(width) * 3;
+            while (info.next_scanline < height) {
+                JSAMPROW row = const_cast<unsigned char*>(pixels) + (static_cast<std::size_t>(info.next_scanline) * stride);
+                jpeg_write_scanlines(&info, &row, 1);
+            }
+            jpeg_finish_compress(&info);
+            jpeg_destroy_compress(&info);
+            return true;
+        }
+
+        // Re-encodes the 256x256 control icon at the smallest DCT scale that still covers a grid tile,
+        // so the grid decodes a quarter of the pixels. Returns false if the icon cannot be shrunk.
+        bool MakeThumbnail(const std::uint8_t* jpeg, std::size_t jpegSize, std::vector<std::uint8_t>& outThumb)
+        {
+            unsigned char* pixels = nullptr;
+            unsigned width = 0;
+            unsigned height = 0;
+            if (!DecodeScaledJpeg(jpeg, jpegSize, &pixels, &width, &height))
+                return false;
+
+            unsigned char* encoded = nullptr;
+            unsigned long encodedSize = 0;
+            const bool ok = EncodeRgbJpeg(pixels, width, height, &encoded, &encodedSize);
+            std::free(pixels);
+            if (ok && encoded && encodedSize > 0)
+                outThumb.assign(encoded, encoded + encodedSize);
+            std::free(encoded);
+            return ok && !outThumb.empty();
+        }
+
+        bool ReadControlData(std::uint64_t applicationId, std::uint64_t stamp, std::uint32_t version, CachedTitle& outTitle)
+        {
+            auto appControlData = std::make_unique<NsApplicationControlData>();
+            u64 sizeRead = 0;
+            Result rc = nsGetApplicationControlData(NsApplicationControlSource_Storage, applicationId, appControlData.get(), sizeof(NsApplicationControlData), &sizeRead);
+            if (R_FAILED(rc) || sizeRead < sizeof(appControlData->nacp)) {
+                LOG_DEBUG("Title cache: no control data for %016lx (0x%08x)\n", applicationId, rc);
+                return false;
+            }
+
+            outTitle = CachedTitle{};
+            outTitle.applicationId = applicationId;
+            outTitle.recordStamp = stamp;
+            outTitle.version = version;
+
+            NacpLanguageEntry* languageEntry = nullptr;
+            if (R_SUCCEEDED(nacpGetLanguageEntry(&appControlData->nacp, &languageEntry)) && languageEntry && languageEntry->name[0] != '\0')
+                outTitle.name.assign(languageEntry->name, strnlen(languageEntry->name, sizeof(languageEntry->name)));
+
+            const u64 iconSize = sizeRead - sizeof(appControlData->nacp);
+            if (iconSize > 0 && iconSize <= sizeof(appControlData->icon)) {
+                if (!MakeThumbnail(appControlData->icon, iconSize, outTitle.iconThumbnail))
+                    outTitle.iconThumbnail.assign(appControlData->icon, appControlData->icon + iconSize);
+            }
+            return true;
+        }
+
+        bool SaveCache(const std::unordered_map<std::uint64_t, CachedTitle>& entries)
+        {
+            std::vector<std::uint8_t> out;
+            CacheHeader header{};
+            std::memcpy(header.magic, kCacheMagic.data(), kCacheMagic.size());
+            header.version = kCacheVersion;
+            header.entryCount = static_cast<std::uint32_t>(entries.size());
+            out.insert(out.end(), reinterpret_cast<const std::uint8_t*>(&header), reinterpret_cast<const std::uint8_t*>(&header) + sizeof(header));
+            for (const auto& [id, title] : entries) {
+                CacheEntryRecord record{};
+                record.applicationId = title.applicationId;
+                record.recordStamp = title.recordStamp;
+                record.version = title.version;
+                record.nameSize = static_cast<std::uint32_t>(std::min<std::size_t>(title.name.size(), kMaxNameBytes));
+                record.iconSize = static_cast<std::uint32_t>(title.iconThumbnail.size() <= kMaxIconBytes ? title.iconThumbnail.size() : 0);
+                out.insert(out.end(), reinterpret_cast<const std::uint8_t*>(&record), reinterpret_cast<const std::uint8_t*>(&record) + sizeof(record));
+                out.insert(out.end(), title.name.begin(), title.name.begin() + record.nameSize);
+                out.insert(out.end(), title.iconThumbnail.begin(), title.iconThumbnail.begin() + record.iconSize);
+            }
+
+            const std::string path = GetCachePath();
+            const std::string tmpPath = path + ".tmp";
+            FILE* file = std::fopen(tmpPath.c_str(), "wb");
+            if (!file)
+                return false;
+            const bool written = std::fwrite(out.data(), 1, out.size(), file) == out.size();
+            std::fclose(file);
+            std::error_code ec;
+            if (!written) {
+                std::filesystem::remove(tmpPath, ec);
+                return false;
+            }
+            std::filesystem::rename(tmpPath, path, ec);
+            return !ec;
+        }
+
+        void RefreshPass()
+        {
+            if (R_FAILED(nsInitialize()))
+                return;
+
+            std::unordered_map<std::uint64_t, CachedTitle> known;
+            {
+                std::lock_guard<std::mutex> lock(g_mutex);
+                known = g_entries;
+            }
+
+            std::unordered_set<std::uint64_t> seen;
+            std::vector<CachedTitle> updated;
+            const s32 chunk = 64;
+            s32 offset = 0;
+            bool stopped = false;
+            while (!stopped) {
+                NsApplicationRecord records[chunk];
+                s32 outCount = 0;
+                if (R_FAILED(nsListApplicationRecord(records, chunk, offset, &outCount)) || outCount <= 0)
+                    break;
+                for (s32 i = 0; i < outCount; i++) {
+                    if (g_stopRequested.load(std::memory_order_relaxed)) {
+                        stopped = true;
+                        break;
+                    }
+                    const std::uint64_t appId = records[i].application_id;
+                    seen.insert(appId);
+                    std::uint32_t version = 0;
+                    const std::uint64_t stamp = ComputeRecordStamp(records[i], version);
+                    auto it = known.find(appId);
+                    if (it != known.end() && it->second.recordStamp == stamp)
+                        continue;
+                    CachedTitle title;
+                    if (ReadControlData(appId, stamp, version, title))
+                        updated.push_back(std::move(title));
+                }
+                offset += outCount;
+            }
+            nsExit();
+
+            std::unordered_map<std::uint64_t, CachedTitle> snapshot;
+            bool changed = !updated.empty();
+            {
+                std::lock_guard<std::mutex> lock(g_mutex);
+                // A stopped pass only saw part of the records; keep what it read, drop nothing
+                for (auto it = g_entries.begin(); it != g_entries.end();) {
+                    if (!stopped && !seen.count(it->first)) {
+                        it = g_entries.erase(it);
+                        changed = true;
+                    } else {
+                        ++it;
+                    }
+                }
+                for (auto& title : updated)
+                    g_entries[title.applicationId] = std::move(title);
+                if (changed)
+                    snapshot = g_entries;
+            }
+
+            if (!changed)
+                return;
+            g_generation.fetch_add(1, std::memory_order_release);
+            LOG_DEBUG("Title cache: refreshed %zu titles, %zu cached\n", updated.size(), snapshot.size());
+            if (!SaveCache(snapshot))
+                LOG_DEBUG("Title cache: failed to write %s\n", GetCachePath().c_str());
+        }
+
+        void WorkerLoop()
+        {
+            while (true) {
+                RefreshPass();
+                std::lock_guard<std::mutex> lock(g_workerMutex);
+                if (!g_refreshQueued || g_stopRequested.load(std::memory_order_relaxed)) {
+                    g_workerRunning = false;
+                    return;
+                }
+                g_refreshQueued = false;
+            }
+        }
+    }
+
+    void Load()
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (g_loaded)
+            return;
+        g_loaded = true;
+
+        const std::string path = GetCachePath();
+        std::error_code ec;
+        const auto fileSize = std::filesystem::file_size(path, ec);
+        if (ec || fileSize < sizeof(CacheHeader) || fileSize > kMaxCacheFileBytes)
+            return;
+
+        std::vector<std::uint8_t> data(static_cast<std::size_t>(fileSize));
+        FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file)
+            return;
+        const bool readOk = std::fread(data.data(), 1, data.size(), file) == data.size();
+        std::fclose(file);
+        if (!readOk)
+            return;
+
+        CacheHeader header{};
+        std::memcpy(&header, data.data(), sizeof(header));
+        if (std::memcmp(header.magic, kCacheMagic.data(), kCacheMagic.size()) != 0 || header.version != kCacheVersion || header.entryCount > kMaxCacheEntries)
+            return;
+
+        std::unordered_map<std::uint64_t, CachedTitle> entries;
+        entries.reserve(header.entryCount);
+        std::size_t pos = sizeof(header);
+        for (std::uint32_t i = 0; i < header.entryCount; i++) {
+            CacheEntryRecord record{};
+            if (data.size() - pos < sizeof(record))
+                return;
+            std::memcpy(&record, data.data() + pos, sizeof(record));
+            pos += sizeof(record);
+            if (record.nameSize > kMaxNameBytes || record.iconSize > kMaxIconBytes || data.size() - pos < static_cast<std::size_t>(record.nameSize) + record.iconSize)
+                return;
+
+            CachedTitle title;
+            title.applicationId = record.applicationId;
+            title.recordStamp = record.recordStamp;
+            title.version = record.version;
+            title.name.assign(reinterpret_cast<const char*>(data.data() + pos), record.nameSize);
+            pos += record.nameSize;
+            title.iconThumbnail.assign(data.begin() + pos, data.begin() + pos + record.iconSize);
+            pos += record.iconSize;
+            entries[title.applicationId] = std::move(title);
+        }
+
+        g_entries = std::move(entries);
+        g_generation.fetch_add(1, std::memory_order_release);
+    }
+
+    void RequestRefresh()
+    {
+        Load();
+        std::lock_guard<std::mutex> lock(g_workerMutex);
+        if (g_workerRunning) {
+            g_refreshQueued = true;
+            return;
+        }
+        if (g_worker.joinable())
+            g_worker.join();
+        g_workerRunning = true;
+        g_refreshQueued = false;
+        g_worker = std::thread(WorkerLoop);
+    }
+
+    void Shutdown()
+    {
+        std::thread worker;
+        {
+            std::lock_guard<std::mutex> lock(g_workerMutex);
+            g_refreshQueued = false;
+            worker = std::move(g_worker);
+        }
+        g_stopRequested.store(true, std::memory_order_relaxed);
+        if (worker.joinable())
+            worker.join();
+        g_stopRequested.store(false, std::memory_order_relaxed);
+    }
+
+    std::uint64_t GetGeneration()
+    {
+        return g_generation.load(std::memory_order_acquire);
+    }
+
+    bool TryGet(std::uint64_t baseTitleId, CachedTitle& outTitle)
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        auto it = g_entries.find(baseTitleId);
+        if (it == g_entries.end())
+            return false;
+        outTitle = it->second;
+        return true;
+    }
+
+    bool TryGetName(std::uint64_t baseTitleId, std::string& outName)
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        auto it = g_entries.find(baseTitleId);
+        if (it == g_entries.end() || it->second.name.empty())
+            return false;
+        outName = it->second.name;
+        return true;
+    }
+
+    bool TryGetIcon(std::uint64_t baseTitleId, std::vector<std::uint8_t>& outIcon)
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        auto it = g_entries.find(baseTitleId);
+        if (it == g_entries.end() || it->second.iconThumbnail.empty())
+            return false;
+        outIcon = it->second.iconThumbnail;
+        return true;
+    }
+}
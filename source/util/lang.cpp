@@ -4,14 +4,49 @@
 #include <pu/Plutonium>
 #include "util/lang.hpp"
 #include "util/config.hpp"
-#include <sstream>
 #include <fstream>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include "json.hpp"
 
 using json = nlohmann::json;
 
 namespace Language {
-    json lang;
+    namespace {
+        // Flattened language file: string leaves by key id, string arrays (e.g. inst.finished) by key id.
+        // Both are built once by Load() before any other thread looks strings up.
+        std::unordered_map<KeyId, std::string> g_strings;
+        std::unordered_map<KeyId, std::vector<std::string>> g_lists;
+
+        // Placeholders for keys missing from the language file. Node-based, so references stay valid.
+        std::mutex g_missingMutex;
+        std::unordered_map<KeyId, std::string> g_missing;
+
+        void Flatten(const json& node, std::string& path)
+        {
+            if (node.is_object()) {
+                const std::size_t parentLength = path.size();
+                for (auto it = node.begin(); it != node.end(); ++it) {
+                    if (!path.empty())
+                        path += '.';
+                    path += it.key();
+                    Flatten(it.value(), path);
+                    path.resize(parentLength);
+                }
+            } else if (node.is_string()) {
+                if (!g_strings.emplace(HashKey(path), node.get<std::string>()).second)
+                    std::cout << "[LANGUAGE KEY COLLISION] " << path << std::endl;
+            } else if (node.is_array()) {
+                std::vector<std::string> items;
+                for (const auto& item : node) {
+                    if (item.is_string())
+                        items.push_back(item.get<std::string>());
+                }
+                g_lists[HashKey(path)] = std::move(items);
+            }
+        }
+    }
 
     int ResolveConfiguredLanguage()
     {
@@ -89,33 +124,37 @@ namespace Language {
             std::cout << "[FAILED TO LOAD LANGUAGE FILE]" << std::endl;
             return;
         }
-        lang = json::parse(ifs);
+        const json lang = json::parse(ifs);
         ifs.close();
-    }
 
-    inline json GetRelativeJson(json j, std::string key) {
-        std::istringstream ss(key);
-        std::string token;
+        g_strings.clear();
+        g_lists.clear();
+        std::string path;
+        Flatten(lang, path);
+    }
 
-        while (std::getline(ss, token, '.') && j != nullptr) {
-            j = j[token];
-        }
+    const std::string& Entry(KeyId id, std::string_view key) {
+        const auto it = g_strings.find(id);
+        if (it != g_strings.end())
+            return it->second;
 
-        return j;
+        std::lock_guard<std::mutex> lock(g_missingMutex);
+        auto missing = g_missing.find(id);
+        if (missing == g_missing.end())
+            missing = g_missing.emplace(id, "didn't find: " + std::string(key)).first;
+        return missing->second;
     }
 
     std::string LanguageEntry(std::string key) {
-        json j = GetRelativeJson(lang, key);
-        if (j == nullptr) {
-            return "didn't find: " + key;
-        }
-        return j.get<std::string>();
+        return Entry(HashKey(key), key);
     }
 
     std::string GetRandomMsg() {
-        json j = Language::GetRelativeJson(lang, "inst.finished");
+        const auto it = g_lists.find(HashKey("inst.finished"));
+        if (it == g_lists.end() || it->second.empty())
+            return "";
         srand(time(NULL));
-        return(j[rand() % j.size()]);
+        return it->second[rand() % it->second.size()];
     }
 
     std::string GetShopHeaderLanguage()
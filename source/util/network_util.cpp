@@ -25,8 +25,11 @@ SOFTWARE.
 #include <switch.h>
 #include <curl/curl.h>
 #include <algorithm>
+#include <cctype>
+#include <cstdlib>
 #include <cstring>
 #include <sstream>
+#include "util/config.hpp"
 #include "util/error.hpp"
 #include "ui/MainApplication.hpp"
 
@@ -179,6 +182,13 @@ namespace tin::network
         }
     }
 
+    std::string HTTPDownload::GetHeaderValue(std::string key)
+    {
+        if (!m_header.HasValue(key))
+            return "";
+        return m_header.GetValue(key);
+    }
+
     size_t HTTPDownload::ParseHTMLData(char* bytes, size_t size, size_t numItems, void* userData)
     {
         auto streamFunc = *reinterpret_cast<std::function<size_t (u8* bytes, size_t size)>*>(userData);
@@ -213,6 +223,24 @@ namespace tin::network
         this->StreamDataRange(offset, size, streamFunc);
     }
 
+    size_t HTTPDownload::ParseContentRangeTotal(char* bytes, size_t size, size_t numItems, void* userData)
+    {
+        u64* total = reinterpret_cast<u64*>(userData);
+        size_t numBytes = size * numItems;
+        std::string line(bytes, numBytes);
+        std::transform(line.begin(), line.end(), line.begin(), ::tolower);
+
+        // "Content-Range: bytes <first>-<last>/<total>", the total may be "*"
+        if (line.rfind("content-range:", 0) == 0)
+        {
+            auto slash = line.find('/');
+            if (slash != std::string::npos && slash + 1 < line.size() && std::isdigit((unsigned char)line[slash + 1]))
+                *total = std::strtoull(line.c_str() + slash + 1, nullptr, 10);
+        }
+
+        return numBytes;
+    }
+
     int HTTPDownload::StreamDataRange(size_t offset, size_t size, std::function<size_t (u8* bytes, size_t size)> streamFunc)
     {
         if (!m_rangesSupported)
@@ -220,6 +248,85 @@ namespace tin::network
             THROW_FORMAT("Attempted range request when ranges aren't supported!\n");
         }
 
+        size_t delivered = 0;
+        bool aborted = false;
+        CURL* curl = nullptr;
+        // Size of the whole resource from Content-Range, 0 while unknown. A window that
+        // runs past the end of the file is answered with a short 206 ending there.
+        u64 totalSize = 0;
+
+        // Counts what the caller accepted so a dropped connection can continue
+        // from the first byte it hasn't seen yet.
+        std::function<size_t (u8* bytes, size_t size)> writeDataFunc = [&](u8* bytes, size_t numBytes) -> size_t
+        {
+            long httpCode = 0;
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+            if (httpCode != 206)
+            {
+                // A full 200 body would be spliced in at the wrong offset
+                aborted = true;
+                return 0;
+            }
+
+            size_t accepted = streamFunc != nullptr ? streamFunc(bytes, numBytes) : numBytes;
+            delivered += accepted;
+            if (accepted != numBytes)
+                aborted = true;
+            return accepted;
+        };
+
+        const int maxRetries = std::max(inst::config::httpRetryCount, 0);
+        u64 backoffMs = 500;
+
+        for (int attempt = 0; ; attempt++)
+        {
+            curl = curl_easy_init();
+            CURLcode rc = (CURLcode)0;
+
+            if (!curl)
+            {
+                THROW_FORMAT("Failed to initialize curl\n");
+            }
+
+            std::stringstream ss;
+            ss << (offset + delivered) << "-" << (offset + size - 1);
+            auto range = ss.str();
+
+            curl_easy_setopt(curl, CURLOPT_URL, m_url.c_str());
+            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, false);
+            curl_easy_setopt(curl, CURLOPT_USERAGENT, "tinfoil");
+            curl_easy_setopt(curl, CURLOPT_RANGE, range.c_str());
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &writeDataFunc);
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &tin::network::HTTPDownload::ParseHTMLData);
+            curl_easy_setopt(curl, CURLOPT_HEADERDATA, &totalSize);
+            curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, &tin::network::HTTPDownload::ParseContentRangeTotal);
+            // Treat a stalled connection as dropped so it gets retried
+            curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+            curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, 30L);
+            std::string authValue;
+            ApplyBasicAuth(curl, authValue);
+
+            rc = curl_easy_perform(curl);
+
+            u64 httpCode = 0;
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+            curl_easy_cleanup(curl);
+            curl = nullptr;
+
+            const bool reachedEnd = delivered == size || (totalSize != 0 && offset + delivered >= totalSize);
+            if (httpCode == 206 && rc == CURLE_OK && reachedEnd) return 0;
+            if (aborted || reachedEnd || attempt >= maxRetries) break;
+
+            LOG_DEBUG("Range request interrupted at 0x%lx/0x%lx (%s, HTTP %lu), retrying in %lums\n", delivered, size, curl_easy_strerror(rc), httpCode, backoffMs);
+            svcSleepThread(backoffMs * 1'000'000ULL);
+            backoffMs = std::min<u64>(backoffMs * 2, 8000);
+        }
+
+        return 1;
+    }
+
+    int HTTPDownload::StreamDataSequential(std::function<size_t (u8* bytes, size_t size)> streamFunc)
+    {
         auto writeDataFunc = streamFunc;
 
         CURL* curl = curl_easy_init();
@@ -230,14 +337,10 @@ namespace tin::network
             THROW_FORMAT("Failed to initialize curl\n");
         }
 
-        std::stringstream ss;
-        ss << offset << "-" << (offset + size - 1);
-        auto range = ss.str();
-
         curl_easy_setopt(curl, CURLOPT_URL, m_url.c_str());
         curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, false);
         curl_easy_setopt(curl, CURLOPT_USERAGENT, "tinfoil");
-        curl_easy_setopt(curl, CURLOPT_RANGE, range.c_str());
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
         curl_easy_setopt(curl, CURLOPT_WRITEDATA, &writeDataFunc);
         curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &tin::network::HTTPDownload::ParseHTMLData);
         std::string authValue;
@@ -249,7 +352,7 @@ namespace tin::network
         curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
         curl_easy_cleanup(curl);
 
-        if (httpCode != 206 || rc != CURLE_OK) return 1;
+        if (httpCode != 200 || rc != CURLE_OK) return 1;
         return 0;
     }
 
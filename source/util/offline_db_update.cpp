@@ -6,6 +6,7 @@
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
@@ -23,10 +24,19 @@
 namespace inst::offline::dbupdate
 {
     namespace {
+        struct ManifestPatch {
+            std::string fromVersion;
+            std::string fromSha256;
+            std::string url;
+            std::string sha256;
+            std::uint64_t size = 0;
+        };
+
         struct ManifestFile {
             std::string url;
             std::string sha256;
             std::uint64_t size = 0;
+            std::vector<ManifestPatch> patches;
         };
 
         struct ManifestData {
@@ -51,6 +61,24 @@ namespace inst::offline::dbupdate
         constexpr std::uint64_t kOfflineDbTraceMaxLines = 40000;
         constexpr const char* kOfflineDbTracePath = "sdmc:/switch/HappyFoil/offline_db_update.log";
 
+        // Delta patches produced by tools/export_offline_db.py. A patch rebuilds the new pack from
+        // COPY ops (ranges of the installed pack) and DATA ops (literal bytes carried in the patch).
+        constexpr char kDeltaMagic[8] = {'C', 'F', 'D', 'E', 'L', 'T', 'A', '1'};
+        constexpr std::uint32_t kDeltaVersion = 1;
+        constexpr std::uint8_t kDeltaOpEnd = 0;
+        constexpr std::uint8_t kDeltaOpCopy = 1;
+        constexpr std::uint8_t kDeltaOpData = 2;
+        constexpr std::size_t kDeltaIoBufferSize = 256 * 1024;
+
+        struct DeltaHeader {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t reserved;
+            std::uint64_t sourceSize;
+            std::uint64_t targetSize;
+        };
+        static_assert(sizeof(DeltaHeader) == 32, "Delta header must be 32 bytes.");
+
         void OfflineDbTrace(const char* fmt, ...)
         {
             const std::uint64_t idx = g_offlineDbTraceCount.fetch_add(1, std::memory_order_relaxed);
@@ -266,6 +294,30 @@ namespace inst::offline::dbupdate
             out.url = ResolveUrl(manifestUrl, rawUrl);
             out.size = size;
             out.sha256 = sha;
+            out.patches.clear();
+
+            // Patches are optional; malformed entries are skipped so a bad patch never blocks the full download.
+            if (entry.contains("patches") && entry["patches"].is_array()) {
+                for (const auto& patchEntry : entry["patches"]) {
+                    if (!patchEntry.is_object() || !patchEntry.contains("url") || !patchEntry["url"].is_string())
+                        continue;
+                    ManifestPatch patch;
+                    if (patchEntry.contains("from_version") && patchEntry["from_version"].is_string())
+                        patch.fromVersion = Trim(patchEntry["from_version"].get<std::string>());
+                    if (patchEntry.contains("from_sha256") && patchEntry["from_sha256"].is_string())
+                        patch.fromSha256 = NormalizeSha256(patchEntry["from_sha256"].get<std::string>());
+                    if (patchEntry.contains("sha256") && patchEntry["sha256"].is_string())
+                        patch.sha256 = NormalizeSha256(patchEntry["sha256"].get<std::string>());
+                    if (!patchEntry.contains("size") || !TryGetU64(patchEntry["size"], patch.size) || patch.size == 0)
+                        continue;
+                    if (!IsValidSha256Hex(patch.fromSha256) || !IsValidSha256Hex(patch.sha256))
+                        continue;
+                    patch.url = ResolveUrl(manifestUrl, patchEntry["url"].get<std::string>());
+                    if (patch.url.empty())
+                        continue;
+                    out.patches.push_back(std::move(patch));
+                }
+            }
             return true;
         }
 
@@ -355,6 +407,23 @@ namespace inst::offline::dbupdate
             return true;
         }
 
+        bool ReadLocalManifest(const std::string& path, ManifestData& outManifest)
+        {
+            std::ifstream in(path, std::ios::binary);
+            if (!in)
+                return false;
+
+            nlohmann::json root;
+            try {
+                in >> root;
+            } catch (...) {
+                return false;
+            }
+
+            std::string error;
+            return ParseManifestJson(root, "", outManifest, error);
+        }
+
         bool ReadLocalManifestVersion(const std::string& path, std::string& outVersion)
         {
             std::ifstream in(path, std::ios::binary);
@@ -381,42 +450,21 @@ namespace inst::offline::dbupdate
             return false;
         }
 
-        bool ComputeFileSha256(const std::string& path, std::string& outHexHash, std::uint64_t& outSize)
+        std::string Sha256Hex(const std::uint8_t* hash)
         {
-            std::ifstream in(path, std::ios::binary);
-            if (!in)
-                return false;
-
-            Sha256Context ctx;
-            sha256ContextCreate(&ctx);
-            std::vector<char> buffer(256 * 1024);
-            if (buffer.empty())
-                return false;
-            outSize = 0;
-
-            while (true) {
-                in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
-                const std::streamsize got = in.gcount();
-                if (got > 0) {
-                    sha256ContextUpdate(&ctx, buffer.data(), static_cast<std::size_t>(got));
-                    outSize += static_cast<std::uint64_t>(got);
-                }
-                if (!in)
-                    break;
-            }
-
-            if (!in.eof())
-                return false;
-
-            std::array<std::uint8_t, SHA256_HASH_SIZE> hash{};
-            sha256ContextGetHash(&ctx, hash.data());
             std::ostringstream hex;
             hex.fill('0');
             hex << std::hex;
-            for (std::uint8_t b : hash)
-                hex << std::setw(2) << static_cast<int>(b);
-            outHexHash = ToLower(hex.str());
-            return true;
+            for (std::size_t i = 0; i < SHA256_HASH_SIZE; i++)
+                hex << std::setw(2) << static_cast<int>(hash[i]);
+            return ToLower(hex.str());
+        }
+
+        std::string FinishSha256Hex(Sha256Context& ctx)
+        {
+            std::array<std::uint8_t, SHA256_HASH_SIZE> hash{};
+            sha256ContextGetHash(&ctx, hash.data());
+            return Sha256Hex(hash.data());
         }
 
         bool DownloadAndVerify(const ManifestFile& file, const std::string& tempPath, std::string& error,
@@ -512,10 +560,12 @@ namespace inst::offline::dbupdate
             LOG_DEBUG("Offline DB download start: %s\n", file.url.c_str());
             try {
                 RemoveIfExists(tempPath);
-                if (!inst::curl::downloadFileWithProgress(file.url, tempPath.c_str(), 0,
+                // The body is hashed as it is written, so the pack is never read back from SD
+                inst::curl::DownloadDigest digest;
+                if (!inst::curl::downloadFileWithDigest(file.url, tempPath.c_str(), 0,
                         [&](std::uint64_t downloaded, std::uint64_t total) {
                             reportDownloadProgress(downloaded, total, false);
-                        })) {
+                        }, digest)) {
                     RemoveIfExists(tempPath);
                     error = "Download failed: " + file.url;
                     OfflineDbTrace("DownloadAndVerify fail: download error url='%s'", file.url.c_str());
@@ -525,16 +575,9 @@ namespace inst::offline::dbupdate
 
                 reportDownloadProgress(lastTotal ? lastTotal : file.size, lastTotal ? lastTotal : file.size, true);
 
-                OfflineDbTrace("DownloadAndVerify download complete, starting hash temp='%s'", tempPath.c_str());
-                std::uint64_t actualSize = 0;
-                std::string actualSha;
-                if (!ComputeFileSha256(tempPath, actualSha, actualSize)) {
-                    RemoveIfExists(tempPath);
-                    error = "Failed to verify downloaded file hash.";
-                    OfflineDbTrace("DownloadAndVerify fail: failed to hash temp='%s'", tempPath.c_str());
-                    LOG_DEBUG("Offline DB hash verify failed to read temp file: %s\n", tempPath.c_str());
-                    return false;
-                }
+                const std::uint64_t actualSize = digest.size;
+                const std::string actualSha = Sha256Hex(digest.sha256);
+                OfflineDbTrace("DownloadAndVerify download complete temp='%s' sha=%s", tempPath.c_str(), actualSha.c_str());
 
                 if (actualSize != file.size) {
                     RemoveIfExists(tempPath);
@@ -578,6 +621,192 @@ namespace inst::offline::dbupdate
             }
         }
 
+        bool ApplyDeltaPatch(const std::string& sourcePath, const std::string& patchPath, const std::string& outPath,
+            const ManifestFile& target, std::string& error, const ProgressCallback& progress,
+            const std::string& stageLabel, double percentStart, double percentEnd)
+        {
+            std::error_code ec;
+            const std::uint64_t sourceSize = std::filesystem::file_size(sourcePath, ec);
+            if (ec) {
+                error = "Failed to stat installed pack for delta patch.";
+                return false;
+            }
+
+            std::FILE* patch = std::fopen(patchPath.c_str(), "rb");
+            std::FILE* source = std::fopen(sourcePath.c_str(), "rb");
+            std::FILE* out = std::fopen(outPath.c_str(), "wb");
+            auto closeAll = [&]() {
+                if (patch)
+                    std::fclose(patch);
+                if (source)
+                    std::fclose(source);
+                if (out)
+                    std::fclose(out);
+                patch = source = out = nullptr;
+            };
+            auto fail = [&](const std::string& message) {
+                closeAll();
+                RemoveIfExists(outPath);
+                error = message;
+                OfflineDbTrace("ApplyDeltaPatch fail: %s", message.c_str());
+                return false;
+            };
+
+            if (!patch || !source || !out)
+                return fail("Failed to open delta patch files.");
+
+            DeltaHeader header{};
+            if (std::fread(&header, sizeof(header), 1, patch) != 1
+                || std::memcmp(header.magic, kDeltaMagic, sizeof(kDeltaMagic)) != 0
+                || header.version != kDeltaVersion)
+                return fail("Invalid delta patch header.");
+            if (header.sourceSize != sourceSize)
+                return fail("Installed pack does not match the delta patch source.");
+            if (header.targetSize != target.size)
+                return fail("Delta patch target size does not match the manifest.");
+
+            std::vector<std::uint8_t> buffer(kDeltaIoBufferSize);
+            Sha256Context ctx;
+            sha256ContextCreate(&ctx);
+            std::uint64_t written = 0;
+            std::uint64_t sourcePos = UINT64_MAX;
+            double lastReportedPercent = -1.0;
+
+            auto reportApplyProgress = [&]() {
+                if (!progress)
+                    return;
+                const double ratio = target.size ? (static_cast<double>(written) / static_cast<double>(target.size)) : 1.0;
+                const double mappedPercent = percentStart + ((percentEnd - percentStart) * std::min(1.0, ratio));
+                if (lastReportedPercent >= 0.0 && mappedPercent < lastReportedPercent + 0.5)
+                    return;
+                lastReportedPercent = mappedPercent;
+                std::ostringstream status;
+                status << stageLabel << " (" << static_cast<int>(mappedPercent + 0.5) << "%, "
+                       << (written / (1024ULL * 1024ULL)) << "/" << (target.size / (1024ULL * 1024ULL)) << " MB)";
+                progress(status.str(), mappedPercent);
+            };
+
+            // Streams `length` bytes from `in` into the output file, hashing as it goes so the
+            // result never has to be re-read for verification.
+            auto pump = [&](std::FILE* in, std::uint64_t length) {
+                while (length > 0) {
+                    const std::size_t chunk = static_cast<std::size_t>(std::min<std::uint64_t>(length, buffer.size()));
+                    if (std::fread(buffer.data(), 1, chunk, in) != chunk)
+                        return false;
+                    if (std::fwrite(buffer.data(), 1, chunk, out) != chunk)
+                        return false;
+                    sha256ContextUpdate(&ctx, buffer.data(), chunk);
+                    written += chunk;
+                    length -= chunk;
+                    reportApplyProgress();
+                }
+                return true;
+            };
+
+            reportApplyProgress();
+            OfflineDbTrace("ApplyDeltaPatch start source='%s' patch='%s' source_size=%llu target_size=%llu",
+                sourcePath.c_str(), patchPath.c_str(),
+                static_cast<unsigned long long>(header.sourceSize),
+                static_cast<unsigned long long>(header.targetSize));
+
+            while (true) {
+                std::uint8_t op = 0;
+                if (std::fread(&op, 1, 1, patch) != 1)
+                    return fail("Truncated delta patch.");
+                if (op == kDeltaOpEnd)
+                    break;
+
+                if (op == kDeltaOpCopy) {
+                    std::uint64_t offset = 0;
+                    std::uint32_t length = 0;
+                    if (std::fread(&offset, sizeof(offset), 1, patch) != 1 || std::fread(&length, sizeof(length), 1, patch) != 1)
+                        return fail("Truncated delta patch.");
+                    if (offset > sourceSize || length > (sourceSize - offset) || length > (target.size - written))
+                        return fail("Delta patch copy op is out of range.");
+                    if (offset != sourcePos && std::fseek(source, static_cast<long>(offset), SEEK_SET) != 0)
+                        return fail("Failed to seek installed pack.");
+                    if (!pump(source, length))
+                        return fail("Failed to copy data from installed pack.");
+                    sourcePos = offset + length;
+                } else if (op == kDeltaOpData) {
+                    std::uint32_t length = 0;
+                    if (std::fread(&length, sizeof(length), 1, patch) != 1)
+                        return fail("Truncated delta patch.");
+                    if (length > (target.size - written))
+                        return fail("Delta patch data op is out of range.");
+                    if (!pump(patch, length))
+                        return fail("Failed to write delta patch data.");
+                } else {
+                    return fail("Unknown delta patch op.");
+                }
+            }
+
+            const bool flushed = std::fflush(out) == 0;
+            closeAll();
+            if (!flushed || written != target.size)
+                return fail("Patched file size mismatch.");
+
+            const std::string actualSha = FinishSha256Hex(ctx);
+            if (actualSha != target.sha256) {
+                OfflineDbTrace("ApplyDeltaPatch sha mismatch expected=%s actual=%s", target.sha256.c_str(), actualSha.c_str());
+                return fail("Patched file sha256 mismatch.");
+            }
+
+            OfflineDbTrace("ApplyDeltaPatch ok target='%s' size=%llu", outPath.c_str(), static_cast<unsigned long long>(written));
+            return true;
+        }
+
+        // Returns the sha256 the installed manifest recorded for a pack, provided the file on disk still has the recorded size.
+        std::string InstalledPackSha256(const ManifestFile& installed, const std::string& path)
+        {
+            std::error_code ec;
+            const std::uint64_t size = std::filesystem::file_size(path, ec);
+            if (ec || size != installed.size)
+                return "";
+            return installed.sha256;
+        }
+
+        // Rebuilds a pack from a delta patch against the installed copy when the manifest advertises one,
+        // and falls back to downloading the full pack if there is no usable patch or applying it fails.
+        bool FetchPack(const ManifestFile& file, const std::string& name, const std::string& installedPath,
+            const std::string& installedSha256, const std::string& tempPath, std::string& error,
+            const ProgressCallback& progress, double percentStart, double percentEnd)
+        {
+            if (!installedSha256.empty()) {
+                for (const auto& patch : file.patches) {
+                    if (patch.fromSha256 != installedSha256)
+                        continue;
+
+                    ManifestFile patchFile;
+                    patchFile.url = patch.url;
+                    patchFile.sha256 = patch.sha256;
+                    patchFile.size = patch.size;
+
+                    const std::string patchTemp = tempPath + ".cfdelta";
+                    const double percentMid = percentStart + ((percentEnd - percentStart) * 0.5);
+                    std::string patchError;
+                    OfflineDbTrace("FetchPack %s: using delta from version '%s' (%llu bytes)",
+                        name.c_str(), patch.fromVersion.c_str(), static_cast<unsigned long long>(patch.size));
+                    const bool patched = DownloadAndVerify(patchFile, patchTemp, patchError, progress,
+                            "Downloading " + name + " update...", percentStart, percentMid)
+                        && ApplyDeltaPatch(installedPath, patchTemp, tempPath, file, patchError, progress,
+                            "Applying " + name + " update...", percentMid, percentEnd);
+                    RemoveIfExists(patchTemp);
+                    if (patched) {
+                        LOG_DEBUG("Offline DB %s patched from %s\n", name.c_str(), patch.fromVersion.c_str());
+                        return true;
+                    }
+
+                    RemoveIfExists(tempPath);
+                    OfflineDbTrace("FetchPack %s: delta failed (%s), falling back to full download", name.c_str(), patchError.c_str());
+                    LOG_DEBUG("Offline DB %s delta failed: %s\n", name.c_str(), patchError.c_str());
+                    break;
+                }
+            }
+
+            return DownloadAndVerify(file, tempPath, error, progress, "Downloading " + name + "...", percentStart, percentEnd);
+        }
+
         bool RenameFile(const std::string& from, const std::string& to, std::string& error)
         {
             std::error_code ec;
@@ -736,16 +965,26 @@ namespace inst::offline::dbupdate
         OfflineDbTrace("ApplyUpdate temp files titles='%s' icons='%s' manifest='%s'",
             titlesTemp.c_str(), iconsTemp.c_str(), manifestTemp.c_str());
 
+        // A forced update always re-downloads the full packs, since the installed copies may be what is broken.
+        ManifestData installedManifest;
+        const bool haveInstalledManifest = !force
+            && (ReadLocalManifest(LocalManifestPath(), installedManifest)
+                || ReadLocalManifest(LocalManifestAliasPath(), installedManifest));
+        const std::string titlesPath = dbDir + "/titles.pack";
+        const std::string iconsPath = dbDir + "/icons.pack";
+        const std::string installedTitlesSha = haveInstalledManifest ? InstalledPackSha256(installedManifest.titlesPack, titlesPath) : "";
+        const std::string installedIconsSha = haveInstalledManifest ? InstalledPackSha256(installedManifest.iconsPack, iconsPath) : "";
+
         OfflineDbTrace("ApplyUpdate progress: downloading titles.pack");
-        if (!DownloadAndVerify(manifest.titlesPack, titlesTemp, result.error, progress,
-                "Downloading titles.pack...", 20.0, 45.0)) {
+        if (!FetchPack(manifest.titlesPack, "titles.pack", titlesPath, installedTitlesSha, titlesTemp, result.error, progress,
+                20.0, 45.0)) {
             OfflineDbTrace("ApplyUpdate fail: titles.pack %s", result.error.c_str());
             return result;
         }
 
         OfflineDbTrace("ApplyUpdate progress: downloading icons.pack");
-        if (!DownloadAndVerify(manifest.iconsPack, iconsTemp, result.error, progress,
-                "Downloading icons.pack...", 45.0, 70.0)) {
+        if (!FetchPack(manifest.iconsPack, "icons.pack", iconsPath, installedIconsSha, iconsTemp, result.error, progress,
+                45.0, 70.0)) {
             RemoveIfExists(titlesTemp);
             OfflineDbTrace("ApplyUpdate fail: icons.pack %s", result.error.c_str());
             return result;
@@ -779,12 +1018,12 @@ namespace inst::offline::dbupdate
         OfflineDbTrace("ApplyUpdate progress: installing files");
 
         ReplaceState titlesState{
-            dbDir + "/titles.pack",
+            titlesPath,
             titlesTemp,
             dbDir + "/titles.pack.bak"
         };
         ReplaceState iconsState{
-            dbDir + "/icons.pack",
+            iconsPath,
             iconsTemp,
             dbDir + "/icons.pack.bak"
         };
@@ -1,11 +1,19 @@
 #include <algorithm>
+#include <array>
 #include <cctype>
+#include <condition_variable>
+#include <deque>
 #include <cstdio>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <mutex>
 #include <sstream>
 #include <system_error>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -28,6 +36,17 @@
 namespace {
     constexpr const char* kSaveMountName = "svsync";
 
+    // curl_global_init is not thread-safe and batch transfers run on several threads.
+    bool EnsureCurlGlobalInit()
+    {
+        static std::once_flag initFlag;
+        static bool initOk = false;
+        std::call_once(initFlag, []() {
+            initOk = (curl_global_init(CURL_GLOBAL_ALL) == CURLE_OK);
+        });
+        return initOk;
+    }
+
     std::string FormatResultHex(Result rc)
     {
         char buf[16] = {0};
@@ -156,6 +175,33 @@ namespace {
         return baseUrl + "/api/saves/delete/" + FormatTitleIdHex(titleId);
     }
 
+    std::string BuildManifestUrl(const std::string& shopUrl, std::uint64_t titleId, const std::string& saveId = std::string())
+    {
+        const std::string baseUrl = NormalizeShopUrl(shopUrl);
+        if (baseUrl.empty())
+            return std::string();
+        const std::string normalizedSaveId = NormalizeSaveIdToken(saveId);
+        if (!normalizedSaveId.empty())
+            return baseUrl + "/api/saves/manifest/" + FormatTitleIdHex(titleId) + "/" + normalizedSaveId;
+        return baseUrl + "/api/saves/manifest/" + FormatTitleIdHex(titleId);
+    }
+
+    std::string BuildDeltaUploadUrl(const std::string& shopUrl, std::uint64_t titleId)
+    {
+        const std::string baseUrl = NormalizeShopUrl(shopUrl);
+        if (baseUrl.empty())
+            return std::string();
+        return baseUrl + "/api/saves/upload-delta/" + FormatTitleIdHex(titleId);
+    }
+
+    std::string BuildDeltaDownloadUrl(const std::string& shopUrl, std::uint64_t titleId, const std::string& saveId)
+    {
+        const std::string baseUrl = NormalizeShopUrl(shopUrl);
+        if (baseUrl.empty())
+            return std::string();
+        return baseUrl + "/api/saves/download-delta/" + FormatTitleIdHex(titleId) + "/" + NormalizeSaveIdToken(saveId);
+    }
+
     std::string BuildRemoteListUrl(const std::string& shopUrl)
     {
         const std::string baseUrl = NormalizeShopUrl(shopUrl);
@@ -267,16 +313,8 @@ namespace {
         return true;
     }
 
-    bool CreateZipFromDirectory(const std::filesystem::path& sourceRoot, const std::filesystem::path& zipPath, std::string& error)
+    bool CollectSaveFiles(const std::filesystem::path& sourceRoot, std::vector<std::filesystem::path>& files, std::string& error)
     {
-        error.clear();
-        zipFile zf = zipOpen64(zipPath.string().c_str(), APPEND_STATUS_CREATE);
-        if (!zf) {
-            error = "Failed to create save archive.";
-            return false;
-        }
-
-        std::vector<std::filesystem::path> files;
         std::error_code ec;
         std::filesystem::recursive_directory_iterator it(sourceRoot, std::filesystem::directory_options::skip_permission_denied, ec);
         std::filesystem::recursive_directory_iterator end;
@@ -286,10 +324,26 @@ namespace {
             it.increment(ec);
         }
         if (ec) {
-            zipClose(zf, nullptr);
             error = "Failed while collecting save files for archive.";
             return false;
         }
+        return true;
+    }
+
+    bool CreateZipFromDirectory(const std::filesystem::path& sourceRoot, const std::filesystem::path& zipPath, std::string& error)
+    {
+        error.clear();
+        zipFile zf = zipOpen64(zipPath.string().c_str(), APPEND_STATUS_CREATE);
+        if (!zf) {
+            error = "Failed to create save archive.";
+            return false;
+        }
+
+        std::vector<std::filesystem::path> files;
+        if (!CollectSaveFiles(sourceRoot, files, error)) {
+            zipClose(zf, nullptr);
+            return false;
+        }
 
         if (files.empty()) {
             zip_fileinfo zi = {};
@@ -352,6 +406,309 @@ namespace {
         return true;
     }
 
+    // Bounded byte pipe between a producer thread and a consumer, such as a zip writer and the
+    // curl read callback on upload, or the curl write callback and the zip reader on restore.
+    class StreamPipe {
+    public:
+        explicit StreamPipe(size_t capacity) : m_data(capacity) {}
+
+        bool Write(const void* data, size_t size)
+        {
+            const auto* src = static_cast<const std::uint8_t*>(data);
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (size > 0) {
+                m_cv.wait(lock, [&] { return m_cancelled || m_size < m_data.size(); });
+                if (m_cancelled)
+                    return false;
+                const size_t tail = (m_head + m_size) % m_data.size();
+                const size_t chunk = std::min({size, m_data.size() - m_size, m_data.size() - tail});
+                std::memcpy(m_data.data() + tail, src, chunk);
+                m_size += chunk;
+                src += chunk;
+                size -= chunk;
+                m_cv.notify_all();
+            }
+            return true;
+        }
+
+        // Returns 0 at the end of a complete stream, CURL_READFUNC_ABORT if the producer failed.
+        size_t Read(void* out, size_t max)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [&] { return m_cancelled || m_closed || m_size > 0; });
+            if (m_cancelled || (m_size == 0 && !m_succeeded))
+                return CURL_READFUNC_ABORT;
+            if (m_size == 0)
+                return 0;
+            const size_t chunk = std::min({max, m_size, m_data.size() - m_head});
+            std::memcpy(out, m_data.data() + m_head, chunk);
+            m_head = (m_head + chunk) % m_data.size();
+            m_size -= chunk;
+            m_cv.notify_all();
+            return chunk;
+        }
+
+        void Close(bool succeeded)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+            m_succeeded = succeeded;
+            m_cv.notify_all();
+        }
+
+        void Cancel()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_cancelled = true;
+            m_cv.notify_all();
+        }
+
+        bool IsCancelled()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_cancelled;
+        }
+
+        // True once the producer has closed the pipe after a failure.
+        bool IsFailed()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_closed && !m_succeeded;
+        }
+
+    private:
+        std::vector<std::uint8_t> m_data;
+        size_t m_head = 0;
+        size_t m_size = 0;
+        bool m_closed = false;
+        bool m_succeeded = false;
+        bool m_cancelled = false;
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+    };
+
+    size_t ReadFromStreamPipe(char* buffer, size_t size, size_t numItems, void* userdata)
+    {
+        return reinterpret_cast<StreamPipe*>(userdata)->Read(buffer, size * numItems);
+    }
+
+    // Writes a ZIP archive front to back without seeking: entries use data
+    // descriptors, so CRC and sizes follow the compressed data instead of
+    // being patched into the local header afterwards.
+    class ZipStreamWriter {
+    public:
+        using Sink = std::function<bool(const void* data, size_t size)>;
+
+        explicit ZipStreamWriter(Sink sink) : m_sink(std::move(sink)) {}
+
+        bool AddFile(const std::string& name, const std::filesystem::path& path, std::vector<std::uint8_t>& readBuffer, std::string& error)
+        {
+            FILE* in = nullptr;
+            if (!path.empty()) {
+                in = std::fopen(path.string().c_str(), "rb");
+                if (!in) {
+                    error = "Failed to read local save file for archive.";
+                    return false;
+                }
+            }
+
+            CentralEntry entry;
+            entry.name = name;
+            entry.offset = m_offset;
+
+            std::vector<std::uint8_t> header;
+            Put32(header, 0x04034b50);
+            Put16(header, 20);
+            Put16(header, kFlags);
+            Put16(header, Z_DEFLATED);
+            Put16(header, 0);
+            Put16(header, kDosDate);
+            Put32(header, 0);
+            Put32(header, 0);
+            Put32(header, 0);
+            Put16(header, static_cast<std::uint16_t>(name.size()));
+            Put16(header, 0);
+            header.insert(header.end(), name.begin(), name.end());
+            bool ok = this->Emit(header.data(), header.size());
+
+            z_stream zs = {};
+            ok = ok && deflateInit2(&zs, Z_BEST_SPEED, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+            if (!ok) {
+                if (in)
+                    std::fclose(in);
+                error = "Failed to open file in save archive.";
+                return false;
+            }
+
+            const std::uint64_t dataStart = m_offset;
+            std::uint32_t crc = crc32(0L, Z_NULL, 0);
+            std::uint64_t rawSize = 0;
+            int flush = Z_NO_FLUSH;
+            while (ok && flush != Z_FINISH) {
+                size_t read = in ? std::fread(readBuffer.data(), 1, readBuffer.size(), in) : 0;
+                if (in && read == 0 && std::ferror(in)) {
+                    error = "Failed to read local save file for archive.";
+                    ok = false;
+                    break;
+                }
+                flush = read < readBuffer.size() ? Z_FINISH : Z_NO_FLUSH;
+                crc = crc32(crc, readBuffer.data(), static_cast<uInt>(read));
+                rawSize += read;
+
+                zs.next_in = readBuffer.data();
+                zs.avail_in = static_cast<uInt>(read);
+                do {
+                    zs.next_out = m_deflateOut.data();
+                    zs.avail_out = static_cast<uInt>(m_deflateOut.size());
+                    deflate(&zs, flush);
+                    const size_t produced = m_deflateOut.size() - zs.avail_out;
+                    if (produced > 0 && !this->Emit(m_deflateOut.data(), produced)) {
+                        ok = false;
+                        break;
+                    }
+                } while (zs.avail_out == 0);
+            }
+            deflateEnd(&zs);
+            if (in)
+                std::fclose(in);
+            if (!ok) {
+                if (error.empty())
+                    error = "Failed while writing save archive.";
+                return false;
+            }
+
+            entry.crc = crc;
+            entry.compressedSize = m_offset - dataStart;
+            entry.size = rawSize;
+            if (entry.compressedSize > 0xFFFFFFFFULL || entry.size > 0xFFFFFFFFULL || entry.offset > 0xFFFFFFFFULL) {
+                error = "Save archive is too large for streaming upload.";
+                return false;
+            }
+
+            std::vector<std::uint8_t> descriptor;
+            Put32(descriptor, 0x08074b50);
+            Put32(descriptor, entry.crc);
+            Put32(descriptor, static_cast<std::uint32_t>(entry.compressedSize));
+            Put32(descriptor, static_cast<std::uint32_t>(entry.size));
+            if (!this->Emit(descriptor.data(), descriptor.size())) {
+                error = "Failed while writing save archive.";
+                return false;
+            }
+
+            m_entries.push_back(std::move(entry));
+            return true;
+        }
+
+        bool Finish(std::string& error)
+        {
+            if (m_entries.size() > 0xFFFF || m_offset > 0xFFFFFFFFULL) {
+                error = "Save archive is too large for streaming upload.";
+                return false;
+            }
+
+            std::vector<std::uint8_t> directory;
+            for (const auto& entry : m_entries) {
+                Put32(directory, 0x02014b50);
+                Put16(directory, 20);
+                Put16(directory, 20);
+                Put16(directory, kFlags);
+                Put16(directory, Z_DEFLATED);
+                Put16(directory, 0);
+                Put16(directory, kDosDate);
+                Put32(directory, entry.crc);
+                Put32(directory, static_cast<std::uint32_t>(entry.compressedSize));
+                Put32(directory, static_cast<std::uint32_t>(entry.size));
+                Put16(directory, static_cast<std::uint16_t>(entry.name.size()));
+                Put16(directory, 0);
+                Put16(directory, 0);
+                Put16(directory, 0);
+                Put16(directory, 0);
+                Put32(directory, 0);
+                Put32(directory, static_cast<std::uint32_t>(entry.offset));
+                directory.insert(directory.end(), entry.name.begin(), entry.name.end());
+            }
+
+            const std::uint64_t directoryOffset = m_offset;
+            const size_t directorySize = directory.size();
+            Put32(directory, 0x06054b50);
+            Put16(directory, 0);
+            Put16(directory, 0);
+            Put16(directory, static_cast<std::uint16_t>(m_entries.size()));
+            Put16(directory, static_cast<std::uint16_t>(m_entries.size()));
+            Put32(directory, static_cast<std::uint32_t>(directorySize));
+            Put32(directory, static_cast<std::uint32_t>(directoryOffset));
+            Put16(directory, 0);
+            if (!this->Emit(directory.data(), directory.size())) {
+                error = "Failed to finalize save archive.";
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        struct CentralEntry {
+            std::string name;
+            std::uint64_t offset = 0;
+            std::uint32_t crc = 0;
+            std::uint64_t compressedSize = 0;
+            std::uint64_t size = 0;
+        };
+
+        // Data descriptor present, UTF-8 names
+        static constexpr std::uint16_t kFlags = 0x0808;
+        // 1980-01-01, saves carry no meaningful timestamps
+        static constexpr std::uint16_t kDosDate = 0x0021;
+
+        static void Put16(std::vector<std::uint8_t>& out, std::uint16_t value)
+        {
+            out.push_back(static_cast<std::uint8_t>(value));
+            out.push_back(static_cast<std::uint8_t>(value >> 8));
+        }
+
+        static void Put32(std::vector<std::uint8_t>& out, std::uint32_t value)
+        {
+            Put16(out, static_cast<std::uint16_t>(value));
+            Put16(out, static_cast<std::uint16_t>(value >> 16));
+        }
+
+        bool Emit(const void* data, size_t size)
+        {
+            if (!m_sink(data, size))
+                return false;
+            m_offset += size;
+            return true;
+        }
+
+        Sink m_sink;
+        std::uint64_t m_offset = 0;
+        std::vector<CentralEntry> m_entries;
+        std::vector<std::uint8_t> m_deflateOut = std::vector<std::uint8_t>(0x40000);
+    };
+
+    bool StreamZipFromDirectory(const std::filesystem::path& sourceRoot, const std::vector<std::filesystem::path>& files, ZipStreamWriter::Sink sink, std::string& error)
+    {
+        ZipStreamWriter writer(std::move(sink));
+        std::vector<std::uint8_t> readBuffer(0x40000);
+
+        if (files.empty())
+            return writer.AddFile(".empty", std::filesystem::path(), readBuffer, error) && writer.Finish(error);
+
+        for (const auto& file : files) {
+            std::error_code relEc;
+            std::string rel = std::filesystem::relative(file, sourceRoot, relEc).generic_string();
+            if (relEc || rel.empty())
+                rel = file.filename().string();
+            if (!writer.AddFile(rel, file, readBuffer, error))
+                return false;
+        }
+        return writer.Finish(error);
+    }
+
+    bool StreamZipFromDirectory(const std::filesystem::path& sourceRoot, const std::vector<std::filesystem::path>& files, StreamPipe& pipe, std::string& error)
+    {
+        return StreamZipFromDirectory(sourceRoot, files, [&pipe](const void* data, size_t size) { return pipe.Write(data, size); }, error);
+    }
+
     bool IsSafeZipRelativePath(const std::string& rawPath)
     {
         if (rawPath.empty())
@@ -370,7 +727,97 @@ namespace {
         return true;
     }
 
-    bool ExtractZipToMountedSaveWithCommits(const std::filesystem::path& archivePath, const std::string& mountedPath, const char* mountName, std::string& error)
+    bool ReadSaveExtraData(const AccountUid& uid, std::uint64_t titleId, FsSaveDataExtraData& out)
+    {
+        FsSaveDataAttribute attr = {};
+        attr.application_id = titleId;
+        attr.uid = uid;
+        attr.save_data_type = FsSaveDataType_Account;
+
+        out = {};
+        return R_SUCCEEDED(fsReadSaveDataFileSystemExtraDataBySaveDataAttribute(&out, sizeof(out), FsSaveDataSpaceId_User, &attr));
+    }
+
+    // Returns the journal size of the account save for titleId, or 0 if it cannot be queried.
+    s64 QuerySaveJournalSize(const AccountUid& uid, std::uint64_t titleId)
+    {
+        FsSaveDataExtraData extra;
+        return ReadSaveExtraData(uid, titleId, extra) ? extra.journal_size : 0;
+    }
+
+    // Batches fsdevCommitDevice calls while restoring a save. Writes are only committed when
+    // the data pending since the last commit would no longer fit in the save's journal.
+    // Without a known journal size every file is committed, which always fits.
+    class SaveCommitBudget {
+    public:
+        SaveCommitBudget(const char* mountName, s64 journalSize)
+            : m_mountName(mountName), m_budget(journalSize > 0 ? static_cast<std::uint64_t>(journalSize) / 4 * 3 : 0) {}
+
+        // Called before writing a file of the given size.
+        bool BeforeFile(std::uint64_t size, std::string& error)
+        {
+            if (m_pending > 0 && m_pending + size + kFileOverhead > m_budget)
+                return Commit(error);
+            return true;
+        }
+
+        // Called before writing a file whose size is only known once it is written
+        // (zip entries with a data descriptor). It may take the whole journal, so
+        // nothing else can be pending when it starts.
+        bool BeforeFileOfUnknownSize(std::string& error)
+        {
+            return Commit(error);
+        }
+
+        bool AfterFile(std::uint64_t written, std::string& error)
+        {
+            m_pending += written + kFileOverhead;
+            // Sizes of streamed entries are only known afterwards, so leave room for the next one.
+            if (m_budget == 0 || m_pending >= m_budget / 2)
+                return Commit(error);
+            return true;
+        }
+
+        bool Commit(std::string& error)
+        {
+            if (m_pending == 0)
+                return true;
+            const Result rc = fsdevCommitDevice(m_mountName);
+            if (R_FAILED(rc)) {
+                error = "Failed to commit imported save file (" + FormatResultHex(rc) + ").";
+                return false;
+            }
+            m_pending = 0;
+            return true;
+        }
+
+    private:
+        // Journal blocks consumed by file creation and metadata updates.
+        static constexpr std::uint64_t kFileOverhead = 0x4000;
+
+        const char* m_mountName;
+        std::uint64_t m_budget;
+        std::uint64_t m_pending = 0;
+    };
+
+    bool PrepareSaveOutputPath(const std::string& mountedPath, const std::string& relPath, bool isDirectory, std::filesystem::path& outPath, std::string& error)
+    {
+        if (!IsSafeZipRelativePath(relPath)) {
+            error = "Save archive contains an invalid path entry.";
+            return false;
+        }
+
+        outPath = std::filesystem::path(mountedPath) / std::filesystem::path(relPath);
+        std::error_code ec;
+        std::filesystem::create_directories(isDirectory ? outPath : outPath.parent_path(), ec);
+        if (ec) {
+            error = isDirectory ? "Failed to prepare save directories." : "Failed to prepare save file directories.";
+            return false;
+        }
+        return true;
+    }
+
+    bool ExtractZipToMountedSave(const std::filesystem::path& archivePath, const std::string& mountedPath, SaveCommitBudget& commits, std::string& error)
     {
         error.clear();
         unzFile unz = unzOpen64(archivePath.string().c_str());
@@ -381,7 +828,7 @@ namespace {
 
         int code = unzGoToFirstFile(unz);
         bool sawEntry = false;
-        std::vector<char> buffer(0x8000);
+        std::vector<char> buffer(0x40000);
         while (code == UNZ_OK) {
             sawEntry = true;
             unz_file_info64 info = {};
@@ -405,26 +852,14 @@ namespace {
 
             const bool isDirectory = !relPath.empty() && relPath.back() == '/';
             if (!relPath.empty() && relPath != ".empty") {
-                if (!IsSafeZipRelativePath(relPath)) {
+                std::filesystem::path outPath;
+                if (!PrepareSaveOutputPath(mountedPath, relPath, isDirectory, outPath, error)) {
                     unzClose(unz);
-                    error = "Save archive contains an invalid path entry.";
                     return false;
                 }
-
-                const std::filesystem::path outPath = std::filesystem::path(mountedPath) / std::filesystem::path(relPath);
-                std::error_code ec;
-                if (isDirectory) {
-                    std::filesystem::create_directories(outPath, ec);
-                    if (ec) {
-                        unzClose(unz);
-                        error = "Failed to prepare save directories.";
-                        return false;
-                    }
-                } else {
-                    std::filesystem::create_directories(outPath.parent_path(), ec);
-                    if (ec) {
+                if (!isDirectory) {
+                    if (!commits.BeforeFile(info.uncompressed_size, error)) {
                         unzClose(unz);
-                        error = "Failed to prepare save file directories.";
                         return false;
                     }
 
@@ -471,11 +906,8 @@ namespace {
                         return false;
                     }
 
-                    // SaveData writes should be committed frequently to avoid journal pressure.
-                    Result commitRc = fsdevCommitDevice(mountName);
-                    if (R_FAILED(commitRc)) {
+                    if (!commits.AfterFile(info.uncompressed_size, error)) {
                         unzClose(unz);
-                        error = "Failed to commit imported save file (" + FormatResultHex(commitRc) + ").";
                         return false;
                     }
                 }
@@ -496,96 +928,360 @@ namespace {
         return true;
     }
 
-    size_t WriteToString(char* ptr, size_t size, size_t numItems, void* userdata)
-    {
-        auto* out = reinterpret_cast<std::string*>(userdata);
-        const size_t total = size * numItems;
-        out->append(ptr, total);
-        return total;
-    }
-
-    void BuildVersionAndRevision(std::string& outVersion, std::string& outRevision)
-    {
-        const std::string raw = inst::config::appVersion;
-        outVersion = raw.empty() ? "0.0" : raw;
-        outRevision = "0";
-
-        const std::size_t firstDot = raw.find('.');
-        if (firstDot == std::string::npos)
-            return;
+    // Sequential reader over an archive arriving through a StreamPipe or already held in memory.
+    // Unread input stays buffered so zlib can consume it in place.
+    class ArchiveReader {
+    public:
+        explicit ArchiveReader(StreamPipe& pipe) : m_pipe(&pipe), m_buffer(0x40000) {}
+        ArchiveReader(const std::uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+        // Returns false at the end of the stream or when the producer failed.
+        bool Fill()
+        {
+            if (m_pos < m_size)
+                return true;
+            if (!m_pipe)
+                return false;
+            m_pos = 0;
+            m_size = 0;
+            const size_t read = m_pipe->Read(m_buffer.data(), m_buffer.size());
+            if (read == CURL_READFUNC_ABORT) {
+                m_failed = true;
+                return false;
+            }
+            m_data = m_buffer.data();
+            m_size = read;
+            return read > 0;
+        }
 
-        const std::size_t secondDot = raw.find('.', firstDot + 1);
-        if (secondDot == std::string::npos) {
-            outVersion = raw;
-            return;
+        bool ReadExact(void* out, size_t size)
+        {
+            auto* dst = static_cast<std::uint8_t*>(out);
+            while (size > 0) {
+                if (!Fill())
+                    return false;
+                const size_t chunk = std::min(size, m_size - m_pos);
+                if (dst) {
+                    std::memcpy(dst, m_data + m_pos, chunk);
+                    dst += chunk;
+                }
+                m_pos += chunk;
+                size -= chunk;
+            }
+            return true;
         }
 
-        outVersion = raw.substr(0, secondDot);
-        const std::string revisionToken = raw.substr(secondDot + 1);
-        if (revisionToken.empty())
-            return;
+        bool Skip(size_t size) { return ReadExact(nullptr, size); }
 
-        std::size_t digitsEnd = 0;
-        while (digitsEnd < revisionToken.size()) {
-            const char c = revisionToken[digitsEnd];
-            if (c < '0' || c > '9')
-                break;
-            digitsEnd++;
-        }
-        if (digitsEnd > 0)
-            outRevision = revisionToken.substr(0, digitsEnd);
-    }
+        std::uint8_t* Data() { return const_cast<std::uint8_t*>(m_data) + m_pos; }
+        size_t Available() const { return m_size - m_pos; }
+        void Consume(size_t size) { m_pos += size; }
+        bool Failed() const { return m_failed; }
 
-    std::vector<std::string> BuildShopHeaders()
-    {
-        std::string themeHeader = "Theme: 0000000000000000000000000000000000000000000000000000000000000000";
-        std::string versionValue;
-        std::string revisionValue;
-        BuildVersionAndRevision(versionValue, revisionValue);
-        std::string versionHeader = "Version: " + versionValue;
-        std::string revisionHeader = "Revision: " + revisionValue;
-        std::string languageHeader = "Language: " + Language::GetShopHeaderLanguage();
-        return {
-            themeHeader,
-            "UID: 0000000000000000000000000000000000000000000000000000000000000000",
-            versionHeader,
-            revisionHeader,
-            languageHeader,
-            "HAUTH: 0",
-            "UAUTH: 0"
-        };
-    }
+    private:
+        StreamPipe* m_pipe = nullptr;
+        std::vector<std::uint8_t> m_buffer;
+        const std::uint8_t* m_data = nullptr;
+        size_t m_pos = 0;
+        size_t m_size = 0;
+        bool m_failed = false;
+    };
 
-    bool HttpGetWithAuth(const std::string& url, const std::string& user, const std::string& pass, long& outCode, std::string& outBody, std::string& error)
-    {
-        outBody.clear();
-        error.clear();
-        outCode = 0;
+    std::uint16_t ReadLe16(const std::uint8_t* p) { return static_cast<std::uint16_t>(p[0] | (p[1] << 8)); }
+    std::uint32_t ReadLe32(const std::uint8_t* p) { return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8) | (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24); }
 
-        if (curl_global_init(CURL_GLOBAL_ALL) != CURLE_OK) {
-            error = "Failed to initialize HTTP client.";
-            return false;
+    // Writes one stored or deflated entry body from the reader to out (or discards it when out is
+    // null), reporting the CRC and size of the data produced.
+    bool StreamZipEntryToFile(ArchiveReader& reader, std::uint16_t method, std::uint32_t compressedSize, bool sizeKnown, FILE* out, std::vector<std::uint8_t>& outBuffer, std::uint32_t& outCrc, std::uint64_t& outWritten, std::string& error)
+    {
+        outCrc = crc32(0L, Z_NULL, 0);
+        outWritten = 0;
+
+        if (method == 0) {
+            std::uint64_t remaining = compressedSize;
+            while (remaining > 0) {
+                if (!reader.Fill()) {
+                    error = "Save archive ended unexpectedly.";
+                    return false;
+                }
+                const size_t chunk = static_cast<size_t>(std::min<std::uint64_t>(remaining, reader.Available()));
+                if (out && std::fwrite(reader.Data(), 1, chunk, out) != chunk) {
+                    error = "Failed while writing save data.";
+                    return false;
+                }
+                outCrc = crc32(outCrc, reader.Data(), static_cast<uInt>(chunk));
+                reader.Consume(chunk);
+                remaining -= chunk;
+                outWritten += chunk;
+            }
+            return true;
         }
 
-        CURL* curl = curl_easy_init();
-        if (!curl) {
-            error = "Failed to initialize HTTP request.";
+        z_stream zs = {};
+        if (inflateInit2(&zs, -MAX_WBITS) != Z_OK) {
+            error = "Failed to initialize save archive decompression.";
             return false;
         }
 
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
-        curl_easy_setopt(curl, CURLOPT_USERAGENT, "tinfoil");
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteToString);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &outBody);
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, 15000L);
-        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, 5000L);
+        std::uint64_t consumed = 0;
+        int zr = Z_OK;
+        while (zr != Z_STREAM_END) {
+            if (!reader.Fill()) {
+                inflateEnd(&zs);
+                error = "Save archive ended unexpectedly.";
+                return false;
+            }
+            size_t available = reader.Available();
+            if (sizeKnown)
+                available = static_cast<size_t>(std::min<std::uint64_t>(available, compressedSize - consumed));
+            zs.next_in = reader.Data();
+            zs.avail_in = static_cast<uInt>(available);
+            zs.next_out = outBuffer.data();
+            zs.avail_out = static_cast<uInt>(outBuffer.size());
+            zr = inflate(&zs, Z_NO_FLUSH);
+            if (zr != Z_OK && zr != Z_STREAM_END) {
+                inflateEnd(&zs);
+                error = "Failed while extracting save archive.";
+                return false;
+            }
 
-        struct curl_slist* headerList = nullptr;
-        const auto headers = BuildShopHeaders();
-        for (const auto& header : headers)
+            const size_t used = available - zs.avail_in;
+            reader.Consume(used);
+            consumed += used;
+            const size_t produced = outBuffer.size() - zs.avail_out;
+            if (produced > 0) {
+                if (out && std::fwrite(outBuffer.data(), 1, produced, out) != produced) {
+                    inflateEnd(&zs);
+                    error = "Failed while writing save data.";
+                    return false;
+                }
+                outCrc = crc32(outCrc, outBuffer.data(), static_cast<uInt>(produced));
+                outWritten += produced;
+            }
+            if (sizeKnown && consumed >= compressedSize && zr != Z_STREAM_END && produced == 0) {
+                inflateEnd(&zs);
+                error = "Save archive entry is truncated.";
+                return false;
+            }
+        }
+        inflateEnd(&zs);
+        return true;
+    }
+
+    // Extracts a zip in a single forward pass over its local headers, so it can be consumed as it
+    // downloads. onFirstEntry runs once the input is known to be a valid archive and before
+    // anything is written.
+    bool StreamZipToMountedSave(ArchiveReader& reader, const std::string& mountedPath, SaveCommitBudget& commits, const std::function<bool(std::string&)>& onFirstEntry, std::string& error)
+    {
+        constexpr std::uint32_t kLocalHeaderSignature = 0x04034b50;
+        constexpr std::uint32_t kCentralHeaderSignature = 0x02014b50;
+        constexpr std::uint32_t kEndOfCentralDirSignature = 0x06054b50;
+        constexpr std::uint32_t kDataDescriptorSignature = 0x08074b50;
+
+        std::vector<std::uint8_t> outBuffer(0x40000);
+        bool sawEntry = false;
+
+        while (true) {
+            std::uint8_t header[30];
+            if (!reader.ReadExact(header, 4)) {
+                error = reader.Failed() ? "Failed to download save archive from server." : "Save archive ended unexpectedly.";
+                return false;
+            }
+            const std::uint32_t signature = ReadLe32(header);
+            if (signature == kCentralHeaderSignature || signature == kEndOfCentralDirSignature)
+                break;
+            if (signature != kLocalHeaderSignature || !reader.ReadExact(header + 4, sizeof(header) - 4)) {
+                error = "Downloaded save archive is not a valid zip.";
+                return false;
+            }
+
+            const std::uint16_t flags = ReadLe16(header + 6);
+            const std::uint16_t method = ReadLe16(header + 8);
+            std::uint32_t crc = ReadLe32(header + 14);
+            const std::uint32_t compressedSize = ReadLe32(header + 18);
+            std::uint32_t uncompressedSize = ReadLe32(header + 22);
+            const std::uint16_t nameLength = ReadLe16(header + 26);
+            const std::uint16_t extraLength = ReadLe16(header + 28);
+            const bool hasDescriptor = (flags & 0x0008) != 0;
+
+            std::string relPath(nameLength, '\0');
+            if (!reader.ReadExact(relPath.data(), nameLength) || !reader.Skip(extraLength)) {
+                error = "Save archive ended unexpectedly.";
+                return false;
+            }
+            std::replace(relPath.begin(), relPath.end(), '\\', '/');
+
+            if ((flags & 0x0001) != 0 || (method != 0 && method != 8) || (method == 0 && hasDescriptor) || compressedSize == 0xFFFFFFFF) {
+                error = "Save archive uses an unsupported zip feature.";
+                return false;
+            }
+
+            if (!sawEntry) {
+                sawEntry = true;
+                if (onFirstEntry && !onFirstEntry(error))
+                    return false;
+            }
+
+            const bool isDirectory = !relPath.empty() && relPath.back() == '/';
+            FILE* out = nullptr;
+            if (!relPath.empty() && relPath != ".empty") {
+                std::filesystem::path outPath;
+                if (!PrepareSaveOutputPath(mountedPath, relPath, isDirectory, outPath, error))
+                    return false;
+                if (!isDirectory) {
+                    if (!(hasDescriptor ? commits.BeforeFileOfUnknownSize(error) : commits.BeforeFile(uncompressedSize, error)))
+                        return false;
+                    out = std::fopen(outPath.string().c_str(), "wb");
+                    if (!out) {
+                        error = "Failed to create file in save data.";
+                        return false;
+                    }
+                }
+            }
+
+            std::uint32_t actualCrc = 0;
+            std::uint64_t written = 0;
+            bool ok = StreamZipEntryToFile(reader, method, compressedSize, !hasDescriptor, out, outBuffer, actualCrc, written, error);
+            if (out && std::fclose(out) != 0 && ok) {
+                error = "Failed while writing save data.";
+                ok = false;
+            }
+            if (!ok)
+                return false;
+
+            if (hasDescriptor) {
+                std::uint8_t descriptor[16];
+                if (!reader.ReadExact(descriptor, 4)) {
+                    error = "Save archive ended unexpectedly.";
+                    return false;
+                }
+                size_t offset = 0;
+                if (ReadLe32(descriptor) == kDataDescriptorSignature) {
+                    if (!reader.ReadExact(descriptor + 4, 12)) {
+                        error = "Save archive ended unexpectedly.";
+                        return false;
+                    }
+                    offset = 4;
+                } else if (!reader.ReadExact(descriptor + 4, 8)) {
+                    error = "Save archive ended unexpectedly.";
+                    return false;
+                }
+                crc = ReadLe32(descriptor + offset);
+                uncompressedSize = ReadLe32(descriptor + offset + 8);
+            }
+
+            if (actualCrc != crc || written != uncompressedSize) {
+                error = "Save archive entry failed its integrity check.";
+                return false;
+            }
+            if (out && !commits.AfterFile(written, error))
+                return false;
+        }
+
+        // The central directory only repeats what the local headers said; drain it so curl finishes.
+        while (reader.Fill())
+            reader.Consume(reader.Available());
+        if (reader.Failed()) {
+            error = "Failed to download save archive from server.";
+            return false;
+        }
+        if (!sawEntry) {
+            error = "Downloaded save archive is empty.";
+            return false;
+        }
+        return true;
+    }
+
+    size_t WriteToString(char* ptr, size_t size, size_t numItems, void* userdata)
+    {
+        auto* out = reinterpret_cast<std::string*>(userdata);
+        const size_t total = size * numItems;
+        out->append(ptr, total);
+        return total;
+    }
+
+    void BuildVersionAndRevision(std::string& outVersion, std::string& outRevision)
+    {
+        const std::string raw = inst::config::appVersion;
+        outVersion = raw.empty() ? "0.0" : raw;
+        outRevision = "0";
+
+        const std::size_t firstDot = raw.find('.');
+        if (firstDot == std::string::npos)
+            return;
+
+        const std::size_t secondDot = raw.find('.', firstDot + 1);
+        if (secondDot == std::string::npos) {
+            outVersion = raw;
+            return;
+        }
+
+        outVersion = raw.substr(0, secondDot);
+        const std::string revisionToken = raw.substr(secondDot + 1);
+        if (revisionToken.empty())
+            return;
+
+        std::size_t digitsEnd = 0;
+        while (digitsEnd < revisionToken.size()) {
+            const char c = revisionToken[digitsEnd];
+            if (c < '0' || c > '9')
+                break;
+            digitsEnd++;
+        }
+        if (digitsEnd > 0)
+            outRevision = revisionToken.substr(0, digitsEnd);
+    }
+
+    std::vector<std::string> BuildShopHeaders()
+    {
+        std::string themeHeader = "Theme: 0000000000000000000000000000000000000000000000000000000000000000";
+        std::string versionValue;
+        std::string revisionValue;
+        BuildVersionAndRevision(versionValue, revisionValue);
+        std::string versionHeader = "Version: " + versionValue;
+        std::string revisionHeader = "Revision: " + revisionValue;
+        std::string languageHeader = "Language: " + Language::GetShopHeaderLanguage();
+        return {
+            themeHeader,
+            "UID: 0000000000000000000000000000000000000000000000000000000000000000",
+            versionHeader,
+            revisionHeader,
+            languageHeader,
+            "HAUTH: 0",
+            "UAUTH: 0"
+        };
+    }
+
+    bool HttpGetWithAuth(const std::string& url, const std::string& user, const std::string& pass, long& outCode, std::string& outBody, std::string& error)
+    {
+        outBody.clear();
+        error.clear();
+        outCode = 0;
+
+        if (!EnsureCurlGlobalInit()) {
+            error = "Failed to initialize HTTP client.";
+            return false;
+        }
+
+        CURL* curl = curl_easy_init();
+        if (!curl) {
+            error = "Failed to initialize HTTP request.";
+            return false;
+        }
+
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+        curl_easy_setopt(curl, CURLOPT_USERAGENT, "tinfoil");
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteToString);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &outBody);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, 15000L);
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, 5000L);
+
+        struct curl_slist* headerList = nullptr;
+        const auto headers = BuildShopHeaders();
+        for (const auto& header : headers)
             headerList = curl_slist_append(headerList, header.c_str());
         if (headerList)
             curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerList);
@@ -628,7 +1324,7 @@ namespace {
         error.clear();
         outCode = 0;
 
-        if (curl_global_init(CURL_GLOBAL_ALL) != CURLE_OK) {
+        if (!EnsureCurlGlobalInit()) {
             error = "Failed to initialize HTTP client.";
             return false;
         }
@@ -761,10 +1457,41 @@ namespace {
         return false;
     }
 
-    bool UploadZipMultipart(const std::string& url, const std::string& zipPath, const std::string& user, const std::string& pass, std::uint64_t titleId, const std::string& note, std::string& error)
+    // Uploads zipPath, or the archive produced into pipe with chunked transfer encoding when pipe is set.
+    // The archive part of an upload: a file on the SD card, a pipe filled while sending, or memory.
+    struct UploadArchive {
+        std::string path;
+        StreamPipe* pipe = nullptr;
+        const std::vector<std::uint8_t>* data = nullptr;
+    };
+
+    struct MemoryUploadCursor {
+        const std::vector<std::uint8_t>* data = nullptr;
+        size_t offset = 0;
+    };
+
+    size_t ReadFromMemoryUpload(char* buffer, size_t size, size_t numItems, void* userdata)
+    {
+        auto* cursor = reinterpret_cast<MemoryUploadCursor*>(userdata);
+        const size_t chunk = std::min(size * numItems, cursor->data->size() - cursor->offset);
+        std::memcpy(buffer, cursor->data->data() + cursor->offset, chunk);
+        cursor->offset += chunk;
+        return chunk;
+    }
+
+    int SeekMemoryUpload(void* userdata, curl_off_t offset, int origin)
+    {
+        auto* cursor = reinterpret_cast<MemoryUploadCursor*>(userdata);
+        if (origin != SEEK_SET || offset < 0 || static_cast<size_t>(offset) > cursor->data->size())
+            return CURL_SEEKFUNC_CANTSEEK;
+        cursor->offset = static_cast<size_t>(offset);
+        return CURL_SEEKFUNC_OK;
+    }
+
+    bool UploadZipMultipart(const std::string& url, const UploadArchive& archive, const std::string& user, const std::string& pass, std::uint64_t titleId, const std::string& note, std::string& error, long* outResponseCode = nullptr, const std::vector<std::pair<std::string, std::string>>& extraFields = {}, CURLSH* share = nullptr)
     {
         error.clear();
-        if (curl_global_init(CURL_GLOBAL_ALL) != CURLE_OK) {
+        if (!EnsureCurlGlobalInit()) {
             error = "Failed to initialize HTTP client.";
             return false;
         }
@@ -784,7 +1511,15 @@ namespace {
         curl_easy_setopt(curl, CURLOPT_USERAGENT, "tinfoil");
         curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteToString);
         curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBody);
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, 60000L);
+        if (share)
+            curl_easy_setopt(curl, CURLOPT_SHARE, share);
+        if (archive.pipe) {
+            // The body is produced while it is sent, so bound stalls rather than total time
+            curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+            curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, 60L);
+        } else {
+            curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, 60000L);
+        }
         curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, 5000L);
 
         struct curl_slist* headerList = nullptr;
@@ -812,7 +1547,13 @@ namespace {
 
         curl_mimepart* part = curl_mime_addpart(mime);
         curl_mime_name(part, "file");
-        curl_mime_filedata(part, zipPath.c_str());
+        MemoryUploadCursor memoryCursor{archive.data};
+        if (archive.pipe)
+            curl_mime_data_cb(part, -1, ReadFromStreamPipe, nullptr, nullptr, archive.pipe);
+        else if (archive.data)
+            curl_mime_data_cb(part, static_cast<curl_off_t>(archive.data->size()), ReadFromMemoryUpload, SeekMemoryUpload, nullptr, &memoryCursor);
+        else
+            curl_mime_filedata(part, archive.path.c_str());
         curl_mime_filename(part, (titleIdText + ".zip").c_str());
 
         part = curl_mime_addpart(mime);
@@ -830,33 +1571,299 @@ namespace {
             curl_mime_data(part, trimmedNote.c_str(), CURL_ZERO_TERMINATED);
         }
 
+        for (const auto& field : extraFields) {
+            part = curl_mime_addpart(mime);
+            curl_mime_name(part, field.first.c_str());
+            curl_mime_data(part, field.second.c_str(), field.second.size());
+        }
+
         curl_easy_setopt(curl, CURLOPT_MIMEPOST, mime);
 
         const CURLcode rc = curl_easy_perform(curl);
         long responseCode = 0;
         curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
-
-        curl_mime_free(mime);
+        if (outResponseCode)
+            *outResponseCode = responseCode;
+
+        curl_mime_free(mime);
+        if (headerList)
+            curl_slist_free_all(headerList);
+        curl_easy_cleanup(curl);
+
+        if (rc != CURLE_OK) {
+            error = "Upload failed: " + std::string(curl_easy_strerror(rc));
+            return false;
+        }
+        if (responseCode < 200 || responseCode >= 300) {
+            if (responseCode == 401 || responseCode == 403) {
+                error = "Save upload is not permitted for this account (backup access required).";
+            } else if (responseCode == 404) {
+                error = "Server does not provide save upload endpoints.";
+            } else {
+                std::ostringstream ss;
+                ss << "Upload failed with HTTP " << responseCode;
+                if (!responseBody.empty())
+                    ss << ": " << responseBody;
+                error = ss.str();
+            }
+            return false;
+        }
+        return true;
+    }
+
+    struct SaveManifestEntry {
+        std::uint64_t size = 0;
+        std::string sha256;
+    };
+
+    // Relative path -> content, ordered so both sides serialise it identically.
+    using SaveManifest = std::map<std::string, SaveManifestEntry>;
+
+    std::string RelativeSavePath(const std::filesystem::path& root, const std::filesystem::path& file)
+    {
+        std::error_code ec;
+        std::string rel = std::filesystem::relative(file, root, ec).generic_string();
+        if (ec || rel.empty())
+            rel = file.filename().string();
+        return rel;
+    }
+
+    bool HashSaveFile(const std::filesystem::path& path, std::vector<std::uint8_t>& buffer, SaveManifestEntry& out)
+    {
+        FILE* in = std::fopen(path.string().c_str(), "rb");
+        if (!in)
+            return false;
+
+        Sha256Context ctx;
+        sha256ContextCreate(&ctx);
+        out.size = 0;
+        size_t read = 0;
+        while ((read = std::fread(buffer.data(), 1, buffer.size(), in)) > 0) {
+            sha256ContextUpdate(&ctx, buffer.data(), read);
+            out.size += read;
+        }
+        const bool ok = !std::ferror(in);
+        std::fclose(in);
+        if (!ok)
+            return false;
+
+        std::array<std::uint8_t, SHA256_HASH_SIZE> hash{};
+        sha256ContextGetHash(&ctx, hash.data());
+        std::ostringstream hex;
+        hex.fill('0');
+        hex << std::hex;
+        for (std::uint8_t b : hash)
+            hex << std::setw(2) << static_cast<int>(b);
+        out.sha256 = hex.str();
+        return true;
+    }
+
+    bool BuildSaveManifest(const std::filesystem::path& root, const std::vector<std::filesystem::path>& files, SaveManifest& manifest, std::string& error)
+    {
+        manifest.clear();
+        std::vector<std::uint8_t> buffer(0x40000);
+        for (const auto& file : files) {
+            SaveManifestEntry entry;
+            if (!HashSaveFile(file, buffer, entry)) {
+                error = "Failed to hash local save file.";
+                return false;
+            }
+            manifest[RelativeSavePath(root, file)] = std::move(entry);
+        }
+        return true;
+    }
+
+    nlohmann::json SaveManifestToJson(const SaveManifest& manifest)
+    {
+        nlohmann::json files = nlohmann::json::array();
+        for (const auto& [path, entry] : manifest)
+            files.push_back({{"path", path}, {"size", entry.size}, {"sha256", entry.sha256}});
+        return files;
+    }
+
+    // Fetches the manifest of a remote backup. Returns false when the server has no delta support.
+    bool FetchRemoteManifest(const std::string& url, const std::string& user, const std::string& pass, SaveManifest& manifest, std::string& outSaveId)
+    {
+        long responseCode = 0;
+        std::string body;
+        std::string error;
+        if (url.empty() || !HttpGetWithAuth(url, user, pass, responseCode, body, error))
+            return false;
+
+        try {
+            nlohmann::json root = nlohmann::json::parse(body);
+            if (!root.is_object() || !root.contains("files") || !root["files"].is_array())
+                return false;
+            TryGetStringByKeys(root, {"save_id", "saveId"}, outSaveId);
+            outSaveId = NormalizeSaveIdToken(outSaveId);
+
+            manifest.clear();
+            for (const auto& file : root["files"]) {
+                std::string path;
+                SaveManifestEntry entry;
+                if (!TryGetStringByKeys(file, {"path"}, path) || !TryGetStringByKeys(file, {"sha256"}, entry.sha256))
+                    return false;
+                if (!IsSafeZipRelativePath(path))
+                    return false;
+                TryGetU64ByKeys(file, {"size"}, entry.size);
+                std::transform(entry.sha256.begin(), entry.sha256.end(), entry.sha256.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+                manifest[path] = std::move(entry);
+            }
+        } catch (...) {
+            return false;
+        }
+        return !outSaveId.empty();
+    }
+
+    size_t WriteToFile(char* ptr, size_t size, size_t numItems, void* userdata)
+    {
+        return std::fwrite(ptr, size, numItems, reinterpret_cast<FILE*>(userdata)) * size;
+    }
+
+    bool HttpPostJsonToFile(const std::string& url, const std::string& user, const std::string& pass, const std::string& jsonBody, const std::filesystem::path& outPath, long& outCode, std::string& error)
+    {
+        error.clear();
+        outCode = 0;
+        FILE* out = std::fopen(outPath.string().c_str(), "wb");
+        if (!out) {
+            error = "Failed to create temporary save archive.";
+            return false;
+        }
+
+        CURL* curl = curl_easy_init();
+        if (!curl) {
+            std::fclose(out);
+            error = "Failed to initialize HTTP request.";
+            return false;
+        }
+
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+        curl_easy_setopt(curl, CURLOPT_USERAGENT, "tinfoil");
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, jsonBody.c_str());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(jsonBody.size()));
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteToFile);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, out);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, 60000L);
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, 5000L);
+
+        struct curl_slist* headerList = nullptr;
+        const auto headers = BuildShopHeaders();
+        for (const auto& header : headers)
+            headerList = curl_slist_append(headerList, header.c_str());
+        headerList = curl_slist_append(headerList, "Content-Type: application/json");
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerList);
+
+        std::string authValue;
+        if (!user.empty() || !pass.empty()) {
+            authValue = user + ":" + pass;
+            curl_easy_setopt(curl, CURLOPT_HTTPAUTH, CURLAUTH_BASIC);
+            curl_easy_setopt(curl, CURLOPT_USERPWD, authValue.c_str());
+        }
+
+        const CURLcode rc = curl_easy_perform(curl);
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &outCode);
+        curl_slist_free_all(headerList);
+        curl_easy_cleanup(curl);
+        std::fclose(out);
+
+        if (rc != CURLE_OK) {
+            error = "Failed to download save changes: " + std::string(curl_easy_strerror(rc));
+            return false;
+        }
+        if (outCode < 200 || outCode >= 300) {
+            std::ostringstream ss;
+            ss << "Save change download returned HTTP " << outCode << ".";
+            error = ss.str();
+            return false;
+        }
+        return true;
+    }
+
+    size_t WriteToStreamPipe(char* ptr, size_t size, size_t numItems, void* userdata)
+    {
+        const size_t total = size * numItems;
+        return reinterpret_cast<StreamPipe*>(userdata)->Write(ptr, total) ? total : 0;
+    }
+
+    struct MemoryDownload {
+        std::vector<std::uint8_t>* data = nullptr;
+        size_t limit = 0;
+        bool overflowed = false;
+    };
+
+    size_t WriteToMemoryDownload(char* ptr, size_t size, size_t numItems, void* userdata)
+    {
+        auto* download = reinterpret_cast<MemoryDownload*>(userdata);
+        const size_t total = size * numItems;
+        if (download->data->size() + total > download->limit) {
+            download->overflowed = true;
+            return 0;
+        }
+        download->data->insert(download->data->end(), ptr, ptr + total);
+        return total;
+    }
+
+    // Downloads a save archive through writeFunc. Streamed downloads are not closed here;
+    // the caller closes the pipe with the result.
+    bool HttpGetArchive(const std::string& url, const std::string& user, const std::string& pass, curl_write_callback writeFunc, void* writeData, std::string& error, CURLSH* share = nullptr)
+    {
+        if (!EnsureCurlGlobalInit()) {
+            error = "Failed to initialize HTTP client.";
+            return false;
+        }
+
+        CURL* curl = curl_easy_init();
+        if (!curl) {
+            error = "Failed to initialize HTTP request.";
+            return false;
+        }
+
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+        curl_easy_setopt(curl, CURLOPT_USERAGENT, "tinfoil");
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeFunc);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, writeData);
+        if (share)
+            curl_easy_setopt(curl, CURLOPT_SHARE, share);
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, 5000L);
+        // Extraction paces the transfer, so only give up on a stalled connection.
+        curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+        curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, 60L);
+
+        struct curl_slist* headerList = nullptr;
+        const auto headers = BuildShopHeaders();
+        for (const auto& header : headers)
+            headerList = curl_slist_append(headerList, header.c_str());
+        if (headerList)
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerList);
+
+        std::string authValue;
+        if (!user.empty() || !pass.empty()) {
+            authValue = user + ":" + pass;
+            curl_easy_setopt(curl, CURLOPT_HTTPAUTH, CURLAUTH_BASIC);
+            curl_easy_setopt(curl, CURLOPT_USERPWD, authValue.c_str());
+        }
+
+        const CURLcode rc = curl_easy_perform(curl);
+        long responseCode = 0;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
         if (headerList)
             curl_slist_free_all(headerList);
         curl_easy_cleanup(curl);
 
         if (rc != CURLE_OK) {
-            error = "Upload failed: " + std::string(curl_easy_strerror(rc));
-            return false;
-        }
-        if (responseCode < 200 || responseCode >= 300) {
-            if (responseCode == 401 || responseCode == 403) {
-                error = "Save upload is not permitted for this account (backup access required).";
-            } else if (responseCode == 404) {
-                error = "Server does not provide save upload endpoints.";
-            } else {
-                std::ostringstream ss;
-                ss << "Upload failed with HTTP " << responseCode;
-                if (!responseBody.empty())
-                    ss << ": " << responseBody;
-                error = ss.str();
-            }
+            std::ostringstream ss;
+            ss << "Failed to download save archive from server";
+            if (responseCode >= 400)
+                ss << " (HTTP " << responseCode << ")";
+            ss << ": " << curl_easy_strerror(rc);
+            error = ss.str();
             return false;
         }
         return true;
@@ -895,6 +1902,414 @@ namespace {
         }
         return true;
     }
+
+    bool IsDeltaUnsupportedResponse(long responseCode)
+    {
+        return responseCode == 404 || responseCode == 405 || responseCode == 411 || responseCode == 501;
+    }
+
+    // Uploads only the files whose hash differs from the latest remote backup, plus the full
+    // local manifest so the server can rebuild the new version and drop deleted files.
+    // attempted stays false when the server has no delta support and a full upload should be used.
+    bool TryUploadSaveDelta(const std::string& shopUrl, const std::string& user, const std::string& pass, const AccountUid& uid, const inst::save_sync::SaveSyncEntry& entry, const std::string& note, bool& attempted, std::string& error)
+    {
+        attempted = false;
+        SaveManifest remoteManifest;
+        std::string baseSaveId;
+        if (!FetchRemoteManifest(BuildManifestUrl(shopUrl, entry.titleId), user, pass, remoteManifest, baseSaveId))
+            return false;
+
+        const std::string mountedPath = std::string(kSaveMountName) + ":/";
+        if (!MountSaveDataForTitle(uid, entry.titleId, true, error)) {
+            attempted = true;
+            return false;
+        }
+
+        std::vector<std::filesystem::path> files;
+        SaveManifest localManifest;
+        if (!CollectSaveFiles(mountedPath, files, error) || !BuildSaveManifest(mountedPath, files, localManifest, error)) {
+            fsdevUnmountDevice(kSaveMountName);
+            attempted = true;
+            return false;
+        }
+
+        std::vector<std::filesystem::path> changed;
+        for (const auto& file : files) {
+            const std::string rel = RelativeSavePath(mountedPath, file);
+            const auto remote = remoteManifest.find(rel);
+            const auto& local = localManifest[rel];
+            if (remote == remoteManifest.end() || remote->second.sha256 != local.sha256 || remote->second.size != local.size)
+                changed.push_back(file);
+        }
+
+        const std::vector<std::pair<std::string, std::string>> fields = {
+            {"manifest", SaveManifestToJson(localManifest).dump()},
+            {"base_save_id", baseSaveId},
+        };
+
+        StreamPipe pipe(0x100000);
+        std::string archiveError;
+        bool archiveOk = false;
+        bool archiveCancelled = false;
+        std::thread producer([&]() {
+            archiveOk = StreamZipFromDirectory(mountedPath, changed, pipe, archiveError);
+            archiveCancelled = pipe.IsCancelled();
+            pipe.Close(archiveOk);
+        });
+
+        long responseCode = 0;
+        const bool uploaded = UploadZipMultipart(BuildDeltaUploadUrl(shopUrl, entry.titleId), UploadArchive{std::string(), &pipe}, user, pass, entry.titleId, note, error, &responseCode, fields);
+        pipe.Cancel();
+        producer.join();
+        fsdevUnmountDevice(kSaveMountName);
+
+        if (!uploaded && IsDeltaUnsupportedResponse(responseCode)) {
+            error.clear();
+            return false;
+        }
+        attempted = true;
+        if (!archiveOk && !archiveCancelled) {
+            error = archiveError;
+            return false;
+        }
+        return uploaded;
+    }
+
+    // Brings the mounted save in line with a remote backup by fetching only the files whose hash
+    // differs and deleting files the backup no longer has.
+    // attempted stays false when the server has no delta support and a full download should be used.
+    bool TryDownloadSaveDelta(const std::string& shopUrl, const std::string& user, const std::string& pass, const AccountUid& uid, const inst::save_sync::SaveSyncEntry& entry, const std::string& saveId, bool& attempted, std::string& error)
+    {
+        attempted = false;
+        SaveManifest remoteManifest;
+        std::string remoteSaveId;
+        if (!FetchRemoteManifest(BuildManifestUrl(shopUrl, entry.titleId, saveId), user, pass, remoteManifest, remoteSaveId))
+            return false;
+        attempted = true;
+
+        const std::string tempRoot = inst::config::appDir + "/save_sync_tmp";
+        const std::filesystem::path archivePath = std::filesystem::path(tempRoot) / (FormatTitleIdHex(entry.titleId) + ".zip");
+        std::error_code ec;
+        std::filesystem::remove_all(tempRoot, ec);
+        std::filesystem::create_directories(tempRoot, ec);
+
+        if (!MountSaveDataForTitle(uid, entry.titleId, false, error))
+            return false;
+
+        const std::string mountedPath = std::string(kSaveMountName) + ":/";
+        std::vector<std::filesystem::path> files;
+        SaveManifest localManifest;
+        if (!CollectSaveFiles(mountedPath, files, error) || !BuildSaveManifest(mountedPath, files, localManifest, error)) {
+            fsdevUnmountDevice(kSaveMountName);
+            return false;
+        }
+
+        nlohmann::json wanted = nlohmann::json::array();
+        for (const auto& [path, remote] : remoteManifest) {
+            const auto local = localManifest.find(path);
+            if (local == localManifest.end() || local->second.sha256 != remote.sha256 || local->second.size != remote.size)
+                wanted.push_back(path);
+        }
+
+        for (const auto& [path, local] : localManifest) {
+            if (remoteManifest.count(path) != 0)
+                continue;
+            std::filesystem::remove(std::filesystem::path(mountedPath) / path, ec);
+            if (ec) {
+                fsdevUnmountDevice(kSaveMountName);
+                error = "Failed to remove stale save file.";
+                return false;
+            }
+        }
+
+        if (!wanted.empty()) {
+            long responseCode = 0;
+            const nlohmann::json request = {{"paths", wanted}};
+            if (!HttpPostJsonToFile(BuildDeltaDownloadUrl(shopUrl, entry.titleId, remoteSaveId), user, pass, request.dump(), archivePath, responseCode, error)) {
+                fsdevUnmountDevice(kSaveMountName);
+                return false;
+            }
+            SaveCommitBudget commits(kSaveMountName, QuerySaveJournalSize(uid, entry.titleId));
+            if (!ExtractZipToMountedSave(archivePath, mountedPath, commits, error)) {
+                fsdevUnmountDevice(kSaveMountName);
+                return false;
+            }
+        }
+
+        Result rc = fsdevCommitDevice(kSaveMountName);
+        fsdevUnmountDevice(kSaveMountName);
+        if (R_FAILED(rc)) {
+            error = "Failed to commit imported save data (" + FormatResultHex(rc) + ").";
+            return false;
+        }
+
+        std::filesystem::remove_all(tempRoot, ec);
+        return true;
+    }
+
+    bool ClearMountedSave(const std::string& mountedPath, std::string& error)
+    {
+        if (!ClearDirectoryContents(mountedPath, error))
+            return false;
+        Result clearCommitRc = fsdevCommitDevice(kSaveMountName);
+        if (R_FAILED(clearCommitRc)) {
+            error = "Failed to commit cleared save data (" + FormatResultHex(clearCommitRc) + ").";
+            return false;
+        }
+        return true;
+    }
+
+    // Replaces the save of titleId with the archive read from reader. The existing save is only
+    // cleared once a valid archive has started arriving, so an unreachable server leaves it untouched.
+    bool RestoreArchiveToSave(const AccountUid& uid, std::uint64_t titleId, ArchiveReader& reader, bool& cleared, std::string& error)
+    {
+        cleared = false;
+        if (!MountSaveDataForTitle(uid, titleId, false, error))
+            return false;
+
+        const std::string mountedPath = std::string(kSaveMountName) + ":/";
+        SaveCommitBudget commits(kSaveMountName, QuerySaveJournalSize(uid, titleId));
+        const bool extracted = StreamZipToMountedSave(reader, mountedPath, commits, [&](std::string& clearError) {
+            cleared = true;
+            return ClearMountedSave(mountedPath, clearError);
+        }, error);
+        if (!extracted) {
+            fsdevUnmountDevice(kSaveMountName);
+            return false;
+        }
+
+        Result rc = fsdevCommitDevice(kSaveMountName);
+        fsdevUnmountDevice(kSaveMountName);
+        if (R_FAILED(rc)) {
+            error = "Failed to commit imported save data (" + FormatResultHex(rc) + ").";
+            return false;
+        }
+        return true;
+    }
+
+    // Connection cache, DNS cache and TLS sessions shared by the transfers of a batch, so
+    // concurrent uploads and downloads reuse a small pool of connections to the shop.
+    class CurlSharePool {
+    public:
+        CurlSharePool()
+        {
+            m_share = curl_share_init();
+            if (!m_share)
+                return;
+            curl_share_setopt(m_share, CURLSHOPT_LOCKFUNC, Lock);
+            curl_share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, Unlock);
+            curl_share_setopt(m_share, CURLSHOPT_USERDATA, this);
+            curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+            curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        }
+
+        ~CurlSharePool()
+        {
+            if (m_share)
+                curl_share_cleanup(m_share);
+        }
+
+        CurlSharePool(const CurlSharePool&) = delete;
+        CurlSharePool& operator=(const CurlSharePool&) = delete;
+
+        CURLSH* Get() const { return m_share; }
+
+    private:
+        static void Lock(CURL*, curl_lock_data data, curl_lock_access, void* userptr)
+        {
+            reinterpret_cast<CurlSharePool*>(userptr)->m_locks[data].lock();
+        }
+
+        static void Unlock(CURL*, curl_lock_data data, void* userptr)
+        {
+            reinterpret_cast<CurlSharePool*>(userptr)->m_locks[data].unlock();
+        }
+
+        CURLSH* m_share = nullptr;
+        std::array<std::mutex, CURL_LOCK_DATA_LAST> m_locks;
+    };
+
+    // Runs the network half of a batch on worker threads while the calling thread does the fs
+    // half, which has to stay serialised on the single save mount. Finished transfers are
+    // handed back to the calling thread, so completion handlers may touch the UI.
+    class SaveBatchTransfers {
+    public:
+        using Job = std::function<bool(CURLSH* share, std::string& error)>;
+        using DoneFunc = std::function<void(std::size_t id, bool ok, const std::string& error)>;
+
+        SaveBatchTransfers(std::size_t workerCount, std::uint64_t memoryBudget, DoneFunc onDone)
+            : m_memoryBudget(memoryBudget), m_onDone(std::move(onDone))
+        {
+            for (std::size_t i = 0; i < workerCount; i++)
+                m_workers.emplace_back([this]() { WorkerLoop(); });
+        }
+
+        ~SaveBatchTransfers()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stopping = true;
+            }
+            m_cv.notify_all();
+            for (auto& worker : m_workers)
+                worker.join();
+        }
+
+        // Queues a transfer that holds bytes of memory until its completion has been handled.
+        // Blocks while the batch is over its memory budget, handling finished transfers meanwhile.
+        void Submit(std::size_t id, std::uint64_t bytes, Job job)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (m_inFlightBytes > 0 && m_inFlightBytes + bytes > m_memoryBudget)
+                HandleOneDone(lock);
+            m_inFlightBytes += bytes;
+            m_pending.push_back({id, bytes, std::move(job)});
+            m_outstanding++;
+            m_cv.notify_all();
+        }
+
+        // Handles transfers that have already finished without waiting for the rest.
+        void Poll()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (!m_done.empty())
+                HandleOneDone(lock);
+        }
+
+        void WaitAll()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (m_outstanding > 0)
+                HandleOneDone(lock);
+        }
+
+    private:
+        struct Task {
+            std::size_t id = 0;
+            std::uint64_t bytes = 0;
+            Job job;
+        };
+
+        struct Done {
+            std::size_t id = 0;
+            std::uint64_t bytes = 0;
+            bool ok = false;
+            std::string error;
+        };
+
+        void WorkerLoop()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (true) {
+                m_cv.wait(lock, [&] { return m_stopping || !m_pending.empty(); });
+                if (m_pending.empty())
+                    return;
+                Task task = std::move(m_pending.front());
+                m_pending.pop_front();
+                lock.unlock();
+
+                Done done{task.id, task.bytes};
+                done.ok = task.job(m_pool.Get(), done.error);
+                task.job = nullptr;
+
+                lock.lock();
+                m_done.push_back(std::move(done));
+                m_doneCv.notify_all();
+            }
+        }
+
+        // Called with the lock held; drops it while the completion handler runs.
+        void HandleOneDone(std::unique_lock<std::mutex>& lock)
+        {
+            m_doneCv.wait(lock, [&] { return !m_done.empty(); });
+            Done done = std::move(m_done.front());
+            m_done.pop_front();
+            lock.unlock();
+            m_onDone(done.id, done.ok, done.error);
+            lock.lock();
+            m_inFlightBytes -= done.bytes;
+            m_outstanding--;
+        }
+
+        CurlSharePool m_pool;
+        std::uint64_t m_memoryBudget;
+        DoneFunc m_onDone;
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::condition_variable m_doneCv;
+        std::deque<Task> m_pending;
+        std::deque<Done> m_done;
+        std::uint64_t m_inFlightBytes = 0;
+        std::size_t m_outstanding = 0;
+        bool m_stopping = false;
+        std::vector<std::thread> m_workers;
+    };
+
+    constexpr std::size_t kBatchTransferWorkers = 3;
+    // Archives of a batch are held in memory between the fs and network stages.
+    constexpr std::uint64_t kBatchMemoryBudget = 0x3000000;
+    // Saves larger than this bypass the pipeline and use the single-title streaming path.
+    constexpr std::uint64_t kBatchMaxBufferedArchive = 0x1000000;
+
+    enum class BatchPackResult {
+        Packed,
+        TooLarge,
+        Failed,
+    };
+
+    // Zips the save of titleId into memory for the upload stage of a batch.
+    BatchPackResult PackSaveToMemory(const AccountUid& uid, std::uint64_t titleId, std::vector<std::uint8_t>& out, std::string& error)
+    {
+        if (!MountSaveDataForTitle(uid, titleId, true, error))
+            return BatchPackResult::Failed;
+
+        const std::string mountedPath = std::string(kSaveMountName) + ":/";
+        std::vector<std::filesystem::path> files;
+        if (!CollectSaveFiles(mountedPath, files, error)) {
+            fsdevUnmountDevice(kSaveMountName);
+            return BatchPackResult::Failed;
+        }
+
+        std::uint64_t totalSize = 0;
+        for (const auto& file : files) {
+            std::error_code ec;
+            totalSize += std::filesystem::file_size(file, ec);
+        }
+        if (totalSize > kBatchMaxBufferedArchive) {
+            fsdevUnmountDevice(kSaveMountName);
+            return BatchPackResult::TooLarge;
+        }
+
+        out.clear();
+        const bool packed = StreamZipFromDirectory(mountedPath, files, [&out](const void* data, size_t size) {
+            const auto* bytes = static_cast<const std::uint8_t*>(data);
+            out.insert(out.end(), bytes, bytes + size);
+            return true;
+        }, error);
+        fsdevUnmountDevice(kSaveMountName);
+        return packed ? BatchPackResult::Packed : BatchPackResult::Failed;
+    }
+
+    bool ResolveDownloadUrl(const std::string& shopUrl, const inst::save_sync::SaveSyncEntry& entry, const inst::save_sync::SaveSyncRemoteVersion* remoteVersion, std::string& outUrl, std::string& outSaveId)
+    {
+        if (!remoteVersion && !entry.remoteVersions.empty())
+            remoteVersion = &entry.remoteVersions.front();
+
+        outSaveId.clear();
+        outUrl = entry.remoteDownloadUrl;
+        if (remoteVersion) {
+            if (!remoteVersion->saveId.empty())
+                outSaveId = remoteVersion->saveId;
+            if (!remoteVersion->downloadUrl.empty())
+                outUrl = remoteVersion->downloadUrl;
+        }
+        if (outUrl.empty())
+            outUrl = BuildDownloadUrl(shopUrl, entry.titleId, outSaveId);
+        if (outUrl.empty())
+            outUrl = BuildDownloadUrl(shopUrl, entry.titleId);
+        return !outUrl.empty();
+    }
 }
 
 namespace inst::save_sync {
@@ -1083,14 +2498,63 @@ namespace inst::save_sync {
         if (!ResolveActiveUser(uid, error))
             return false;
 
+        const std::string uploadUrl = BuildUploadUrl(shopUrl, entry.titleId);
+        if (uploadUrl.empty()) {
+            error = "Shop URL is not configured.";
+            return false;
+        }
+
+        if (inst::config::saveSyncDelta && entry.remoteAvailable) {
+            bool attempted = false;
+            const bool uploaded = TryUploadSaveDelta(shopUrl, user, pass, uid, entry, note, attempted, error);
+            if (attempted)
+                return uploaded;
+        }
+
+        const std::string mountedPath = std::string(kSaveMountName) + ":/";
+
+        if (inst::config::saveSyncStreamUpload) {
+            if (!MountSaveDataForTitle(uid, entry.titleId, true, error))
+                return false;
+
+            std::vector<std::filesystem::path> files;
+            if (!CollectSaveFiles(mountedPath, files, error)) {
+                fsdevUnmountDevice(kSaveMountName);
+                return false;
+            }
+
+            // Compress on a worker while curl sends what is already done; nothing touches the SD card.
+            StreamPipe pipe(0x100000);
+            std::string archiveError;
+            bool archiveOk = false;
+            bool archiveCancelled = false;
+            std::thread producer([&]() {
+                archiveOk = StreamZipFromDirectory(mountedPath, files, pipe, archiveError);
+                archiveCancelled = pipe.IsCancelled();
+                pipe.Close(archiveOk);
+            });
+
+            long responseCode = 0;
+            const bool uploaded = UploadZipMultipart(uploadUrl, UploadArchive{std::string(), &pipe}, user, pass, entry.titleId, note, error, &responseCode);
+            pipe.Cancel();
+            producer.join();
+            fsdevUnmountDevice(kSaveMountName);
+
+            if (!archiveOk && !archiveCancelled) {
+                error = archiveError;
+                return false;
+            }
+            // Servers that insist on a Content-Length get the archive from a temporary file instead.
+            if (uploaded || responseCode != 411)
+                return uploaded;
+        }
+
         const std::string tempRoot = inst::config::appDir + "/save_sync_tmp";
         const std::filesystem::path archivePath = std::filesystem::path(tempRoot) / (FormatTitleIdHex(entry.titleId) + ".zip");
         std::error_code ec;
         std::filesystem::remove_all(tempRoot, ec);
         std::filesystem::create_directories(tempRoot, ec);
 
-        const std::string mountedPath = std::string(kSaveMountName) + ":/";
-
         if (!MountSaveDataForTitle(uid, entry.titleId, true, error))
             return false;
 
@@ -1101,13 +2565,7 @@ namespace inst::save_sync {
 
         fsdevUnmountDevice(kSaveMountName);
 
-        const std::string uploadUrl = BuildUploadUrl(shopUrl, entry.titleId);
-        if (uploadUrl.empty()) {
-            error = "Shop URL is not configured.";
-            return false;
-        }
-
-        if (!UploadZipMultipart(uploadUrl, archivePath.string(), user, pass, entry.titleId, note, error))
+        if (!UploadZipMultipart(uploadUrl, UploadArchive{archivePath.string()}, user, pass, entry.titleId, note, error))
             return false;
 
         std::filesystem::remove_all(tempRoot, ec);
@@ -1126,27 +2584,50 @@ namespace inst::save_sync {
             return false;
         }
 
-        const SaveSyncRemoteVersion* selectedRemoteVersion = remoteVersion;
-        if (!selectedRemoteVersion && !entry.remoteVersions.empty())
-            selectedRemoteVersion = &entry.remoteVersions.front();
-
         std::string selectedSaveId;
-        std::string downloadUrl = entry.remoteDownloadUrl;
-        if (selectedRemoteVersion) {
-            if (!selectedRemoteVersion->saveId.empty())
-                selectedSaveId = selectedRemoteVersion->saveId;
-            if (!selectedRemoteVersion->downloadUrl.empty())
-                downloadUrl = selectedRemoteVersion->downloadUrl;
-        }
-        if (downloadUrl.empty())
-            downloadUrl = BuildDownloadUrl(shopUrl, entry.titleId, selectedSaveId);
-        if (downloadUrl.empty())
-            downloadUrl = BuildDownloadUrl(shopUrl, entry.titleId);
-        if (downloadUrl.empty()) {
+        std::string downloadUrl;
+        if (!ResolveDownloadUrl(shopUrl, entry, remoteVersion, downloadUrl, selectedSaveId)) {
             error = "No download URL available for this save.";
             return false;
         }
 
+        AccountUid uid = {};
+        if (!ResolveActiveUser(uid, error))
+            return false;
+
+        if (inst::config::saveSyncDelta) {
+            bool attempted = false;
+            const bool restored = TryDownloadSaveDelta(shopUrl, user, pass, uid, entry, selectedSaveId, attempted, error);
+            if (attempted)
+                return restored;
+        }
+
+        if (inst::config::saveSyncStreamRestore) {
+            // Extract while downloading; nothing is staged on the SD card.
+            StreamPipe pipe(0x100000);
+            std::string downloadError;
+            bool downloadOk = false;
+            std::thread downloader([&]() {
+                downloadOk = HttpGetArchive(downloadUrl, user, pass, WriteToStreamPipe, &pipe, downloadError);
+                pipe.Close(downloadOk);
+            });
+
+            ArchiveReader reader(pipe);
+            bool cleared = false;
+            const bool restored = RestoreArchiveToSave(uid, entry.titleId, reader, cleared, error);
+            const bool downloadFailed = pipe.IsFailed();
+            pipe.Cancel();
+            downloader.join();
+
+            if (!restored) {
+                if (downloadFailed && !downloadError.empty())
+                    error = downloadError;
+                if (cleared)
+                    error += " The local save may be incomplete; retry the download.";
+            }
+            return restored;
+        }
+
         const std::string tempRoot = inst::config::appDir + "/save_sync_tmp";
         const std::filesystem::path archivePath = std::filesystem::path(tempRoot) / (FormatTitleIdHex(entry.titleId) + ".zip");
         std::error_code ec;
@@ -1158,26 +2639,17 @@ namespace inst::save_sync {
             return false;
         }
 
-        AccountUid uid = {};
-        if (!ResolveActiveUser(uid, error))
-            return false;
-
         if (!MountSaveDataForTitle(uid, entry.titleId, false, error))
             return false;
 
         const std::string mountedPath = std::string(kSaveMountName) + ":/";
-        if (!ClearDirectoryContents(mountedPath, error)) {
-            fsdevUnmountDevice(kSaveMountName);
-            return false;
-        }
-        Result clearCommitRc = fsdevCommitDevice(kSaveMountName);
-        if (R_FAILED(clearCommitRc)) {
+        if (!ClearMountedSave(mountedPath, error)) {
             fsdevUnmountDevice(kSaveMountName);
-            error = "Failed to commit cleared save data (" + FormatResultHex(clearCommitRc) + ").";
             return false;
         }
 
-        if (!ExtractZipToMountedSaveWithCommits(archivePath, mountedPath, kSaveMountName, error)) {
+        SaveCommitBudget commits(kSaveMountName, QuerySaveJournalSize(uid, entry.titleId));
+        if (!ExtractZipToMountedSave(archivePath, mountedPath, commits, error)) {
             fsdevUnmountDevice(kSaveMountName);
             return false;
         }
@@ -1243,4 +2715,172 @@ namespace inst::save_sync {
 
         return true;
     }
+
+    bool BackupAllSaves(const std::string& shopUrl, const std::string& user, const std::string& pass, const std::vector<SaveSyncEntry>& entries, const std::string& note, const SaveSyncBatchProgress& progress, std::vector<SaveSyncBatchResult>& results, std::string& error)
+    {
+        error.clear();
+        results.clear();
+        if (NormalizeShopUrl(shopUrl).empty()) {
+            error = "Shop URL is not configured.";
+            return false;
+        }
+        AccountUid uid = {};
+        if (!ResolveActiveUser(uid, error))
+            return false;
+
+        std::vector<const SaveSyncEntry*> targets;
+        for (const auto& entry : entries) {
+            if (entry.titleId != 0 && entry.localAvailable)
+                targets.push_back(&entry);
+        }
+
+        results.assign(targets.size(), SaveSyncBatchResult{});
+        std::size_t finished = 0;
+        const auto report = [&](std::size_t index, const std::string& status) {
+            if (progress)
+                progress(*targets[index], status, finished, targets.size());
+        };
+        const auto finish = [&](std::size_t index, bool ok, const std::string& error) {
+            results[index].titleId = targets[index]->titleId;
+            results[index].titleName = targets[index]->titleName;
+            results[index].ok = ok;
+            results[index].error = error;
+            finished++;
+            report(index, ok ? "Uploaded" : "Failed: " + error);
+        };
+
+        std::vector<std::shared_ptr<std::vector<std::uint8_t>>> archives(targets.size());
+        SaveBatchTransfers transfers(kBatchTransferWorkers, kBatchMemoryBudget, [&](std::size_t index, bool ok, const std::string& uploadError) {
+            archives[index].reset();
+            finish(index, ok, uploadError);
+        });
+
+        for (std::size_t i = 0; i < targets.size(); i++) {
+            transfers.Poll();
+            const SaveSyncEntry& entry = *targets[i];
+            report(i, "Packing save");
+
+            auto archive = std::make_shared<std::vector<std::uint8_t>>();
+            std::string packError;
+            const BatchPackResult packed = PackSaveToMemory(uid, entry.titleId, *archive, packError);
+            if (packed == BatchPackResult::TooLarge) {
+                report(i, "Uploading large save");
+                std::string uploadError;
+                const bool ok = UploadSaveToServer(shopUrl, user, pass, entry, note, uploadError);
+                finish(i, ok, uploadError);
+                continue;
+            }
+            if (packed == BatchPackResult::Failed) {
+                finish(i, false, packError);
+                continue;
+            }
+
+            archives[i] = archive;
+            const std::string uploadUrl = BuildUploadUrl(shopUrl, entry.titleId);
+            const std::uint64_t titleId = entry.titleId;
+            transfers.Submit(i, archive->size(), [&, archive, uploadUrl, titleId](CURLSH* share, std::string& uploadError) {
+                return UploadZipMultipart(uploadUrl, UploadArchive{std::string(), nullptr, archive.get()}, user, pass, titleId, note, uploadError, nullptr, {}, share);
+            });
+        }
+        transfers.WaitAll();
+        return true;
+    }
+
+    bool RestoreNewerSaves(const std::string& shopUrl, const std::string& user, const std::string& pass, const std::vector<SaveSyncEntry>& entries, const SaveSyncBatchProgress& progress, std::vector<SaveSyncBatchResult>& results, std::string& error)
+    {
+        error.clear();
+        results.clear();
+        AccountUid uid = {};
+        if (!ResolveActiveUser(uid, error))
+            return false;
+
+        // Only titles whose newest backup was made after the local save was last committed.
+        std::vector<const SaveSyncEntry*> targets;
+        for (const auto& entry : entries) {
+            if (entry.titleId == 0 || !entry.localAvailable || entry.remoteVersions.empty())
+                continue;
+            FsSaveDataExtraData extra;
+            const std::uint64_t remoteTs = entry.remoteVersions.front().createdTs;
+            if (remoteTs != 0 && ReadSaveExtraData(uid, entry.titleId, extra) && remoteTs > extra.timestamp)
+                targets.push_back(&entry);
+        }
+
+        results.assign(targets.size(), SaveSyncBatchResult{});
+        std::size_t finished = 0;
+        const auto report = [&](std::size_t index, const std::string& status) {
+            if (progress)
+                progress(*targets[index], status, finished, targets.size());
+        };
+        const auto finish = [&](std::size_t index, bool ok, const std::string& restoreError) {
+            results[index].titleId = targets[index]->titleId;
+            results[index].titleName = targets[index]->titleName;
+            results[index].ok = ok;
+            results[index].error = restoreError;
+            finished++;
+            report(index, ok ? "Restored" : "Failed: " + restoreError);
+        };
+
+        std::vector<std::shared_ptr<std::vector<std::uint8_t>>> archives(targets.size());
+        std::vector<char> overflowed(targets.size(), 0);
+        std::vector<std::size_t> direct;
+        {
+            SaveBatchTransfers transfers(kBatchTransferWorkers, kBatchMemoryBudget, [&](std::size_t index, bool ok, const std::string& downloadError) {
+                std::shared_ptr<std::vector<std::uint8_t>> archive = std::move(archives[index]);
+                if (!ok) {
+                    if (overflowed[index])
+                        direct.push_back(index);
+                    else
+                        finish(index, false, downloadError);
+                    return;
+                }
+
+                report(index, "Restoring save");
+                ArchiveReader reader(archive->data(), archive->size());
+                bool cleared = false;
+                std::string restoreError;
+                const bool restored = RestoreArchiveToSave(uid, targets[index]->titleId, reader, cleared, restoreError);
+                if (!restored && cleared)
+                    restoreError += " The local save may be incomplete; retry the download.";
+                finish(index, restored, restoreError);
+            });
+
+            for (std::size_t i = 0; i < targets.size(); i++) {
+                transfers.Poll();
+                const SaveSyncEntry& entry = *targets[i];
+                const std::uint64_t size = entry.remoteVersions.front().size;
+                std::string downloadUrl;
+                std::string saveId;
+                if (!ResolveDownloadUrl(shopUrl, entry, nullptr, downloadUrl, saveId)) {
+                    finish(i, false, "No download URL available for this save.");
+                    continue;
+                }
+                if (size == 0 || size > kBatchMaxBufferedArchive) {
+                    direct.push_back(i);
+                    continue;
+                }
+
+                report(i, "Downloading");
+                archives[i] = std::make_shared<std::vector<std::uint8_t>>();
+                archives[i]->reserve(size);
+                auto archive = archives[i];
+                char* overflow = &overflowed[i];
+                transfers.Submit(i, size, [&, archive, downloadUrl, overflow](CURLSH* share, std::string& downloadError) {
+                    MemoryDownload download{archive.get(), kBatchMaxBufferedArchive};
+                    const bool ok = HttpGetArchive(downloadUrl, user, pass, WriteToMemoryDownload, &download, downloadError, share);
+                    *overflow = download.overflowed;
+                    return ok;
+                });
+            }
+            transfers.WaitAll();
+        }
+
+        // Large or unsized backups stream straight into the save one at a time.
+        for (std::size_t index : direct) {
+            report(index, "Restoring large save");
+            std::string restoreError;
+            const bool ok = DownloadSaveToConsole(shopUrl, user, pass, *targets[index], nullptr, restoreError);
+            finish(index, ok, restoreError);
+        }
+        return true;
+    }
 }
@@ -0,0 +1,216 @@
+#include "util/status_service.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <switch.h>
+#include "util/error.hpp"
+
+namespace inst::status
+{
+    namespace {
+        constexpr auto kSampleInterval = std::chrono::seconds(1);
+
+        std::mutex g_snapshotMutex;
+        Snapshot g_snapshot;
+        std::atomic<std::uint64_t> g_generation{0};
+
+        std::mutex g_wakeMutex;
+        std::condition_variable g_wakeCv;
+        bool g_stopRequested = false;
+        bool g_storageRefreshRequested = false;
+        std::thread g_thread;
+
+        struct Sessions {
+            bool time = false;
+            bool nifm = false;
+            bool psm = false;
+            bool ncm = false;
+            bool sdNotifier = false;
+            FsEventNotifier sdDetectNotifier{};
+            Event sdDetectEvent{};
+        };
+
+        void OpenSessions(Sessions& sessions)
+        {
+            sessions.time = R_SUCCEEDED(timeInitialize());
+            sessions.nifm = R_SUCCEEDED(nifmInitialize(NifmServiceType_User));
+            sessions.psm = R_SUCCEEDED(psmInitialize());
+            sessions.ncm = R_SUCCEEDED(ncmInitialize());
+            if (R_SUCCEEDED(fsOpenSdCardDetectionEventNotifier(&sessions.sdDetectNotifier))) {
+                if (R_SUCCEEDED(fsEventNotifierGetEventHandle(&sessions.sdDetectNotifier, &sessions.sdDetectEvent, true)))
+                    sessions.sdNotifier = true;
+                else
+                    fsEventNotifierClose(&sessions.sdDetectNotifier);
+            }
+            LOG_DEBUG("Status service sessions: time=%d nifm=%d psm=%d ncm=%d sd_notifier=%d\n",
+                sessions.time, sessions.nifm, sessions.psm, sessions.ncm, sessions.sdNotifier);
+        }
+
+        void CloseSessions(Sessions& sessions)
+        {
+            if (sessions.sdNotifier) {
+                eventClose(&sessions.sdDetectEvent);
+                fsEventNotifierClose(&sessions.sdDetectNotifier);
+                sessions.sdNotifier = false;
+            }
+            if (sessions.ncm) ncmExit();
+            if (sessions.psm) psmExit();
+            if (sessions.nifm) nifmExit();
+            if (sessions.time) timeExit();
+            sessions = Sessions{};
+        }
+
+        void SampleTime(const Sessions& sessions, Snapshot& snapshot)
+        {
+            snapshot.timeText = "--:--";
+            if (!sessions.time)
+                return;
+            u64 posix = 0;
+            if (R_FAILED(timeGetCurrentTime(TimeType_LocalSystemClock, &posix)))
+                return;
+            std::time_t t = static_cast<std::time_t>(posix);
+            std::tm* local = std::localtime(&t);
+            char buf[16] = {0};
+            if (local && std::strftime(buf, sizeof(buf), "%I:%M %p", local) > 0)
+                snapshot.timeText = buf;
+        }
+
+        void SampleNetwork(const Sessions& sessions, Snapshot& snapshot)
+        {
+            snapshot.internetUp = false;
+            snapshot.wifiConnected = false;
+            snapshot.wifiStrength = 0;
+            if (!sessions.nifm)
+                return;
+            NifmInternetConnectionStatus status = static_cast<NifmInternetConnectionStatus>(0);
+            NifmInternetConnectionType type = static_cast<NifmInternetConnectionType>(0);
+            u32 wifiStrength = 0;
+            if (R_SUCCEEDED(nifmGetInternetConnectionStatus(&type, &wifiStrength, &status))) {
+                snapshot.internetUp = (status == NifmInternetConnectionStatus_Connected);
+                snapshot.wifiConnected = snapshot.internetUp && (type == NifmInternetConnectionType_WiFi);
+                snapshot.wifiStrength = wifiStrength;
+            }
+        }
+
+        void SampleBattery(const Sessions& sessions, Snapshot& snapshot)
+        {
+            snapshot.batteryPct = -1;
+            if (!sessions.psm)
+                return;
+            u32 pct = 0;
+            if (R_SUCCEEDED(psmGetBatteryChargePercentage(&pct)))
+                snapshot.batteryPct = static_cast<int>(pct);
+        }
+
+        void SampleStorage(const Sessions& sessions, Snapshot& snapshot)
+        {
+            snapshot.systemTotal = snapshot.systemFree = 0;
+            snapshot.sdTotal = snapshot.sdFree = 0;
+            if (!sessions.ncm)
+                return;
+            NcmContentStorage storage{};
+            if (R_SUCCEEDED(ncmOpenContentStorage(&storage, NcmStorageId_BuiltInUser))) {
+                ncmContentStorageGetTotalSpaceSize(&storage, &snapshot.systemTotal);
+                ncmContentStorageGetFreeSpaceSize(&storage, &snapshot.systemFree);
+                ncmContentStorageClose(&storage);
+            }
+            if (R_SUCCEEDED(ncmOpenContentStorage(&storage, NcmStorageId_SdCard))) {
+                ncmContentStorageGetTotalSpaceSize(&storage, &snapshot.sdTotal);
+                ncmContentStorageGetFreeSpaceSize(&storage, &snapshot.sdFree);
+                ncmContentStorageClose(&storage);
+            }
+        }
+
+        void Publish(const Snapshot& snapshot)
+        {
+            {
+                std::lock_guard<std::mutex> lock(g_snapshotMutex);
+                g_snapshot = snapshot;
+                g_snapshot.generation = g_generation.load(std::memory_order_relaxed) + 1;
+            }
+            g_generation.fetch_add(1, std::memory_order_release);
+        }
+
+        void SamplerThread()
+        {
+            Sessions sessions;
+            OpenSessions(sessions);
+
+            Snapshot snapshot;
+            bool refreshStorage = true;
+            while (true) {
+                // The SD card detection event fires on insertion/removal, which changes what the SD card storage reports.
+                if (sessions.sdNotifier && R_SUCCEEDED(eventWait(&sessions.sdDetectEvent, 0)))
+                    refreshStorage = true;
+
+                SampleTime(sessions, snapshot);
+                SampleNetwork(sessions, snapshot);
+                SampleBattery(sessions, snapshot);
+                if (refreshStorage) {
+                    SampleStorage(sessions, snapshot);
+                    refreshStorage = false;
+                }
+                Publish(snapshot);
+
+                std::unique_lock<std::mutex> lock(g_wakeMutex);
+                g_wakeCv.wait_for(lock, kSampleInterval, [] { return g_stopRequested || g_storageRefreshRequested; });
+                if (g_stopRequested)
+                    break;
+                if (g_storageRefreshRequested) {
+                    g_storageRefreshRequested = false;
+                    refreshStorage = true;
+                }
+            }
+
+            CloseSessions(sessions);
+        }
+    }
+
+    void Start()
+    {
+        if (g_thread.joinable())
+            return;
+        {
+            std::lock_guard<std::mutex> lock(g_wakeMutex);
+            g_stopRequested = false;
+            g_storageRefreshRequested = false;
+        }
+        g_thread = std::thread(SamplerThread);
+    }
+
+    void Stop()
+    {
+        if (!g_thread.joinable())
+            return;
+        {
+            std::lock_guard<std::mutex> lock(g_wakeMutex);
+            g_stopRequested = true;
+        }
+        g_wakeCv.notify_all();
+        g_thread.join();
+    }
+
+    Snapshot GetSnapshot()
+    {
+        std::lock_guard<std::mutex> lock(g_snapshotMutex);
+        return g_snapshot;
+    }
+
+    std::uint64_t GetGeneration()
+    {
+        return g_generation.load(std::memory_order_acquire);
+    }
+
+    void RequestStorageRefresh()
+    {
+        {
+            std::lock_guard<std::mutex> lock(g_wakeMutex);
+            g_storageRefreshRequested = true;
+        }
+        g_wakeCv.notify_all();
+    }
+}
@@ -26,6 +26,7 @@ SOFTWARE.
 #include <vector>
 #include <switch.h>
 #include "util/error.hpp"
+#include "util/installed_title_cache.hpp"
 #include "util/offline_title_db.hpp"
 
 namespace tin::util
@@ -87,6 +88,10 @@ namespace tin::util
             return "Unknown";
         };
 
+        std::string cachedName;
+        if (inst::titlecache::TryGetName(baseTitleId, cachedName))
+            return cachedName;
+
         Result rc = 0;
         NsApplicationControlData appControlData;
         size_t sizeRead;
@@ -6,6 +6,7 @@
 #include <switch.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include "util/unzip.hpp"
 
 // https://github.com/AtlasNX/Kosmos-Updater/blob/master/source/FileManager.cpp
 
@@ -156,4 +157,243 @@ namespace inst::zip {
         unzClose(unz);
         return true;
     }
-}
\ No newline at end of file
+
+    namespace {
+        constexpr std::uint32_t kLocalHeaderSig = 0x04034b50;
+        constexpr std::uint32_t kCentralHeaderSig = 0x02014b50;
+        constexpr std::uint32_t kEndOfCentralDirSig = 0x06054b50;
+        constexpr std::uint32_t kDescriptorSig = 0x08074b50;
+        constexpr std::size_t kLocalHeaderSize = 30;
+
+        std::uint16_t readLe16(const std::uint8_t* p) {
+            return (std::uint16_t)(p[0] | (p[1] << 8));
+        }
+
+        std::uint32_t readLe32(const std::uint8_t* p) {
+            return (std::uint32_t)p[0] | ((std::uint32_t)p[1] << 8) | ((std::uint32_t)p[2] << 16) | ((std::uint32_t)p[3] << 24);
+        }
+
+        bool isSafeEntryName(const std::string& name) {
+            if (name.empty() || name[0] == '/' || name.find('\\') != std::string::npos)
+                return false;
+            std::size_t start = 0;
+            while (start <= name.size()) {
+                std::size_t end = name.find('/', start);
+                if (end == std::string::npos)
+                    end = name.size();
+                if (name.compare(start, end - start, "..") == 0 && end - start == 2)
+                    return false;
+                start = end + 1;
+            }
+            return true;
+        }
+    }
+
+    StreamExtractor::StreamExtractor(const std::string& destination) : m_destination(destination) {}
+
+    StreamExtractor::~StreamExtractor() {
+        if (m_zstreamInit)
+            inflateEnd(&m_zstream);
+        if (m_out != NULL)
+            fclose(m_out);
+    }
+
+    bool StreamExtractor::Fail(bool unsupported) {
+        if (unsupported)
+            m_unsupported = true;
+        if (m_out != NULL) {
+            fclose(m_out);
+            m_out = NULL;
+        }
+        m_state = State::Failed;
+        return false;
+    }
+
+    bool StreamExtractor::WriteOut(const std::uint8_t* data, std::size_t size) {
+        if (size == 0)
+            return true;
+        m_crc = crc32(m_crc, data, size);
+        if (m_out != NULL && fwrite(data, 1, size, m_out) != size)
+            return false;
+        return true;
+    }
+
+    bool StreamExtractor::BeginEntry() {
+        const std::uint8_t* hdr = m_pending.data();
+        m_flags = readLe16(hdr + 6);
+        m_method = readLe16(hdr + 8);
+        m_expectedCrc = readLe32(hdr + 14);
+        const std::uint32_t compSize = readLe32(hdr + 18);
+        const std::uint32_t uncompSize = readLe32(hdr + 22);
+        const std::uint16_t nameLen = readLe16(hdr + 26);
+        std::string name((const char*)hdr + kLocalHeaderSize, nameLen);
+
+        const bool hasDescriptor = (m_flags & 0x8) != 0;
+        if ((m_flags & 0x1) != 0 || (m_method != 0 && m_method != 8))
+            return Fail(true);
+        if (compSize == 0xFFFFFFFF || uncompSize == 0xFFFFFFFF)
+            return Fail(true);
+        if (m_method == 0 && hasDescriptor)
+            return Fail(true);
+        if (!isSafeEntryName(name))
+            return Fail();
+
+        std::string path = m_destination + name;
+        m_crc = crc32(0L, Z_NULL, 0);
+        m_remaining = compSize;
+
+        if (path.back() == '/') {
+            path.pop_back();
+            _makeDirectoryParents(path);
+        } else {
+            std::size_t slash = path.find_last_of('/');
+            if (slash != std::string::npos)
+                _makeDirectoryParents(path.substr(0, slash));
+            m_out = fopen(path.c_str(), "wb");
+            if (m_out == NULL)
+                return Fail();
+        }
+
+        if (m_method == 8) {
+            if (m_zstreamInit)
+                inflateReset(&m_zstream);
+            else if (inflateInit2(&m_zstream, -MAX_WBITS) == Z_OK)
+                m_zstreamInit = true;
+            else
+                return Fail();
+            if (m_inflateBuf.empty())
+                m_inflateBuf.resize(0x8000);
+        }
+
+        m_state = State::Data;
+        return true;
+    }
+
+    bool StreamExtractor::EndEntry(std::uint32_t crc) {
+        if (m_out != NULL) {
+            bool ok = fflush(m_out) == 0;
+            fsync(fileno(m_out));
+            ok = (fclose(m_out) == 0) && ok;
+            m_out = NULL;
+            if (!ok)
+                return Fail();
+        }
+        if (crc != m_crc)
+            return Fail();
+        m_entries++;
+        m_state = State::Header;
+        return true;
+    }
+
+    bool StreamExtractor::Feed(const void* data, std::size_t size) {
+        const std::uint8_t* in = (const std::uint8_t*)data;
+
+        while (size > 0 || (m_state == State::Header && m_pending.size() >= 4) || (m_state == State::Descriptor && m_pending.size() >= 4)) {
+            switch (m_state) {
+                case State::Done:
+                    // Central directory and trailing data are not needed
+                    return true;
+                case State::Failed:
+                    return false;
+                case State::Header:
+                case State::Descriptor: {
+                    // Gather the fixed part first, then whatever variable part it announces
+                    std::size_t need = 4;
+                    if (m_pending.size() >= 4) {
+                        const std::uint32_t sig = readLe32(m_pending.data());
+                        if (m_state == State::Header) {
+                            if (sig == kCentralHeaderSig || sig == kEndOfCentralDirSig) {
+                                m_state = State::Done;
+                                continue;
+                            }
+                            if (sig != kLocalHeaderSig)
+                                return Fail();
+                            need = kLocalHeaderSize;
+                            if (m_pending.size() >= kLocalHeaderSize) {
+                                const std::uint16_t nameLen = readLe16(m_pending.data() + 26);
+                                if (nameLen == 0)
+                                    return Fail();
+                                need += nameLen + readLe16(m_pending.data() + 28);
+                            }
+                        } else {
+                            need = sig == kDescriptorSig ? 16 : 12;
+                        }
+                    }
+
+                    if (m_pending.size() < need) {
+                        if (size == 0)
+                            return true;
+                        const std::size_t take = std::min(size, need - m_pending.size());
+                        m_pending.insert(m_pending.end(), in, in + take);
+                        in += take;
+                        size -= take;
+                        continue;
+                    }
+                    // The variable part's length is only known once the fixed part is in
+                    if (m_state == State::Header && m_pending.size() < kLocalHeaderSize)
+                        continue;
+
+                    if (m_state == State::Header) {
+                        if (!BeginEntry())
+                            return false;
+                        m_pending.clear();
+                    } else {
+                        const std::uint32_t crc = readLe32(m_pending.data() + (need == 16 ? 4 : 0));
+                        m_pending.clear();
+                        if (!EndEntry(crc))
+                            return false;
+                    }
+                    break;
+                }
+                case State::Data: {
+                    if (m_method == 0) {
+                        const std::size_t take = (std::size_t)std::min<std::uint64_t>(m_remaining, size);
+                        if (!WriteOut(in, take))
+                            return Fail();
+                        in += take;
+                        size -= take;
+                        m_remaining -= take;
+                        if (m_remaining == 0 && !EndEntry(m_expectedCrc))
+                            return false;
+                        break;
+                    }
+
+                    // Deflate streams carry their own end marker, so descriptor entries need no size
+                    if (size == 0)
+                        return true;
+                    m_zstream.next_in = (Bytef*)in;
+                    m_zstream.avail_in = (uInt)size;
+                    int rc = Z_OK;
+                    while (m_zstream.avail_in > 0 && rc != Z_STREAM_END) {
+                        m_zstream.next_out = m_inflateBuf.data();
+                        m_zstream.avail_out = (uInt)m_inflateBuf.size();
+                        rc = inflate(&m_zstream, Z_NO_FLUSH);
+                        if (rc != Z_OK && rc != Z_STREAM_END && rc != Z_BUF_ERROR)
+                            return Fail();
+                        if (!WriteOut(m_inflateBuf.data(), m_inflateBuf.size() - m_zstream.avail_out))
+                            return Fail();
+                        if (rc == Z_BUF_ERROR && m_zstream.avail_out != 0)
+                            break;
+                    }
+                    const std::size_t used = size - m_zstream.avail_in;
+                    in += used;
+                    size -= used;
+                    if (rc == Z_STREAM_END) {
+                        if (m_flags & 0x8)
+                            m_state = State::Descriptor;
+                        else if (!EndEntry(m_expectedCrc))
+                            return false;
+                    }
+                    break;
+                }
+            }
+        }
+        return m_state != State::Failed;
+    }
+
+    bool StreamExtractor::Finish() {
+        if (m_state != State::Done)
+            return Fail();
+        return m_entries > 0;
+    }
+}
@@ -12,10 +12,15 @@
 #include "nx/ipc/tin_ipc.h"
 #include "util/config.hpp"
 #include "util/curl.hpp"
+#include "util/crypto.hpp"
 #include "ui/MainApplication.hpp"
 #include "util/usb_comms_awoo.h"
 #include "util/json.hpp"
 #include "nx/usbhdd.h"
+#include "util/status_service.hpp"
+#include "util/installed_title_cache.hpp"
+#include "util/dir_scanner.hpp"
+#include "install/nca_verify.hpp"
 
 namespace inst::util {
     void initApp () {
@@ -29,9 +34,15 @@ namespace inst::util {
         #endif
         awoo_usbCommsInitialize();
         nx::hdd::init();
+        inst::status::Start();
+        inst::titlecache::RequestRefresh();
     }
 
     void deinitApp () {
+        inst::util::dirscan::Shutdown();
+        tin::install::verify::Shutdown();
+        inst::titlecache::Shutdown();
+        inst::status::Stop();
         nx::hdd::exit();
         socketExit();
         awoo_usbCommsExit();
@@ -49,8 +60,11 @@ namespace inst::util {
         ncmExit();
         nsextExit();
         esExit();
+        Crypto::ClearKeys();
         splCryptoExit();
         splExit();
+        inst::status::RequestStorageRefresh();
+        inst::titlecache::RequestRefresh();
     }
 
     bool ignoreCaseCompare(const std::string &a, const std::string &b) {
@@ -5,6 +5,7 @@ Convert CyberFoil-DB artefacts into runtime files used by HappyFoil offline mode
 Outputs:
   - titles.pack (binary metadata container)
   - icons.pack (single-file icon container)
+  - <pack>.<from_version>.cfdelta (optional delta patches against previous exports)
 """
 
 from __future__ import annotations
@@ -12,6 +13,7 @@ from __future__ import annotations
 import argparse
 import hashlib
 import json
+import mmap
 import pathlib
 import shutil
 import sqlite3
@@ -19,7 +21,7 @@ import struct
 import sys
 import re
 from datetime import datetime, timezone
-from typing import Dict, List, Tuple
+from typing import Dict, Iterator, List, Tuple
 
 TITLE_PACK_MAGIC = b"CFTITLE1"
 TITLE_PACK_VERSION = 1
@@ -37,6 +39,14 @@ ICON_PACK_MAGIC = b"CFICONP1"
 ICON_PACK_VERSION = 1
 ICON_PACK_ENTRY_SIZE = 32
 
+DELTA_MAGIC = b"CFDELTA1"
+DELTA_VERSION = 1
+DELTA_OP_END = 0
+DELTA_OP_COPY = 1
+DELTA_OP_DATA = 2
+DELTA_MAX_OP_LENGTH = 0xFFFFFFFF
+DELTA_FALLBACK_CHUNK_SIZE = 64 * 1024
+
 ICON_DB_CANDIDATES = (
     "icon.db",
     "icons.db",
@@ -317,6 +327,208 @@ def export_icon_pack(icon_db: pathlib.Path, pack_path: pathlib.Path) -> int:
     return len(entries)
 
 
+def iter_pack_segments(data) -> Iterator[Tuple[int, int]]:
+    """Split a pack into (offset, size) segments that survive re-exports unchanged.
+
+    Icon payloads, title table entries and interned strings become individual segments, so an
+    inserted or removed title only changes the segments that actually differ. Unknown data falls
+    back to fixed-size chunks.
+    """
+    total = len(data)
+    magic = bytes(data[0:8]) if total >= 32 else b""
+
+    if magic in (ICON_PACK_MAGIC, TITLE_PACK_MAGIC):
+        _, _, entry_size, count, _, data_offset = struct.unpack_from("<8sIIIIQ", data, 0)
+        table_end = 32 + (count * entry_size)
+        if entry_size > 0 and table_end <= data_offset <= total:
+            yield (0, 32)
+            for i in range(count):
+                yield (32 + (i * entry_size), entry_size)
+
+            if magic == ICON_PACK_MAGIC:
+                payloads = []
+                for i in range(count):
+                    _, offset, size = struct.unpack_from("<QQI", data, 32 + (i * entry_size))
+                    if size and data_offset + offset + size <= total:
+                        payloads.append((data_offset + offset, size))
+                payloads.sort()
+                cursor = table_end
+                for offset, size in payloads:
+                    if offset < cursor:
+                        continue
+                    if offset > cursor:
+                        yield (cursor, offset - cursor)
+                    yield (offset, size)
+                    cursor = offset + size
+                if cursor < total:
+                    yield (cursor, total - cursor)
+                return
+
+            cursor = data_offset
+            while cursor < total:
+                end = data.find(b"\0", cursor)
+                end = total if end < 0 else end + 1
+                yield (cursor, end - cursor)
+                cursor = end
+            return
+
+    for offset in range(0, total, DELTA_FALLBACK_CHUNK_SIZE):
+        yield (offset, min(DELTA_FALLBACK_CHUNK_SIZE, total - offset))
+
+
+def generate_delta_patch(old_path: pathlib.Path, new_path: pathlib.Path, patch_path: pathlib.Path) -> int:
+    """Write a CFDELTA1 patch that rebuilds new_path from old_path and return its size.
+
+    Segments of the new pack are keyed by content hash; ones already present in the old pack
+    become COPY ops and the rest are carried as DATA. Adjacent ops are merged.
+    """
+    with old_path.open("rb") as old_f, new_path.open("rb") as new_f:
+        old_size = old_path.stat().st_size
+        new_size = new_path.stat().st_size
+        old = mmap.mmap(old_f.fileno(), 0, access=mmap.ACCESS_READ) if old_size else b""
+        new = mmap.mmap(new_f.fileno(), 0, access=mmap.ACCESS_READ) if new_size else b""
+        try:
+            index: Dict[bytes, int] = {}
+            for offset, size in iter_pack_segments(old):
+                key = hashlib.blake2b(old[offset:offset + size], digest_size=16).digest() + size.to_bytes(4, "little")
+                index.setdefault(key, offset)
+
+            # Each op is [kind, source_offset_or_new_offset, length].
+            ops: List[List[int]] = []
+            for offset, size in iter_pack_segments(new):
+                chunk = new[offset:offset + size]
+                key = hashlib.blake2b(chunk, digest_size=16).digest() + size.to_bytes(4, "little")
+                src = index.get(key)
+                if src is not None and old[src:src + size] != chunk:
+                    src = None
+
+                last = ops[-1] if ops else None
+                if src is not None:
+                    if last and last[0] == DELTA_OP_COPY and last[1] + last[2] == src and last[2] + size <= DELTA_MAX_OP_LENGTH:
+                        last[2] += size
+                    else:
+                        ops.append([DELTA_OP_COPY, src, size])
+                else:
+                    if last and last[0] == DELTA_OP_DATA and last[2] + size <= DELTA_MAX_OP_LENGTH:
+                        last[2] += size
+                    else:
+                        ops.append([DELTA_OP_DATA, offset, size])
+
+            patch_path.parent.mkdir(parents=True, exist_ok=True)
+            with patch_path.open("wb") as out:
+                out.write(struct.pack("<8sIIQQ", DELTA_MAGIC, DELTA_VERSION, 0, old_size, new_size))
+                for kind, offset, length in ops:
+                    if kind == DELTA_OP_COPY:
+                        out.write(struct.pack("<BQI", kind, offset, length))
+                    else:
+                        out.write(struct.pack("<BI", kind, length))
+                        out.write(new[offset:offset + length])
+                out.write(struct.pack("<B", DELTA_OP_END))
+        finally:
+            if isinstance(old, mmap.mmap):
+                old.close()
+            if isinstance(new, mmap.mmap):
+                new.close()
+
+    return patch_path.stat().st_size
+
+
+def apply_delta_patch(old_path: pathlib.Path, patch_path: pathlib.Path) -> bytes:
+    """Reference implementation of the on-device patcher, used to self-check generated patches."""
+    old = old_path.read_bytes()
+    patch = patch_path.read_bytes()
+    magic, version, _, old_size, new_size = struct.unpack_from("<8sIIQQ", patch, 0)
+    if magic != DELTA_MAGIC or version != DELTA_VERSION or old_size != len(old):
+        raise RuntimeError(f"invalid delta patch: {patch_path}")
+    out = bytearray()
+    pos = 32
+    while True:
+        kind = patch[pos]
+        pos += 1
+        if kind == DELTA_OP_END:
+            break
+        if kind == DELTA_OP_COPY:
+            offset, length = struct.unpack_from("<QI", patch, pos)
+            pos += 12
+            out += old[offset:offset + length]
+        elif kind == DELTA_OP_DATA:
+            (length,) = struct.unpack_from("<I", patch, pos)
+            pos += 4
+            out += patch[pos:pos + length]
+            pos += length
+        else:
+            raise RuntimeError(f"unknown delta op {kind} in {patch_path}")
+    if len(out) != new_size:
+        raise RuntimeError(f"delta patch size mismatch: {patch_path}")
+    return bytes(out)
+
+
+def read_previous_export(previous_dir: pathlib.Path, manifest_name: str) -> Tuple[str, Dict[str, str]]:
+    """Return (db_version, {pack name: sha256}) for an earlier export directory."""
+    manifest_path = previous_dir / manifest_name
+    if not manifest_path.is_file():
+        manifest_path = previous_dir / "manifest.json"
+    if not manifest_path.is_file():
+        raise RuntimeError(f"previous export has no manifest: {previous_dir}")
+    with manifest_path.open("r", encoding="utf-8") as f:
+        manifest = json.load(f)
+    version = str(manifest.get("db_version") or manifest.get("version") or "").strip()
+    if not version:
+        raise RuntimeError(f"previous manifest has no db_version: {manifest_path}")
+    shas: Dict[str, str] = {}
+    for name, entry in (manifest.get("files") or {}).items():
+        if isinstance(entry, dict) and isinstance(entry.get("sha256"), str):
+            shas[name] = entry["sha256"].lower()
+    return version, shas
+
+
+def build_patch_entries(
+    pack_name: str,
+    new_pack: pathlib.Path,
+    new_sha: str,
+    previous_dirs: List[pathlib.Path],
+    manifest_name: str,
+    output_dir: pathlib.Path,
+    file_url,
+    max_ratio: float,
+) -> List[Dict[str, object]]:
+    entries: List[Dict[str, object]] = []
+    new_size = new_pack.stat().st_size
+    for previous_dir in previous_dirs:
+        old_pack = previous_dir / pack_name
+        if not old_pack.is_file():
+            print(f"[delta] {previous_dir}: no {pack_name}, skipping")
+            continue
+        from_version, shas = read_previous_export(previous_dir, manifest_name)
+        from_sha = shas.get(pack_name) or compute_file_sha256(old_pack)
+        if from_sha == new_sha:
+            continue
+
+        patch_name = f"{pack_name}.{re.sub(r'[^A-Za-z0-9._-]', '_', from_version)}.cfdelta"
+        patch_path = output_dir / patch_name
+        patch_size = generate_delta_patch(old_pack, new_pack, patch_path)
+        if patch_size >= new_size * max_ratio:
+            print(f"[delta] {pack_name} from {from_version}: {patch_size} bytes is not worth it, dropped")
+            patch_path.unlink()
+            continue
+
+        rebuilt = hashlib.sha256(apply_delta_patch(old_pack, patch_path)).hexdigest()
+        if rebuilt != new_sha:
+            raise RuntimeError(f"delta patch self-check failed for {patch_path}")
+
+        print(f"[delta] {pack_name} from {from_version}: {patch_size} bytes (full pack {new_size} bytes)")
+        entries.append(
+            {
+                "from_version": from_version,
+                "from_sha256": from_sha,
+                "url": file_url(patch_name),
+                "size": patch_size,
+                "sha256": compute_file_sha256(patch_path),
+            }
+        )
+    return entries
+
+
 def parse_args(argv: list[str]) -> argparse.Namespace:
     parser = argparse.ArgumentParser(description="Export offline HappyFoil DB artefacts.")
     parser.add_argument(
@@ -352,6 +564,19 @@ def parse_args(argv: list[str]) -> argparse.Namespace:
         default="offline_db_manifest.json",
         help="Manifest file name (default: offline_db_manifest.json).",
     )
+    parser.add_argument(
+        "--previous-dir",
+        type=pathlib.Path,
+        action="append",
+        default=[],
+        help="Earlier export directory (packs + manifest) to generate a delta patch from. Repeat for several versions.",
+    )
+    parser.add_argument(
+        "--max-patch-ratio",
+        type=float,
+        default=0.5,
+        help="Drop delta patches larger than this fraction of the full pack (default: 0.5).",
+    )
     return parser.parse_args(argv)
 
 
@@ -414,14 +639,30 @@ def main(argv: list[str]) -> int:
         if not db_version:
             db_version = datetime.now(timezone.utc).strftime("%Y%m%d%H%M%S")
 
+        files = {
+            "titles.pack": build_manifest_file_entry(generated_titles_pack, file_url("titles.pack")),
+            "icons.pack": build_manifest_file_entry(generated_icons_pack, file_url("icons.pack")),
+        }
+
+        for pack_name, pack_path in (("titles.pack", generated_titles_pack), ("icons.pack", generated_icons_pack)):
+            patches = build_patch_entries(
+                pack_name,
+                pack_path,
+                str(files[pack_name]["sha256"]),
+                args.previous_dir,
+                args.manifest_name,
+                output_dir,
+                file_url,
+                args.max_patch_ratio,
+            )
+            if patches:
+                files[pack_name]["patches"] = patches
+
         manifest = {
             "schema": 1,
             "db_version": db_version,
             "generated_at_utc": datetime.now(timezone.utc).strftime("%Y-%m-%dT%H:%M:%SZ"),
-            "files": {
-                "titles.pack": build_manifest_file_entry(generated_titles_pack, file_url("titles.pack")),
-                "icons.pack": build_manifest_file_entry(generated_icons_pack, file_url("icons.pack")),
-            },
+            "files": files,
         }
 
         manifest_path = output_dir / args.manifest_name
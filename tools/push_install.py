@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+"""
+Reference sender for HappyFoil push installs over LAN.
+
+Open "Install over LAN or internet" on the console, then run:
+  python tools/push_install.py <switch-ip> <file-or-folder> [...]
+
+Every NSP/NSZ/XCI/XCZ is streamed over one TCP connection to port 2000 and
+installed while it arrives; the console only reads as fast as it can write,
+so TCP flow control keeps the sender in step with the install.
+
+Protocol (all integers little-endian):
+  sender   "HFPS" u32 version u32 file_count
+  receiver "HFPR" u32 status                       after a storage was picked
+  per file:
+    sender   "FILE" u64 size u16 name_length name  (name is UTF-8)
+    receiver "RDY0" u32 status                     file bytes follow only on OK
+    sender   <size bytes>
+    receiver "DONE" u32 status                     after the title was installed
+  sender   "END0"
+  receiver "BYE0" u32 status
+
+Status: 0 ok, 1 unsupported session, 2 declined on the console,
+3 unsupported file, 4 install failed.
+"""
+
+from __future__ import annotations
+
+import argparse
+import pathlib
+import socket
+import struct
+import sys
+import time
+from typing import List
+
+PORT = 2000
+PROTOCOL_VERSION = 1
+CHUNK_SIZE = 1024 * 1024
+EXTENSIONS = (".nsp", ".nsz", ".xci", ".xcz")
+MAX_FILES = 256
+
+STATUS_OK = 0
+STATUS_TEXT = {
+    0: "ok",
+    1: "unsupported session",
+    2: "declined on the console",
+    3: "unsupported file",
+    4: "install failed",
+}
+
+
+class PushError(Exception):
+    pass
+
+
+def recv_exact(sock: socket.socket, size: int) -> bytes:
+    data = bytearray()
+    while len(data) < size:
+        chunk = sock.recv(size - len(data))
+        if not chunk:
+            raise PushError("connection closed by the console")
+        data.extend(chunk)
+    return bytes(data)
+
+
+def recv_reply(sock: socket.socket, expected: bytes) -> int:
+    tag, status = struct.unpack("<4sI", recv_exact(sock, 8))
+    if tag != expected:
+        raise PushError(f"unexpected reply {tag!r}, wanted {expected!r}")
+    return status
+
+
+def collect_files(paths: List[str]) -> List[pathlib.Path]:
+    files: List[pathlib.Path] = []
+    for raw in paths:
+        path = pathlib.Path(raw)
+        if path.is_dir():
+            files.extend(sorted(p for p in path.rglob("*") if p.is_file() and p.suffix.lower() in EXTENSIONS))
+        elif path.is_file():
+            files.append(path)
+        else:
+            raise PushError(f"not found: {raw}")
+    return files
+
+
+def send_file(sock: socket.socket, path: pathlib.Path) -> int:
+    size = path.stat().st_size
+    name = path.name.encode("utf-8")
+    sock.sendall(b"FILE" + struct.pack("<QH", size, len(name)) + name)
+    status = recv_reply(sock, b"RDY0")
+    if status != STATUS_OK:
+        return status
+
+    # The console stops reading while it asks about an NCA with an invalid signature
+    sock.settimeout(None)
+    sent = 0
+    started = time.monotonic()
+    with path.open("rb") as handle:
+        while True:
+            chunk = handle.read(CHUNK_SIZE)
+            if not chunk:
+                break
+            sock.sendall(chunk)
+            sent += len(chunk)
+            elapsed = max(time.monotonic() - started, 1e-6)
+            print(f"\r  {sent * 100 // max(size, 1):3d}%  {sent / elapsed / 1048576:6.1f} MiB/s", end="", flush=True)
+    print()
+    if sent != size:
+        raise PushError(f"{path} changed size while sending")
+
+    # The console answers once the last NCA is written and the title committed
+    return recv_reply(sock, b"DONE")
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Push NSP/NSZ/XCI/XCZ files to HappyFoil over LAN.")
+    parser.add_argument("host", help="console IP address shown on the LAN install screen")
+    parser.add_argument("paths", nargs="+", help="files or folders to install")
+    parser.add_argument("--port", type=int, default=PORT)
+    parser.add_argument("--timeout", type=float, default=60.0, help="seconds to wait while connecting and between replies")
+    args = parser.parse_args()
+
+    try:
+        files = collect_files(args.paths)
+        if not files:
+            raise PushError("no installable files found")
+        if len(files) > MAX_FILES:
+            raise PushError(f"at most {MAX_FILES} files per session")
+
+        with socket.create_connection((args.host, args.port), timeout=args.timeout) as sock:
+            sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+            sock.sendall(b"HFPS" + struct.pack("<II", PROTOCOL_VERSION, len(files)))
+            print(f"Waiting for the console to accept {len(files)} file(s)...")
+            # The user picks the install location first
+            sock.settimeout(None)
+            status = recv_reply(sock, b"HFPR")
+            if status != STATUS_OK:
+                raise PushError(f"session refused: {STATUS_TEXT.get(status, status)}")
+
+            failed = 0
+            for index, path in enumerate(files, 1):
+                print(f"[{index}/{len(files)}] {path.name}")
+                sock.settimeout(args.timeout)
+                status = send_file(sock, path)
+                if status != STATUS_OK:
+                    failed += 1
+                    print(f"  failed: {STATUS_TEXT.get(status, status)}")
+
+            sock.settimeout(args.timeout)
+            sock.sendall(b"END0")
+            recv_reply(sock, b"BYE0")
+    except (OSError, PushError) as exc:
+        print(f"error: {exc}", file=sys.stderr)
+        return 1
+
+    print(f"Done: {len(files) - failed} installed, {failed} failed")
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,362 @@
+#!/usr/bin/env python3
+"""
+Minimal stand-in for the shop save backup API, for testing HappyFoil Save Sync on a LAN.
+
+Endpoints:
+  GET    /api/saves/list
+  POST   /api/saves/upload/<TID>                 full archive (multipart "file")
+  POST   /api/saves/upload-delta/<TID>           changed files + full "manifest" + "base_save_id"
+  GET    /api/saves/download/<TID>[/<SID>].zip
+  POST   /api/saves/download-delta/<TID>/<SID>   {"paths": [...]} -> zip of those files
+  GET    /api/saves/manifest/<TID>[/<SID>]       {"save_id": ..., "files": [{path, size, sha256}]}
+  DELETE /api/saves/delete/<TID>[/<SID>]
+
+Backups are stored as <root>/<TID>/<SID>.zip with a <SID>.json sidecar holding the note and manifest.
+"""
+
+from __future__ import annotations
+
+import argparse
+import base64
+import email.parser
+import email.policy
+import hashlib
+import io
+import json
+import pathlib
+import re
+import sys
+import threading
+import time
+import zipfile
+from datetime import datetime, timezone
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from typing import Dict, List, Optional, Tuple
+
+TITLE_ID_RE = re.compile(r"^[0-9A-Fa-f]{16}$")
+SAVE_ID_RE = re.compile(r"^[A-Za-z0-9_.-]{1,96}$")
+EMPTY_MARKER = ".empty"
+
+STORE_LOCK = threading.Lock()
+
+
+def now_utc() -> datetime:
+    return datetime.now(timezone.utc)
+
+
+def is_safe_member(name: str) -> bool:
+    if not name or name.startswith(("/", "\\")) or ":" in name:
+        return False
+    return all(part not in ("", "..") for part in name.replace("\\", "/").split("/"))
+
+
+def read_zip_files(data: bytes) -> Dict[str, bytes]:
+    files: Dict[str, bytes] = {}
+    with zipfile.ZipFile(io.BytesIO(data)) as archive:
+        for info in archive.infolist():
+            if info.is_dir() or info.filename == EMPTY_MARKER:
+                continue
+            if not is_safe_member(info.filename):
+                raise ValueError(f"unsafe archive path: {info.filename}")
+            files[info.filename] = archive.read(info)
+    return files
+
+
+def write_zip_files(files: Dict[str, bytes]) -> bytes:
+    out = io.BytesIO()
+    with zipfile.ZipFile(out, "w", zipfile.ZIP_DEFLATED) as archive:
+        if not files:
+            archive.writestr(EMPTY_MARKER, b"")
+        for name in sorted(files):
+            archive.writestr(name, files[name])
+    return out.getvalue()
+
+
+def build_manifest(files: Dict[str, bytes]) -> List[dict]:
+    return [
+        {"path": name, "size": len(files[name]), "sha256": hashlib.sha256(files[name]).hexdigest()}
+        for name in sorted(files)
+    ]
+
+
+class SaveStore:
+    def __init__(self, root: pathlib.Path) -> None:
+        self.root = root
+        self.root.mkdir(parents=True, exist_ok=True)
+
+    def title_dir(self, title_id: str) -> pathlib.Path:
+        return self.root / title_id.upper()
+
+    def versions(self, title_id: str) -> List[dict]:
+        directory = self.title_dir(title_id)
+        if not directory.is_dir():
+            return []
+        metas = []
+        for meta_path in directory.glob("*.json"):
+            try:
+                metas.append(json.loads(meta_path.read_text(encoding="utf-8")))
+            except (OSError, ValueError):
+                continue
+        metas.sort(key=lambda m: (m.get("created_ts", 0), m.get("save_id", "")), reverse=True)
+        return metas
+
+    def resolve(self, title_id: str, save_id: Optional[str]) -> Optional[dict]:
+        versions = self.versions(title_id)
+        if not save_id:
+            return versions[0] if versions else None
+        return next((m for m in versions if m.get("save_id") == save_id), None)
+
+    def archive_path(self, title_id: str, save_id: str) -> pathlib.Path:
+        return self.title_dir(title_id) / f"{save_id}.zip"
+
+    def load_files(self, title_id: str, save_id: str) -> Dict[str, bytes]:
+        return read_zip_files(self.archive_path(title_id, save_id).read_bytes())
+
+    def store(self, title_id: str, files: Dict[str, bytes], note: str) -> dict:
+        created = now_utc()
+        save_id = created.strftime("%Y%m%dT%H%M%S%f")
+        directory = self.title_dir(title_id)
+        directory.mkdir(parents=True, exist_ok=True)
+        data = write_zip_files(files)
+        self.archive_path(title_id, save_id).write_bytes(data)
+        meta = {
+            "title_id": title_id.upper(),
+            "save_id": save_id,
+            "note": note,
+            "created_at": created.strftime("%Y-%m-%d %H:%M:%S"),
+            "created_ts": int(created.timestamp()),
+            "size": len(data),
+            "files": build_manifest(files),
+        }
+        (directory / f"{save_id}.json").write_text(json.dumps(meta, indent=2), encoding="utf-8")
+        return meta
+
+    def delete(self, title_id: str, save_id: str) -> None:
+        self.archive_path(title_id, save_id).unlink(missing_ok=True)
+        (self.title_dir(title_id) / f"{save_id}.json").unlink(missing_ok=True)
+
+
+def parse_multipart(content_type: str, body: bytes) -> Dict[str, bytes]:
+    header = f"Content-Type: {content_type}\r\nMIME-Version: 1.0\r\n\r\n".encode("latin-1")
+    message = email.parser.BytesParser(policy=email.policy.HTTP).parsebytes(header + body)
+    fields: Dict[str, bytes] = {}
+    for part in message.iter_parts():
+        name = part.get_param("name", header="content-disposition")
+        if name:
+            fields[name] = part.get_payload(decode=True) or b""
+    return fields
+
+
+class SaveSyncHandler(BaseHTTPRequestHandler):
+    server_version = "HappyFoilSaveSync/1"
+    store: SaveStore
+    credentials: Optional[Tuple[str, str]] = None
+
+    def log_message(self, fmt: str, *args) -> None:
+        sys.stderr.write("[%s] %s\n" % (time.strftime("%H:%M:%S"), fmt % args))
+
+    # --- plumbing -------------------------------------------------------
+
+    def read_body(self) -> bytes:
+        if self.headers.get("Transfer-Encoding", "").lower() == "chunked":
+            chunks = []
+            while True:
+                size = int(self.rfile.readline().split(b";", 1)[0].strip() or b"0", 16)
+                if size == 0:
+                    while self.rfile.readline() not in (b"\r\n", b"\n", b""):
+                        pass
+                    break
+                chunks.append(self.rfile.read(size))
+                self.rfile.readline()
+            return b"".join(chunks)
+        length = int(self.headers.get("Content-Length", "0") or 0)
+        return self.rfile.read(length) if length > 0 else b""
+
+    def send_json(self, code: int, payload: object) -> None:
+        data = json.dumps(payload).encode("utf-8")
+        self.send_response(code)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(data)))
+        self.end_headers()
+        self.wfile.write(data)
+
+    def send_zip(self, data: bytes, name: str) -> None:
+        self.send_response(200)
+        self.send_header("Content-Type", "application/zip")
+        self.send_header("Content-Disposition", f'attachment; filename="{name}"')
+        self.send_header("Content-Length", str(len(data)))
+        self.end_headers()
+        self.wfile.write(data)
+
+    def authorized(self) -> bool:
+        if self.credentials is None:
+            return True
+        value = self.headers.get("Authorization", "")
+        if value.startswith("Basic "):
+            try:
+                user, _, password = base64.b64decode(value[6:]).decode("utf-8").partition(":")
+                if (user, password) == self.credentials:
+                    return True
+            except ValueError:
+                pass
+        self.send_response(401)
+        self.send_header("WWW-Authenticate", 'Basic realm="saves"')
+        self.send_header("Content-Length", "0")
+        self.end_headers()
+        return False
+
+    def route(self) -> Tuple[str, List[str]]:
+        parts = [p for p in self.path.split("?", 1)[0].split("/") if p]
+        if len(parts) < 3 or parts[:2] != ["api", "saves"]:
+            return "", []
+        args = parts[3:]
+        if args and args[-1].endswith(".zip"):
+            args[-1] = args[-1][:-4]
+        if not args or not TITLE_ID_RE.match(args[0]) or any(not SAVE_ID_RE.match(a) for a in args[1:]):
+            return parts[2], [] if parts[2] == "list" else ["!"]
+        return parts[2], args
+
+    def version_entry(self, meta: dict) -> dict:
+        host = self.headers.get("Host", "localhost")
+        return {
+            "title_id": meta["title_id"],
+            "name": meta.get("name", ""),
+            "save_id": meta["save_id"],
+            "note": meta.get("note", ""),
+            "created_at": meta.get("created_at", ""),
+            "created_ts": meta.get("created_ts", 0),
+            "size": meta.get("size", 0),
+            "download_url": f"http://{host}/api/saves/download/{meta['title_id']}/{meta['save_id']}.zip",
+        }
+
+    # --- handlers -------------------------------------------------------
+
+    def do_GET(self) -> None:
+        if not self.authorized():
+            return
+        action, args = self.route()
+        with STORE_LOCK:
+            if action == "list":
+                saves = []
+                for directory in sorted(self.store.root.iterdir()):
+                    if directory.is_dir() and TITLE_ID_RE.match(directory.name):
+                        saves.extend(self.version_entry(m) for m in self.store.versions(directory.name))
+                self.send_json(200, {"saves": saves})
+                return
+            if action in ("download", "manifest") and args and args != ["!"]:
+                meta = self.store.resolve(args[0], args[1] if len(args) > 1 else None)
+                if meta is None:
+                    self.send_json(404, {"error": "save not found"})
+                elif action == "manifest":
+                    self.send_json(200, {"save_id": meta["save_id"], "files": meta.get("files", [])})
+                else:
+                    data = self.store.archive_path(args[0], meta["save_id"]).read_bytes()
+                    self.send_zip(data, f"{args[0].upper()}.zip")
+                return
+        self.send_json(404, {"error": "not found"})
+
+    def do_POST(self) -> None:
+        if not self.authorized():
+            return
+        action, args = self.route()
+        if not args or args == ["!"] or action not in ("upload", "upload-delta", "download-delta"):
+            self.send_json(404, {"error": "not found"})
+            return
+        body = self.read_body()
+        title_id = args[0]
+        try:
+            with STORE_LOCK:
+                if action == "download-delta":
+                    self.handle_download_delta(title_id, args[1] if len(args) > 1 else None, body)
+                    return
+                fields = parse_multipart(self.headers.get("Content-Type", ""), body)
+                note = fields.get("note", b"").decode("utf-8", "replace")
+                uploaded = read_zip_files(fields.get("file", b""))
+                if action == "upload":
+                    meta = self.store.store(title_id, uploaded, note)
+                else:
+                    meta = self.handle_upload_delta(title_id, fields, uploaded, note)
+                    if meta is None:
+                        return
+        except (ValueError, zipfile.BadZipFile, KeyError) as exc:
+            self.send_json(400, {"error": str(exc)})
+            return
+        self.send_json(200, {"ok": True, "save_id": meta["save_id"]})
+
+    def handle_upload_delta(self, title_id: str, fields: Dict[str, bytes], changed: Dict[str, bytes], note: str) -> Optional[dict]:
+        base_id = fields.get("base_save_id", b"").decode("utf-8").strip()
+        base = self.store.resolve(title_id, base_id or None)
+        if base is None:
+            self.send_json(409, {"error": "base save not found"})
+            return None
+        manifest = json.loads(fields["manifest"].decode("utf-8"))
+        base_files = self.store.load_files(title_id, base["save_id"])
+
+        files: Dict[str, bytes] = {}
+        for item in manifest:
+            path = item["path"]
+            if not is_safe_member(path):
+                raise ValueError(f"unsafe manifest path: {path}")
+            data = changed[path] if path in changed else base_files.get(path)
+            if data is None or hashlib.sha256(data).hexdigest() != item["sha256"].lower():
+                self.send_json(409, {"error": f"missing or mismatched content for {path}"})
+                return None
+            files[path] = data
+        return self.store.store(title_id, files, note)
+
+    def handle_download_delta(self, title_id: str, save_id: Optional[str], body: bytes) -> None:
+        meta = self.store.resolve(title_id, save_id)
+        if meta is None:
+            self.send_json(404, {"error": "save not found"})
+            return
+        paths = json.loads(body.decode("utf-8") or "{}").get("paths", [])
+        files = self.store.load_files(title_id, meta["save_id"])
+        missing = [p for p in paths if p not in files]
+        if missing:
+            self.send_json(400, {"error": "unknown paths", "paths": missing})
+            return
+        self.send_zip(write_zip_files({p: files[p] for p in paths}), f"{title_id.upper()}-delta.zip")
+
+    def do_DELETE(self) -> None:
+        if not self.authorized():
+            return
+        action, args = self.route()
+        if action != "delete" or not args or args == ["!"]:
+            self.send_json(404, {"error": "not found"})
+            return
+        with STORE_LOCK:
+            meta = self.store.resolve(args[0], args[1] if len(args) > 1 else None)
+            if meta is None:
+                self.send_json(404, {"error": "save not found"})
+                return
+            self.store.delete(args[0], meta["save_id"])
+        self.send_json(200, {"ok": True})
+
+
+def parse_args(argv: list[str]) -> argparse.Namespace:
+    parser = argparse.ArgumentParser(description="Serve a local HappyFoil save backup API.")
+    parser.add_argument("--root", default="save_sync_data", help="Directory that stores backups.")
+    parser.add_argument("--host", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=8465)
+    parser.add_argument("--user", default="", help="Require HTTP basic auth with this user.")
+    parser.add_argument("--password", default="", help="Password for --user.")
+    return parser.parse_args(argv)
+
+
+def main(argv: list[str]) -> int:
+    args = parse_args(argv)
+    SaveSyncHandler.store = SaveStore(pathlib.Path(args.root))
+    if args.user:
+        SaveSyncHandler.credentials = (args.user, args.password)
+
+    server = ThreadingHTTPServer((args.host, args.port), SaveSyncHandler)
+    print(f"Serving save backups from {pathlib.Path(args.root).resolve()} on http://{args.host}:{args.port}")
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))